@@ -0,0 +1,72 @@
+/*  Copyright (C) 2011-2012 National Institute For Space Research (INPE) - Brazil.
+
+This file is part of the TerraLib - a Framework for building GIS enabled applications.
+
+TerraLib is free software: you can redistribute it and/or modify
+it under the terms of the GNU Lesser General Public License as published by
+the Free Software Foundation, either version 3 of the License,
+or (at your option) any later version.
+
+TerraLib is distributed in the hope that it will be useful,
+but WITHOUT ANY WARRANTY; without even the implied warranty of
+MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE. See the
+GNU Lesser General Public License for more details.
+
+You should have received a copy of the GNU Lesser General Public License
+along with TerraLib. See COPYING. If not, write to
+TerraLib Team at <terralib-team@terralib.org>.
+*/
+
+
+/*!
+\file urban_analysis/src/growth/BlockCachedRaster.cpp
+
+\brief This file contains a raster that reads the blocks of a raster file only when they are accessed, keeping the most recently used ones in memory
+*/
+
+#include "BlockCachedRaster.h"
+
+//Terralib
+#include <terralib/raster/Band.h>
+#include <terralib/raster/BandProperty.h>
+#include <terralib/raster/Raster.h>
+
+#include <algorithm>
+
+te::urban::SourceRasterHolder::SourceRasterHolder(te::rst::Raster* sourceRaster)
+  : m_sourceRaster(sourceRaster)
+{
+}
+
+te::urban::SourceRasterHolder::~SourceRasterHolder()
+{
+}
+
+te::urban::BlockCachedRaster::BlockCachedRaster(te::rst::Raster* sourceRaster, std::size_t cacheSize, unsigned int prefetchThreshold)
+  : SourceRasterHolder(sourceRaster)
+  , te::mem::CachedRaster((unsigned int)getNumberOfCacheBlocks(sourceRaster, cacheSize), *sourceRaster, prefetchThreshold)
+{
+}
+
+te::urban::BlockCachedRaster::~BlockCachedRaster()
+{
+}
+
+std::size_t te::urban::BlockCachedRaster::getNumberOfCacheBlocks(const te::rst::Raster* raster, std::size_t cacheSize)
+{
+  std::size_t numBands = raster->getNumberOfBands();
+
+  std::size_t maxBlockSize = 1;
+  std::size_t maxBlocksPerRow = 1;
+  for (std::size_t band = 0; band < numBands; ++band)
+  {
+    const te::rst::BandProperty* bandProperty = raster->getBand(band)->getProperty();
+
+    maxBlockSize = std::max(maxBlockSize, (std::size_t)raster->getBand(band)->getBlockSize());
+    maxBlocksPerRow = std::max(maxBlocksPerRow, (std::size_t)bandProperty->m_nblocksx);
+  }
+
+  std::size_t numCacheBlocks = (cacheSize * 1024 * 1024) / maxBlockSize;
+
+  return std::max(numCacheBlocks, 2 * maxBlocksPerRow * numBands);
+}
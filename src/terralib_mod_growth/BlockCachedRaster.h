@@ -0,0 +1,79 @@
+/*  Copyright (C) 2011-2012 National Institute For Space Research (INPE) - Brazil.
+
+This file is part of the TerraLib - a Framework for building GIS enabled applications.
+
+TerraLib is free software: you can redistribute it and/or modify
+it under the terms of the GNU Lesser General Public License as published by
+the Free Software Foundation, either version 3 of the License,
+or (at your option) any later version.
+
+TerraLib is distributed in the hope that it will be useful,
+but WITHOUT ANY WARRANTY; without even the implied warranty of
+MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE. See the
+GNU Lesser General Public License for more details.
+
+You should have received a copy of the GNU Lesser General Public License
+along with TerraLib. See COPYING. If not, write to
+TerraLib Team at <terralib-team@terralib.org>.
+*/
+
+
+/*!
+\file urban_analysis/src/growth/BlockCachedRaster.h
+
+\brief This file contains a raster that reads the blocks of a raster file only when they are accessed, keeping the most recently used ones in memory
+*/
+
+#ifndef __URBANANALYSIS_INTERNAL_GROWTH_BLOCKCACHEDRASTER_H
+#define __URBANANALYSIS_INTERNAL_GROWTH_BLOCKCACHEDRASTER_H
+
+#include "Config.h"
+
+//Terralib
+#include <terralib/memory/CachedRaster.h>
+
+#include <cstddef>
+#include <memory>
+
+namespace te
+{
+  namespace rst
+  {
+    class Raster;
+  }
+
+  namespace urban
+  {
+    //!< Keeps the source raster of a BlockCachedRaster. As it is the first base, the source is created before the cache and destroyed after it
+    struct TEGROWTHEXPORT SourceRasterHolder
+    {
+      explicit SourceRasterHolder(te::rst::Raster* sourceRaster);
+
+      ~SourceRasterHolder();
+
+      std::auto_ptr<te::rst::Raster> m_sourceRaster;
+    };
+
+    /*!
+      \brief A raster whose blocks are read from the source raster only when they are first accessed.
+
+      The cache keeps at most the given number of megabytes of blocks, and the least recently used block is released when a new one is needed. When the
+      prefetch threshold is not zero, the next block is read in background while the current one is being used, so the rows are read ahead during a scan.
+      The raster takes the ownership of the source raster. It is meant to be read: a changed block would be written back into the source.
+    */
+    class TEGROWTHEXPORT BlockCachedRaster : protected SourceRasterHolder, public te::mem::CachedRaster
+    {
+      public:
+
+        //!< The cache size is given in megabytes
+        BlockCachedRaster(te::rst::Raster* sourceRaster, std::size_t cacheSize, unsigned int prefetchThreshold);
+
+        ~BlockCachedRaster();
+
+        //!< Returns the number of blocks of the raster that fit in the given megabytes. At least two rows of blocks of each band are kept, so a scan never releases the blocks of its current row
+        static std::size_t getNumberOfCacheBlocks(const te::rst::Raster* raster, std::size_t cacheSize);
+    };
+  }
+}
+
+#endif //__URBANANALYSIS_INTERNAL_GROWTH_BLOCKCACHEDRASTER_H
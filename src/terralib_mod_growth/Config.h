@@ -63,4 +63,215 @@
 
 //@}
 
+/** @name Neighborhood kernels
+ *  Flags for the SIMD versions of the neighborhood kernels and for the choice of the kernel
+ */
+//@{
+
+/*!
+  \def TEGROWTH_X86
+
+  \brief Defined when the module is compiled for a x86 or x86-64 processor. In this case the SSE2 and AVX2 kernels are compiled and the fastest one is chosen at runtime.
+*/
+#if defined(_M_X64) || defined(_M_IX86) || defined(__x86_64__) || defined(__i386__)
+  #define TEGROWTH_X86
+#endif
+
+/*!
+  \def TEGROWTH_FFT_MINIMUM_RADIUS
+
+  \brief The smallest radius, in pixels, whose neighborhood is counted by the FFT kernel when the automatic kernel is chosen. Smaller radii use the prefix sums.
+*/
+#ifndef TEGROWTH_FFT_MINIMUM_RADIUS
+  #define TEGROWTH_FFT_MINIMUM_RADIUS 100
+#endif
+
+/*!
+  \def TEGROWTH_FFT_MEMORY_SIZE
+
+  \brief The memory, in megabytes, that the FFT counters of a classification may use together. The number of threads is reduced to fit it, but at least one thread is always used.
+*/
+#ifndef TEGROWTH_FFT_MEMORY_SIZE
+  #define TEGROWTH_FFT_MEMORY_SIZE 1024
+#endif
+
+/*!
+  \def TEGROWTH_PROGRESS_STRIP_ROWS
+
+  \brief The number of rows of the strips whose classification pulses the progress of the task. Each thread pulses the task when it finishes a strip of its band.
+*/
+#ifndef TEGROWTH_PROGRESS_STRIP_ROWS
+  #define TEGROWTH_PROGRESS_STRIP_ROWS 64
+#endif
+
+//@}
+
+/** @name Raster access
+ *  Flags for the rasters that are read from the files only when they are accessed
+ */
+//@{
+
+/*!
+  \def TEGROWTH_RASTER_CACHE_SIZE
+
+  \brief The default size, in megabytes, of the block cache of a raster opened with RASTER_BLOCK_CACHE.
+*/
+#ifndef TEGROWTH_RASTER_CACHE_SIZE
+  #define TEGROWTH_RASTER_CACHE_SIZE 256
+#endif
+
+/*!
+  \def TEGROWTH_RASTER_PREFETCH_THRESHOLD
+
+  \brief The prefetch threshold of the block cache. 0 disables the background reading of the next block, 1 always reads it and higher values only read it when the scan seems sequential.
+*/
+#ifndef TEGROWTH_RASTER_PREFETCH_THRESHOLD
+  #define TEGROWTH_RASTER_PREFETCH_THRESHOLD 1
+#endif
+
+//@}
+
+/** @name Raster writing
+ *  Flags for the rasters that are saved into files
+ */
+//@{
+
+/*!
+  \def TEGROWTH_RASTER_BLOCK_SIZE
+
+  \brief The default width and height, in pixels, of the tiles of the created GeoTIFF files.
+*/
+#ifndef TEGROWTH_RASTER_BLOCK_SIZE
+  #define TEGROWTH_RASTER_BLOCK_SIZE 256
+#endif
+
+/*!
+  \def TEGROWTH_RASTER_WRITER_THREADS
+
+  \brief The default number of I/O threads of a RasterWriter.
+*/
+#ifndef TEGROWTH_RASTER_WRITER_THREADS
+  #define TEGROWTH_RASTER_WRITER_THREADS 2
+#endif
+
+/*!
+  \def TEGROWTH_RASTER_WRITER_QUEUE_SIZE
+
+  \brief The default number of rasters that can wait to be written by a RasterWriter. When the queue is full, a new write waits for the I/O threads.
+*/
+#ifndef TEGROWTH_RASTER_WRITER_QUEUE_SIZE
+  #define TEGROWTH_RASTER_WRITER_QUEUE_SIZE 4
+#endif
+
+//@}
+
+/** @name Native rasters
+ *  Flags for the native format of the intermediate rasters. The LZ4 compression is only available when the build system finds the LZ4 library and defines TEGROWTH_LZ4
+ */
+//@{
+
+/*!
+  \def TEGROWTH_NATIVE_RASTER_EXTENSION
+
+  \brief The extension of the native raster files. openRaster and saveRaster use the native format for the files with this extension.
+*/
+#ifndef TEGROWTH_NATIVE_RASTER_EXTENSION
+  #define TEGROWTH_NATIVE_RASTER_EXTENSION ".ugr"
+#endif
+
+/*!
+  \def TEGROWTH_NATIVE_RASTER_ALIGNMENT
+
+  \brief The alignment, in bytes, of the first plane of a native raster file. It must be a multiple of the page size, so the planes can be memory-mapped.
+*/
+#ifndef TEGROWTH_NATIVE_RASTER_ALIGNMENT
+  #define TEGROWTH_NATIVE_RASTER_ALIGNMENT 4096
+#endif
+
+/*!
+  \def TEGROWTH_NATIVE_RASTER_CHUNK_ROWS
+
+  \brief The default number of rows of the chunks of a native raster file, which are compressed and decompressed independently.
+*/
+#ifndef TEGROWTH_NATIVE_RASTER_CHUNK_ROWS
+  #define TEGROWTH_NATIVE_RASTER_CHUNK_ROWS 256
+#endif
+
+//@}
+
+/** @name Reprojection
+ *  Flags for the transformation of the pixels of a raster into the grid of another raster
+ */
+//@{
+
+/*!
+  \def TEGROWTH_TRANSFORM_MAX_ERROR
+
+  \brief The default maximum error, in pixels of the source raster, of the approximate transformation of normalizeRaster. 0 transforms all the pixels exactly.
+*/
+#ifndef TEGROWTH_TRANSFORM_MAX_ERROR
+  #define TEGROWTH_TRANSFORM_MAX_ERROR 0.125
+#endif
+
+/*!
+  \def TEGROWTH_ALIGNED_GRID_TOLERANCE
+
+  \brief The largest misalignment, in pixels, between two grids with the same SRID and resolution whose pixels are copied without any resampling by normalizeRaster.
+*/
+#ifndef TEGROWTH_ALIGNED_GRID_TOLERANCE
+  #define TEGROWTH_ALIGNED_GRID_TOLERANCE 0.001
+#endif
+
+/*!
+  \def TEGROWTH_TRANSFORM_MINIMUM_SPAN
+
+  \brief The number of pixels of the shortest span of a row that the approximate transformation interpolates. Shorter spans are transformed exactly.
+*/
+#ifndef TEGROWTH_TRANSFORM_MINIMUM_SPAN
+  #define TEGROWTH_TRANSFORM_MINIMUM_SPAN 8
+#endif
+
+/*!
+  \def TEGROWTH_RESAMPLE_TILE_SIZE
+
+  \brief The width and height, in pixels, of the tiles of the output that are resampled in parallel by normalizeRaster.
+*/
+#ifndef TEGROWTH_RESAMPLE_TILE_SIZE
+  #define TEGROWTH_RESAMPLE_TILE_SIZE 256
+#endif
+
+//@}
+
+/** @name Connected components
+ *  Flags for the labeling of the connected components of a raster
+ */
+//@{
+
+/*!
+  \def TEGROWTH_LABEL_TILE_SIZE
+
+  \brief The width and height, in pixels, of the tiles that are labeled independently, in parallel, before their labels are merged across the borders of the tiles.
+*/
+#ifndef TEGROWTH_LABEL_TILE_SIZE
+  #define TEGROWTH_LABEL_TILE_SIZE 512
+#endif
+
+//@}
+
+/** @name Result cache
+ *  Flags for the cache of the prepared rasters
+ */
+//@{
+
+/*!
+  \def TEGROWTH_RESULT_CACHE_VERSION
+
+  \brief The version of the algorithms that prepare the rasters. It is part of the keys of the result cache, so it must be changed whenever the results of these algorithms change.
+*/
+#ifndef TEGROWTH_RESULT_CACHE_VERSION
+  #define TEGROWTH_RESULT_CACHE_VERSION "1"
+#endif
+
+//@}
+
 #endif  // __URBANANALYSIS_INTERNAL_GROWTH_CONFIG_H
@@ -0,0 +1,562 @@
+/*  Copyright (C) 2011-2012 National Institute For Space Research (INPE) - Brazil.
+
+This file is part of the TerraLib - a Framework for building GIS enabled applications.
+
+TerraLib is free software: you can redistribute it and/or modify
+it under the terms of the GNU Lesser General Public License as published by
+the Free Software Foundation, either version 3 of the License,
+or (at your option) any later version.
+
+TerraLib is distributed in the hope that it will be useful,
+but WITHOUT ANY WARRANTY; without even the implied warranty of
+MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE. See the
+GNU Lesser General Public License for more details.
+
+You should have received a copy of the GNU Lesser General Public License
+along with TerraLib. See COPYING. If not, write to
+TerraLib Team at <terralib-team@terralib.org>.
+*/
+
+
+/*!
+\file urban_analysis/src/growth/ConnectedComponents.cpp
+
+\brief This file contains the labeling of the connected components of a raster
+*/
+
+#include "ConnectedComponents.h"
+#include "PixelPlane.h"
+#include "Neighborhood.h"
+#include "Utils.h"
+
+//Terralib
+#include <terralib/common/Exception.h>
+#include <terralib/datatype/Enums.h>
+#include <terralib/raster/Band.h>
+#include <terralib/raster/BandProperty.h>
+#include <terralib/raster/Raster.h>
+
+#include <algorithm>
+#include <cassert>
+#include <limits>
+
+namespace te
+{
+  namespace urban
+  {
+    //!< First pass over a row - each foreground pixel takes the smallest label of its labeled neighbors (west, northwest, north and northeast), and these labels are united
+    void labelRow(const unsigned char* foreground, std::size_t numColumns, unsigned int* labels, const unsigned int* previousLabels, UnionFind& unionFind)
+    {
+      for (std::size_t column = 0; column < numColumns; ++column)
+      {
+        if (foreground[column] == 0)
+        {
+          labels[column] = 0;
+          continue;
+        }
+
+        unsigned int neighbors[4] = { 0, 0, 0, 0 };
+        if (column > 0)
+        {
+          neighbors[0] = labels[column - 1];
+        }
+        if (previousLabels != 0)
+        {
+          if (column > 0)
+          {
+            neighbors[1] = previousLabels[column - 1];
+          }
+          neighbors[2] = previousLabels[column];
+          if (column + 1 < numColumns)
+          {
+            neighbors[3] = previousLabels[column + 1];
+          }
+        }
+
+        unsigned int label = 0;
+        for (std::size_t i = 0; i < 4; ++i)
+        {
+          if (neighbors[i] == 0)
+          {
+            continue;
+          }
+
+          label = (label == 0) ? neighbors[i] : unionFind.unite(label, neighbors[i]);
+        }
+
+        labels[column] = (label == 0) ? unionFind.add() : label;
+      }
+    }
+
+    //!< Numbers the roots of the sets from 1, in the order of their labels. Returns the number of sets
+    std::size_t numberSets(UnionFind& unionFind, std::vector<unsigned int>& vecFinalLabels)
+    {
+      //the root of each set is its first label in scan order, so numbering the roots in the order of the labels numbers the components by their first pixel
+      vecFinalLabels.assign(unionFind.getNumberOfLabels(), 0);
+
+      std::size_t numSets = 0;
+      for (std::size_t label = 1; label < vecFinalLabels.size(); ++label)
+      {
+        unsigned int root = unionFind.find((unsigned int)label);
+        vecFinalLabels[label] = (root == label) ? (unsigned int)++numSets : vecFinalLabels[root];
+      }
+      return numSets;
+    }
+
+    void checkNumberOfPixels(te::rst::Raster* inputRaster, const std::string& functionName)
+    {
+      if ((double)inputRaster->getNumberOfRows() * (double)inputRaster->getNumberOfColumns() >= (double)std::numeric_limits<unsigned int>::max())
+      {
+        throw te::common::Exception("The raster has too many pixels to be labeled. Error in function: " + functionName);
+      }
+    }
+  }
+}
+
+int te::urban::getLabelDataType(std::size_t numLabels)
+{
+  if (numLabels <= std::numeric_limits<unsigned char>::max())
+  {
+    return te::dt::UCHAR_TYPE;
+  }
+  if (numLabels <= (std::size_t)std::numeric_limits<short>::max())
+  {
+    return te::dt::INT16_TYPE;
+  }
+  return te::dt::INT32_TYPE;
+}
+
+std::auto_ptr<te::rst::Raster> te::urban::labelConnectedComponents(te::rst::Raster* inputRaster, std::size_t& numComponents)
+{
+  assert(inputRaster);
+
+  std::size_t numRows = inputRaster->getNumberOfRows();
+  std::size_t numColumns = inputRaster->getNumberOfColumns();
+
+  checkNumberOfPixels(inputRaster, "labelConnectedComponents");
+
+  //first pass - the pixels are labeled row by row
+  std::vector<unsigned int> vecLabels(numRows * numColumns, 0);
+  UnionFind unionFind;
+
+  std::size_t stripNumRows = getStripNumberOfRows(inputRaster);
+  std::vector<unsigned char> vecForeground;
+
+  for (std::size_t stripFirstRow = 0; stripFirstRow < numRows; stripFirstRow += stripNumRows)
+  {
+    readDataMask(inputRaster, 0, stripFirstRow, stripNumRows, vecForeground);
+
+    std::size_t stripNumRowsRead = vecForeground.size() / numColumns;
+    for (std::size_t stripRow = 0; stripRow < stripNumRowsRead; ++stripRow)
+    {
+      std::size_t row = stripFirstRow + stripRow;
+      unsigned int* labels = &vecLabels[row * numColumns];
+      const unsigned int* previousLabels = (row > 0) ? labels - numColumns : 0;
+
+      labelRow(&vecForeground[stripRow * numColumns], numColumns, labels, previousLabels, unionFind);
+    }
+  }
+
+  std::vector<unsigned int> vecFinalLabels;
+  numComponents = numberSets(unionFind, vecFinalLabels);
+
+  //second pass - the provisional labels are replaced by the final ones
+  std::auto_ptr<te::rst::Raster> outputRaster = cloneRasterIntoMem(inputRaster, false, getLabelDataType(numComponents));
+
+  std::size_t outputStripNumRows = getStripNumberOfRows(outputRaster.get());
+  PixelPlane<unsigned int> outputStrip;
+
+  for (std::size_t stripFirstRow = 0; stripFirstRow < numRows; stripFirstRow += outputStripNumRows)
+  {
+    outputStrip = PixelPlane<unsigned int>(std::min(outputStripNumRows, numRows - stripFirstRow), numColumns, 0);
+    outputStrip.setFirstRow(stripFirstRow);
+
+    for (std::size_t stripRow = 0; stripRow < outputStrip.getNumberOfRows(); ++stripRow)
+    {
+      const unsigned int* labels = &vecLabels[(stripFirstRow + stripRow) * numColumns];
+      unsigned int* outputValues = outputStrip.getRow(stripRow);
+
+      for (std::size_t column = 0; column < numColumns; ++column)
+      {
+        outputValues[column] = vecFinalLabels[labels[column]];
+      }
+    }
+
+    outputStrip.write(outputRaster.get());
+  }
+
+  return outputRaster;
+}
+
+te::urban::ConnectedComponentsLabeler::ConnectedComponentsLabeler(te::rst::Raster* inputRaster, std::size_t numberOfThreads, std::size_t tileSize, bool streamTiles)
+  : m_inputRaster(inputRaster)
+  , m_numberOfThreads(getNumberOfThreads(numberOfThreads))
+  , m_tileSize(std::max(tileSize, (std::size_t)1))
+  , m_streamTiles(streamTiles)
+  , m_numTileRows(0)
+  , m_numTileColumns(0)
+  , m_nextTile(0)
+  , m_lastTile(0)
+{
+  assert(inputRaster);
+
+  m_numTileRows = (inputRaster->getNumberOfRows() + m_tileSize - 1) / m_tileSize;
+  m_numTileColumns = (inputRaster->getNumberOfColumns() + m_tileSize - 1) / m_tileSize;
+}
+
+std::auto_ptr<te::rst::Raster> te::urban::ConnectedComponentsLabeler::label(std::size_t& numComponents)
+{
+  checkNumberOfPixels(m_inputRaster, "ConnectedComponentsLabeler::label");
+
+  std::size_t numRows = m_inputRaster->getNumberOfRows();
+  std::size_t numColumns = m_inputRaster->getNumberOfColumns();
+  std::size_t numTiles = m_numTileRows * m_numTileColumns;
+
+  //first pass - the tiles are labeled independently, a strip of tiles at a time. The strip is read once and shared by the threads
+  m_vecTiles.assign(numTiles, TileLabels());
+  for (std::size_t tileRow = 0; tileRow < m_numTileRows; ++tileRow)
+  {
+    readDataMask(m_inputRaster, 0, tileRow * m_tileSize, m_tileSize, m_vecInputStrip);
+    runPass(false, tileRow * m_numTileColumns, (tileRow + 1) * m_numTileColumns);
+  }
+
+  //the labels of the tiles are placed one after the other in a single sequence of global labels
+  m_vecTileOffsets.resize(numTiles);
+  std::size_t numLabels = 1;
+  for (std::size_t tile = 0; tile < numTiles; ++tile)
+  {
+    m_vecTileOffsets[tile] = numLabels - 1;
+    numLabels += m_vecTiles[tile].m_numLabels;
+  }
+
+  UnionFind unionFind(numLabels);
+  mergeTiles(unionFind);
+
+  //the threads of the second pass only read the roots, as finding them changes the union-find
+  m_vecRoots.resize(numLabels);
+  numComponents = 0;
+  for (std::size_t label = 0; label < numLabels; ++label)
+  {
+    m_vecRoots[label] = unionFind.find((unsigned int)label);
+    if (label != 0 && m_vecRoots[label] == label)
+    {
+      ++numComponents;
+    }
+  }
+
+  //second pass - the tiles are labeled with the roots of their labels, a strip of tiles at a time. Then the roots are numbered in scan order
+  std::auto_ptr<te::rst::Raster> outputRaster = cloneRasterIntoMem(m_inputRaster, false, getLabelDataType(numComponents));
+
+  std::vector<unsigned int> vecFinalLabels(numLabels, 0);
+  unsigned int nextLabel = 1;
+
+  for (std::size_t tileRow = 0; tileRow < m_numTileRows; ++tileRow)
+  {
+    std::size_t stripFirstRow = tileRow * m_tileSize;
+
+    m_outputStrip = PixelPlane<unsigned int>(std::min(m_tileSize, numRows - stripFirstRow), numColumns, 0);
+    m_outputStrip.setFirstRow(stripFirstRow);
+
+    //the streamed tiles are labeled again, so their strip is read again
+    if (m_streamTiles)
+    {
+      readDataMask(m_inputRaster, 0, stripFirstRow, m_tileSize, m_vecInputStrip);
+    }
+
+    runPass(true, tileRow * m_numTileColumns, (tileRow + 1) * m_numTileColumns);
+
+    for (std::size_t row = 0; row < m_outputStrip.getNumberOfRows(); ++row)
+    {
+      unsigned int* outputValues = m_outputStrip.getRow(row);
+      for (std::size_t column = 0; column < numColumns; ++column)
+      {
+        unsigned int root = outputValues[column];
+        if (root != 0 && vecFinalLabels[root] == 0)
+        {
+          vecFinalLabels[root] = nextLabel++;
+        }
+        outputValues[column] = vecFinalLabels[root];
+      }
+    }
+
+    m_outputStrip.write(outputRaster.get());
+  }
+
+  m_outputStrip = PixelPlane<unsigned int>();
+  std::vector<unsigned char>().swap(m_vecInputStrip);
+  m_vecTiles.clear();
+  m_vecTileOffsets.clear();
+  m_vecRoots.clear();
+
+  return outputRaster;
+}
+
+void te::urban::ConnectedComponentsLabeler::runPass(bool merged, std::size_t firstTile, std::size_t lastTile)
+{
+  m_nextTile = firstTile;
+  m_lastTile = lastTile;
+
+  //there is no gain in having more threads than tiles
+  std::size_t numberOfThreads = std::min(m_numberOfThreads, lastTile - firstTile);
+
+  boost::thread_group threadGroup;
+  for (std::size_t i = 0; i < numberOfThreads; ++i)
+  {
+    threadGroup.create_thread(boost::bind(&ConnectedComponentsLabeler::labelTiles, this, merged));
+  }
+  threadGroup.join_all();
+
+  if (m_errorMessage.empty() == false)
+  {
+    throw te::common::Exception(m_errorMessage + " Error in function: ConnectedComponentsLabeler::label");
+  }
+}
+
+void te::urban::ConnectedComponentsLabeler::labelTiles(bool merged)
+{
+  std::vector<unsigned int> vecLabels;
+
+  while (true)
+  {
+    std::size_t tile = 0;
+    {
+      boost::mutex::scoped_lock lock(m_tileMutex);
+      if (m_errorMessage.empty() == false || m_nextTile >= m_lastTile)
+      {
+        return;
+      }
+
+      tile = m_nextTile;
+      ++m_nextTile;
+    }
+
+    try
+    {
+      UnionFind unionFind;
+      if (merged)
+      {
+        writeMergedTile(tile, vecLabels, unionFind);
+      }
+      else
+      {
+        keepTile(tile, labelTile(tile, vecLabels, unionFind), vecLabels);
+      }
+    }
+    catch (const std::exception& e)
+    {
+      boost::mutex::scoped_lock lock(m_tileMutex);
+      m_errorMessage = e.what();
+      return;
+    }
+  }
+}
+
+std::size_t te::urban::ConnectedComponentsLabeler::labelTile(std::size_t tile, std::vector<unsigned int>& vecLabels, UnionFind& unionFind)
+{
+  std::size_t firstRow = 0;
+  std::size_t numRows = 0;
+  std::size_t firstColumn = 0;
+  std::size_t numColumns = 0;
+  getTileWindow(tile, firstRow, numRows, firstColumn, numColumns);
+
+  //the strip of the tile is only read by the threads, so it is not locked
+  std::size_t stripNumColumns = m_inputRaster->getNumberOfColumns();
+
+  vecLabels.resize(numRows * numColumns);
+  for (std::size_t row = 0; row < numRows; ++row)
+  {
+    unsigned int* labels = &vecLabels[row * numColumns];
+    const unsigned int* previousLabels = (row > 0) ? labels - numColumns : 0;
+
+    labelRow(&m_vecInputStrip[row * stripNumColumns + firstColumn], numColumns, labels, previousLabels, unionFind);
+  }
+
+  //the local labels are numbered from 1 in the scan order of the tile, so the labels of the tiles are compact
+  std::vector<unsigned int> vecFinalLabels;
+  std::size_t numLabels = numberSets(unionFind, vecFinalLabels);
+  for (std::size_t i = 0; i < vecLabels.size(); ++i)
+  {
+    vecLabels[i] = vecFinalLabels[vecLabels[i]];
+  }
+
+  return numLabels;
+}
+
+void te::urban::ConnectedComponentsLabeler::keepTile(std::size_t tile, std::size_t numLabels, const std::vector<unsigned int>& vecLabels)
+{
+  if (numLabels == 0)
+  {
+    return;
+  }
+
+  std::size_t firstRow = 0;
+  std::size_t numRows = 0;
+  std::size_t firstColumn = 0;
+  std::size_t numColumns = 0;
+  getTileWindow(tile, firstRow, numRows, firstColumn, numColumns);
+
+  TileLabels& tileLabels = m_vecTiles[tile];
+  tileLabels.m_numLabels = numLabels;
+  tileLabels.m_vecTopRow.assign(vecLabels.begin(), vecLabels.begin() + numColumns);
+  tileLabels.m_vecBottomRow.assign(vecLabels.end() - numColumns, vecLabels.end());
+  tileLabels.m_vecLeftColumn.resize(numRows);
+  tileLabels.m_vecRightColumn.resize(numRows);
+  for (std::size_t row = 0; row < numRows; ++row)
+  {
+    tileLabels.m_vecLeftColumn[row] = vecLabels[row * numColumns];
+    tileLabels.m_vecRightColumn[row] = vecLabels[row * numColumns + numColumns - 1];
+  }
+
+  if (m_streamTiles == false)
+  {
+    tileLabels.m_vecLabels = vecLabels;
+  }
+}
+
+void te::urban::ConnectedComponentsLabeler::writeMergedTile(std::size_t tile, std::vector<unsigned int>& vecLabels, UnionFind& unionFind)
+{
+  TileLabels& tileLabels = m_vecTiles[tile];
+
+  //the tiles without any foreground pixel keep the background of the strip
+  if (tileLabels.m_numLabels == 0)
+  {
+    return;
+  }
+
+  std::size_t firstRow = 0;
+  std::size_t numRows = 0;
+  std::size_t firstColumn = 0;
+  std::size_t numColumns = 0;
+  getTileWindow(tile, firstRow, numRows, firstColumn, numColumns);
+
+  //the labeling of a tile is deterministic, so a streamed tile is labeled again exactly as in the first pass
+  if (m_streamTiles)
+  {
+    labelTile(tile, vecLabels, unionFind);
+  }
+  else
+  {
+    vecLabels.swap(tileLabels.m_vecLabels);
+    std::vector<unsigned int>().swap(tileLabels.m_vecLabels);
+  }
+
+  std::size_t offset = m_vecTileOffsets[tile];
+  for (std::size_t row = 0; row < numRows; ++row)
+  {
+    const unsigned int* labels = &vecLabels[row * numColumns];
+    unsigned int* outputValues = m_outputStrip.getRow(row) + firstColumn;
+
+    for (std::size_t column = 0; column < numColumns; ++column)
+    {
+      outputValues[column] = (labels[column] == 0) ? 0 : m_vecRoots[offset + labels[column]];
+    }
+  }
+}
+
+void te::urban::ConnectedComponentsLabeler::mergeTiles(UnionFind& unionFind) const
+{
+  for (std::size_t tileRow = 0; tileRow < m_numTileRows; ++tileRow)
+  {
+    for (std::size_t tileColumn = 0; tileColumn < m_numTileColumns; ++tileColumn)
+    {
+      std::size_t tile = tileRow * m_numTileColumns + tileColumn;
+      const TileLabels& tileLabels = m_vecTiles[tile];
+      if (tileLabels.m_numLabels == 0)
+      {
+        continue;
+      }
+
+      unsigned int offset = (unsigned int)m_vecTileOffsets[tile];
+
+      //the right column of the tile touches the left column of the next tile in the same rows and in the rows above and below
+      if (tileColumn + 1 < m_numTileColumns && m_vecTiles[tile + 1].m_numLabels != 0)
+      {
+        const std::vector<unsigned int>& vecRightColumn = tileLabels.m_vecRightColumn;
+        const std::vector<unsigned int>& vecLeftColumn = m_vecTiles[tile + 1].m_vecLeftColumn;
+        unsigned int nextOffset = (unsigned int)m_vecTileOffsets[tile + 1];
+
+        for (std::size_t row = 0; row < vecRightColumn.size(); ++row)
+        {
+          if (vecRightColumn[row] == 0)
+          {
+            continue;
+          }
+
+          std::size_t firstNeighbor = (row > 0) ? row - 1 : 0;
+          std::size_t lastNeighbor = std::min(row + 1, vecLeftColumn.size() - 1);
+          for (std::size_t neighbor = firstNeighbor; neighbor <= lastNeighbor; ++neighbor)
+          {
+            if (vecLeftColumn[neighbor] != 0)
+            {
+              unionFind.unite(offset + vecRightColumn[row], nextOffset + vecLeftColumn[neighbor]);
+            }
+          }
+        }
+      }
+
+      if (tileRow + 1 == m_numTileRows)
+      {
+        continue;
+      }
+
+      //the bottom row of the tile touches the top row of the tile below in the same columns and in the columns to the left and to the right
+      std::size_t tileBelow = tile + m_numTileColumns;
+      const std::vector<unsigned int>& vecBottomRow = tileLabels.m_vecBottomRow;
+
+      if (m_vecTiles[tileBelow].m_numLabels != 0)
+      {
+        const std::vector<unsigned int>& vecTopRow = m_vecTiles[tileBelow].m_vecTopRow;
+        unsigned int belowOffset = (unsigned int)m_vecTileOffsets[tileBelow];
+
+        for (std::size_t column = 0; column < vecBottomRow.size(); ++column)
+        {
+          if (vecBottomRow[column] == 0)
+          {
+            continue;
+          }
+
+          std::size_t firstNeighbor = (column > 0) ? column - 1 : 0;
+          std::size_t lastNeighbor = std::min(column + 1, vecTopRow.size() - 1);
+          for (std::size_t neighbor = firstNeighbor; neighbor <= lastNeighbor; ++neighbor)
+          {
+            if (vecTopRow[neighbor] != 0)
+            {
+              unionFind.unite(offset + vecBottomRow[column], belowOffset + vecTopRow[neighbor]);
+            }
+          }
+        }
+      }
+
+      //the corners of the tile touch the corners of the tiles below and to the left and to the right
+      if (tileColumn + 1 < m_numTileColumns && m_vecTiles[tileBelow + 1].m_numLabels != 0)
+      {
+        unsigned int cornerLabel = vecBottomRow.back();
+        unsigned int neighborLabel = m_vecTiles[tileBelow + 1].m_vecTopRow.front();
+        if (cornerLabel != 0 && neighborLabel != 0)
+        {
+          unionFind.unite(offset + cornerLabel, (unsigned int)m_vecTileOffsets[tileBelow + 1] + neighborLabel);
+        }
+      }
+      if (tileColumn > 0 && m_vecTiles[tileBelow - 1].m_numLabels != 0)
+      {
+        unsigned int cornerLabel = vecBottomRow.front();
+        unsigned int neighborLabel = m_vecTiles[tileBelow - 1].m_vecTopRow.back();
+        if (cornerLabel != 0 && neighborLabel != 0)
+        {
+          unionFind.unite(offset + cornerLabel, (unsigned int)m_vecTileOffsets[tileBelow - 1] + neighborLabel);
+        }
+      }
+    }
+  }
+}
+
+void te::urban::ConnectedComponentsLabeler::getTileWindow(std::size_t tile, std::size_t& firstRow, std::size_t& numRows, std::size_t& firstColumn, std::size_t& numColumns) const
+{
+  std::size_t tileRow = tile / m_numTileColumns;
+  std::size_t tileColumn = tile % m_numTileColumns;
+
+  firstRow = tileRow * m_tileSize;
+  numRows = std::min(m_tileSize, m_inputRaster->getNumberOfRows() - firstRow);
+  firstColumn = tileColumn * m_tileSize;
+  numColumns = std::min(m_tileSize, m_inputRaster->getNumberOfColumns() - firstColumn);
+}
@@ -0,0 +1,210 @@
+/*  Copyright (C) 2011-2012 National Institute For Space Research (INPE) - Brazil.
+
+This file is part of the TerraLib - a Framework for building GIS enabled applications.
+
+TerraLib is free software: you can redistribute it and/or modify
+it under the terms of the GNU Lesser General Public License as published by
+the Free Software Foundation, either version 3 of the License,
+or (at your option) any later version.
+
+TerraLib is distributed in the hope that it will be useful,
+but WITHOUT ANY WARRANTY; without even the implied warranty of
+MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE. See the
+GNU Lesser General Public License for more details.
+
+You should have received a copy of the GNU Lesser General Public License
+along with TerraLib. See COPYING. If not, write to
+TerraLib Team at <terralib-team@terralib.org>.
+*/
+
+
+/*!
+\file urban_analysis/src/growth/ConnectedComponents.h
+
+\brief This file contains the labeling of the connected components of a raster
+*/
+
+#ifndef __URBANANALYSIS_INTERNAL_GROWTH_CONNECTEDCOMPONENTS_H
+#define __URBANANALYSIS_INTERNAL_GROWTH_CONNECTEDCOMPONENTS_H
+
+#include "Config.h"
+#include "PixelPlane.h"
+
+//Boost
+#include <boost/thread.hpp>
+
+#include <algorithm>
+#include <cstddef>
+#include <memory>
+#include <string>
+#include <vector>
+
+namespace te
+{
+  namespace rst
+  {
+    class Raster;
+  }
+
+  namespace urban
+  {
+    /*!
+      \brief A disjoint set of labels. The label 0 is the background and is never united with the others.
+
+      The root of a set is always its smallest label, so when the labels are created in scan order, the root of a set is the label of its first pixel.
+    */
+    class TEGROWTHEXPORT UnionFind
+    {
+      public:
+
+        UnionFind()
+          : m_vecParents(1, 0)
+        {}
+
+        //!< Creates the sets of the labels [1, numLabels), each one with a single label
+        explicit UnionFind(std::size_t numLabels)
+          : m_vecParents(std::max(numLabels, (std::size_t)1))
+        {
+          for (std::size_t i = 0; i < m_vecParents.size(); ++i)
+          {
+            m_vecParents[i] = (unsigned int)i;
+          }
+        }
+
+        //!< Creates a new set and returns its label
+        unsigned int add()
+        {
+          unsigned int label = (unsigned int)m_vecParents.size();
+          m_vecParents.push_back(label);
+          return label;
+        }
+
+        //!< Returns the root of the set of the given label, halving the path to it
+        unsigned int find(unsigned int label)
+        {
+          while (m_vecParents[label] != label)
+          {
+            m_vecParents[label] = m_vecParents[m_vecParents[label]];
+            label = m_vecParents[label];
+          }
+          return label;
+        }
+
+        //!< Unites the sets of the given labels and returns the root of the union
+        unsigned int unite(unsigned int label1, unsigned int label2)
+        {
+          unsigned int root1 = find(label1);
+          unsigned int root2 = find(label2);
+
+          if (root1 < root2)
+          {
+            m_vecParents[root2] = root1;
+            return root1;
+          }
+
+          m_vecParents[root1] = root2;
+          return root2;
+        }
+
+        //!< Returns the number of labels, including the background
+        std::size_t getNumberOfLabels() const { return m_vecParents.size(); }
+
+      protected:
+
+        std::vector<unsigned int> m_vecParents;
+    };
+
+    /*!
+      \brief Labels the connected components of the first band of the given raster by two passes over the pixels.
+
+      All the pixels that are not no data are foreground, and two foreground pixels are connected when they touch by a side or a corner (8-connectivity),
+      like the touching polygons of the vectorized raster. The components are labeled from 1, in the order of their first pixel in a row by row scan,
+      and the no data pixels are labeled 0. The data type of the output is the smallest that fits the number of components.
+    */
+    TEGROWTHEXPORT std::auto_ptr<te::rst::Raster> labelConnectedComponents(te::rst::Raster* inputRaster, std::size_t& numComponents);
+
+    /*!
+      \brief Labels the connected components of the first band of a raster like labelConnectedComponents, tile by tile, in parallel.
+
+      The tiles are labeled independently by the threads, a strip of tiles at a time. Each strip is read once, as a mask of its foreground pixels, and is
+      shared by the threads, so the input raster is only read by the calling thread, as the cached rasters cannot be read concurrently. Only the labels
+      of the borders of the tiles are needed to merge the components that cross them, in a union-find of the labels of all the tiles. Then the tiles
+      are labeled again with the merged labels and the components are numbered in the order of their first pixel, so the labels are identical to the
+      ones of labelConnectedComponents.
+    */
+    class TEGROWTHEXPORT ConnectedComponentsLabeler
+    {
+      public:
+
+        /*!
+          If the number of threads is 0, one thread per core is used. When the tiles are streamed, the labels of the tiles are not kept in memory
+          between the two passes: the strips of tiles are read and labeled again, so only the borders of the tiles and a strip of tiles are held at once
+        */
+        ConnectedComponentsLabeler(te::rst::Raster* inputRaster, std::size_t numberOfThreads = 0, std::size_t tileSize = TEGROWTH_LABEL_TILE_SIZE, bool streamTiles = false);
+
+        //!< Labels the components and returns them in a new raster, whose data type is the smallest that fits the number of components
+        std::auto_ptr<te::rst::Raster> label(std::size_t& numComponents);
+
+      protected:
+
+        //!< The local labels of a tile, from 1 in the scan order of the tile, and the labels of its borders
+        struct TileLabels
+        {
+          TileLabels()
+            : m_numLabels(0)
+          {}
+
+          std::size_t m_numLabels;
+          std::vector<unsigned int> m_vecLabels; //!< empty when the tiles are streamed
+          std::vector<unsigned int> m_vecTopRow;
+          std::vector<unsigned int> m_vecBottomRow;
+          std::vector<unsigned int> m_vecLeftColumn;
+          std::vector<unsigned int> m_vecRightColumn;
+        };
+
+        //!< Runs the given pass over the tiles [firstTile, lastTile) in the threads
+        void runPass(bool merged, std::size_t firstTile, std::size_t lastTile);
+
+        //!< The loop of the threads, which label the tiles until there are no more tiles
+        void labelTiles(bool merged);
+
+        //!< Labels the given tile locally. Returns the number of labels of the tile
+        std::size_t labelTile(std::size_t tile, std::vector<unsigned int>& vecLabels, UnionFind& unionFind);
+
+        //!< Keeps the borders of the given tile, labeled in the first pass, and its labels when the tiles are not streamed
+        void keepTile(std::size_t tile, std::size_t numLabels, const std::vector<unsigned int>& vecLabels);
+
+        //!< Writes the merged labels of the given tile in the current strip of the output
+        void writeMergedTile(std::size_t tile, std::vector<unsigned int>& vecLabels, UnionFind& unionFind);
+
+        //!< Unites the labels of the components that cross the borders of the tiles
+        void mergeTiles(UnionFind& unionFind) const;
+
+        void getTileWindow(std::size_t tile, std::size_t& firstRow, std::size_t& numRows, std::size_t& firstColumn, std::size_t& numColumns) const;
+
+        te::rst::Raster* m_inputRaster;
+        std::size_t m_numberOfThreads;
+        std::size_t m_tileSize;
+        bool m_streamTiles;
+        std::size_t m_numTileRows;
+        std::size_t m_numTileColumns;
+
+        std::vector<TileLabels> m_vecTiles;
+        std::vector<std::size_t> m_vecTileOffsets; //!< the global label of the label 0 of each tile. The global label of a local label l is the offset plus l
+        std::vector<unsigned int> m_vecRoots;      //!< the root of each global label after the merge, which the threads read without changing the union-find
+
+        std::vector<unsigned char> m_vecInputStrip; //!< the foreground mask of the strip of tiles being labeled, which the threads only read
+        PixelPlane<unsigned int> m_outputStrip;     //!< the strip of tiles being labeled in the second pass. Each tile is filled by a single thread
+        std::size_t m_nextTile;
+        std::size_t m_lastTile;
+        std::string m_errorMessage;
+
+        boost::mutex m_tileMutex;
+    };
+
+    //!< Returns the smallest data type that fits the given number of labels, as labels of a raster whose no data value is 0
+    TEGROWTHEXPORT int getLabelDataType(std::size_t numLabels);
+  }
+}
+
+#endif //__URBANANALYSIS_INTERNAL_GROWTH_CONNECTEDCOMPONENTS_H
@@ -0,0 +1,289 @@
+/*  Copyright (C) 2011-2012 National Institute For Space Research (INPE) - Brazil.
+
+This file is part of the TerraLib - a Framework for building GIS enabled applications.
+
+TerraLib is free software: you can redistribute it and/or modify
+it under the terms of the GNU Lesser General Public License as published by
+the Free Software Foundation, either version 3 of the License,
+or (at your option) any later version.
+
+TerraLib is distributed in the hope that it will be useful,
+but WITHOUT ANY WARRANTY; without even the implied warranty of
+MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE. See the
+GNU Lesser General Public License for more details.
+
+You should have received a copy of the GNU Lesser General Public License
+along with TerraLib. See COPYING. If not, write to
+TerraLib Team at <terralib-team@terralib.org>.
+*/
+
+/*!
+\file urban_analysis/src/growth/Dilation.cpp
+
+\brief This file contains the dilation of the urban pixels of a neighborhood plane by a circular mask, calculated with an exact euclidean distance transform
+*/
+
+#include "Dilation.h"
+
+#include <terralib/common/Exception.h>
+#include <terralib/common/STLUtils.h>
+#include <terralib/common/progress/TaskProgress.h>
+
+#include <boost/thread.hpp>
+
+#include <algorithm>
+#include <cmath>
+#include <limits>
+
+bool te::urban::getMaskSquaredRadius(const boost::numeric::ublas::matrix<bool>& mask, unsigned int& squaredRadius)
+{
+  int size = (int)mask.size1();
+  if (size == 0 || (int)mask.size2() != size || (size % 2) == 0)
+  {
+    return false;
+  }
+
+  int center = size / 2;
+  if (!mask(center, center))
+  {
+    return false;
+  }
+
+  //the mask is a distance threshold if all its offsets are closer to the center than all the offsets outside it
+  long long maxInside = 0;
+  long long minOutside = std::numeric_limits<long long>::max();
+  for (int row = 0; row < size; ++row)
+  {
+    for (int column = 0; column < size; ++column)
+    {
+      long long squaredDistance = (long long)(row - center) * (row - center) + (long long)(column - center) * (column - center);
+      if (mask(row, column))
+      {
+        maxInside = std::max(maxInside, squaredDistance);
+      }
+      else
+      {
+        minOutside = std::min(minOutside, squaredDistance);
+      }
+    }
+  }
+
+  //the offsets outside the matrix must also be outside the circle
+  minOutside = std::min(minOutside, (long long)(center + 1) * (center + 1));
+
+  if (maxInside >= minOutside)
+  {
+    return false;
+  }
+
+  squaredRadius = (unsigned int)maxInside;
+  return true;
+}
+
+void te::urban::calculateColumnDistances(const NeighborhoodPlane& plane, unsigned short maxDistance, std::vector<unsigned short>& vecColumnDistances)
+{
+  std::size_t numRows = plane.m_numRows;
+  std::size_t numColumns = plane.m_numColumns;
+
+  vecColumnDistances.resize(numRows * numColumns);
+
+  //top-down: distance to the nearest urban pixel above or at the pixel
+  for (std::size_t row = 0; row < numRows; ++row)
+  {
+    const unsigned char* flags = plane.getRow(row);
+    unsigned short* distances = &vecColumnDistances[row * numColumns];
+    const unsigned short* previousDistances = (row > 0) ? distances - numColumns : 0;
+
+    for (std::size_t column = 0; column < numColumns; ++column)
+    {
+      if (flags[column] & NEIGHBORHOOD_URBAN)
+      {
+        distances[column] = 0;
+      }
+      else if (previousDistances != 0 && previousDistances[column] < maxDistance)
+      {
+        distances[column] = previousDistances[column] + 1;
+      }
+      else
+      {
+        distances[column] = maxDistance;
+      }
+    }
+  }
+
+  //bottom-up: keeps the nearest of the urban pixels above and below the pixel
+  for (std::size_t row = numRows; row-- > 1;)
+  {
+    const unsigned short* distances = &vecColumnDistances[row * numColumns];
+    unsigned short* previousDistances = &vecColumnDistances[(row - 1) * numColumns];
+
+    for (std::size_t column = 0; column < numColumns; ++column)
+    {
+      if (distances[column] < previousDistances[column])
+      {
+        previousDistances[column] = std::min<unsigned short>(previousDistances[column], distances[column] + 1);
+      }
+    }
+  }
+}
+
+void te::urban::calculateRowSquaredDistances(const std::vector<unsigned short>& vecColumnDistances, std::size_t numColumns, std::size_t row,
+                                             std::vector<boost::uint64_t>& vecSquaredDistances, std::vector<int>& vecWorkspace)
+{
+  //lower envelope of the parabolas (x - i)^2 + g(i)^2 of the columns of the row, as in the second phase of the Meijster distance transform
+  int n = (int)numColumns;
+
+  vecSquaredDistances.resize(numColumns);
+  if (n == 0)
+  {
+    return;
+  }
+
+  vecWorkspace.resize(2 * numColumns);
+  int* vecSites = &vecWorkspace[0];
+  int* vecStarts = &vecWorkspace[numColumns];
+
+  const unsigned short* g = &vecColumnDistances[row * numColumns];
+
+  int q = 0;
+  vecSites[0] = 0;
+  vecStarts[0] = 0;
+
+  for (int u = 1; u < n; ++u)
+  {
+    long long gu = (long long)g[u] * g[u];
+
+    while (q >= 0)
+    {
+      long long x = vecStarts[q];
+      long long site = vecSites[q];
+      long long distanceToSite = (x - site) * (x - site) + (long long)g[site] * g[site];
+      long long distanceToU = (x - u) * (x - u) + gu;
+      if (distanceToSite <= distanceToU)
+      {
+        break;
+      }
+      --q;
+    }
+
+    if (q < 0)
+    {
+      q = 0;
+      vecSites[0] = u;
+      continue;
+    }
+
+    //first column where u is strictly nearer than the last site of the envelope
+    long long site = vecSites[q];
+    long long numerator = (long long)u * u - site * site + gu - (long long)g[site] * g[site];
+    long long denominator = 2 * (u - site);
+    long long separation = (numerator >= 0) ? numerator / denominator : -((-numerator + denominator - 1) / denominator);
+    long long start = separation + 1;
+
+    if (start < n)
+    {
+      ++q;
+      vecSites[q] = u;
+      vecStarts[q] = (int)start;
+    }
+  }
+
+  for (int u = n - 1; u >= 0; --u)
+  {
+    long long site = vecSites[q];
+    vecSquaredDistances[u] = (boost::uint64_t)((u - site) * (u - site) + (long long)g[site] * g[site]);
+
+    if (u == vecStarts[q])
+    {
+      --q;
+    }
+  }
+}
+
+void te::urban::classifyDilatedRowBand(const NeighborhoodPlane* plane, const std::vector<unsigned short>* vecColumnDistances, unsigned int squaredRadius,
+                                       NeighborhoodRowClassifier* classifier, std::size_t firstRow, std::size_t lastRow, RowProgress* progress)
+{
+  std::size_t numColumns = plane->m_numColumns;
+
+  std::vector<boost::uint64_t> vecSquaredDistances;
+  std::vector<int> vecWorkspace;
+
+  std::vector<unsigned int> vecUrbanCount(numColumns, 0);
+  std::vector<unsigned int> vecValidCount(numColumns, 0);
+
+  for (std::size_t row = firstRow; row < lastRow; ++row)
+  {
+    calculateRowSquaredDistances(*vecColumnDistances, numColumns, row, vecSquaredDistances, vecWorkspace);
+
+    for (std::size_t column = 0; column < numColumns; ++column)
+    {
+      vecUrbanCount[column] = (vecSquaredDistances[column] <= squaredRadius) ? 1 : 0;
+    }
+
+    classifier->classifyRow(row, plane->getRow(row), vecUrbanCount, vecValidCount);
+
+    if (progress != 0)
+    {
+      progress->finishRow(row, firstRow, lastRow);
+    }
+  }
+}
+
+void te::urban::classifyDilatedRows(const NeighborhoodPlane& plane, unsigned int squaredRadius, std::size_t numberOfThreads, NeighborhoodRowClassifier& classifier, const std::string& taskMessage)
+{
+  //the column distances are limited to the first distance outside the circle, so they fit in 16 bits
+  unsigned int radius = (unsigned int)std::sqrt((double)squaredRadius);
+  while ((boost::uint64_t)radius * radius > squaredRadius)
+  {
+    --radius;
+  }
+  while ((boost::uint64_t)(radius + 1) * (radius + 1) <= squaredRadius)
+  {
+    ++radius;
+  }
+
+  if (radius + 1 > std::numeric_limits<unsigned short>::max())
+  {
+    throw te::common::Exception("The radius is too large to be dilated. Error in function: classifyDilatedRows");
+  }
+
+  std::vector<unsigned short> vecColumnDistances;
+  calculateColumnDistances(plane, (unsigned short)(radius + 1), vecColumnDistances);
+
+  std::size_t numRows = plane.m_numRows;
+
+  std::size_t numberOfBands = std::min(getNumberOfThreads(numberOfThreads), std::max(numRows, (std::size_t)1));
+  std::size_t bandSize = (numRows + numberOfBands - 1) / numberOfBands;
+
+  //one step for each strip of the bands, pulsed by the threads as they finish them
+  std::size_t numberOfStrips = 0;
+  for (std::size_t i = 0; i < numberOfBands; ++i)
+  {
+    std::size_t firstRow = std::min(i * bandSize, numRows);
+    std::size_t lastRow = std::min(firstRow + bandSize, numRows);
+
+    numberOfStrips += RowProgress::getNumberOfStrips(firstRow, lastRow);
+  }
+
+  te::common::TaskProgress task(taskMessage);
+  task.setTotalSteps((int)numberOfStrips);
+  task.useTimer(true);
+
+  RowProgress progress(&task);
+
+  std::vector<boost::thread*> vecThreads;
+  for (std::size_t i = 0; i < numberOfBands; ++i)
+  {
+    std::size_t firstRow = std::min(i * bandSize, numRows);
+    std::size_t lastRow = std::min(firstRow + bandSize, numRows);
+
+    vecThreads.push_back(new boost::thread(&classifyDilatedRowBand, &plane, &vecColumnDistances, squaredRadius, &classifier, firstRow, lastRow, &progress));
+  }
+
+  for (std::size_t i = 0; i < vecThreads.size(); ++i)
+  {
+    vecThreads[i]->join();
+  }
+
+  te::common::FreeContents(vecThreads);
+}
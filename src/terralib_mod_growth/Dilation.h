@@ -0,0 +1,72 @@
+/*  Copyright (C) 2011-2012 National Institute For Space Research (INPE) - Brazil.
+
+This file is part of the TerraLib - a Framework for building GIS enabled applications.
+
+TerraLib is free software: you can redistribute it and/or modify
+it under the terms of the GNU Lesser General Public License as published by
+the Free Software Foundation, either version 3 of the License,
+or (at your option) any later version.
+
+TerraLib is distributed in the hope that it will be useful,
+but WITHOUT ANY WARRANTY; without even the implied warranty of
+MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE. See the
+GNU Lesser General Public License for more details.
+
+You should have received a copy of the GNU Lesser General Public License
+along with TerraLib. See COPYING. If not, write to
+TerraLib Team at <terralib-team@terralib.org>.
+*/
+
+/*!
+\file urban_analysis/src/growth/Dilation.h
+
+\brief This file contains the dilation of the urban pixels of a neighborhood plane by a circular mask, calculated with an exact euclidean distance transform
+*/
+
+#ifndef __URBANANALYSIS_INTERNAL_GROWTH_DILATION_H
+#define __URBANANALYSIS_INTERNAL_GROWTH_DILATION_H
+
+#include "Config.h"
+
+#include "Neighborhood.h"
+
+#include <boost/numeric/ublas/matrix.hpp>
+
+#include <string>
+#include <vector>
+
+namespace te
+{
+  namespace urban
+  {
+    /*!
+      \brief Gets the squared radius, in pixels, of the given mask.
+
+      The mask can only be replaced by a distance threshold if it contains exactly the offsets whose squared distance to the center is lower or equal than
+      some value. Returns false if it does not.
+    */
+    TEGROWTHEXPORT bool getMaskSquaredRadius(const boost::numeric::ublas::matrix<bool>& mask, unsigned int& squaredRadius);
+
+    //!< Calculates, for each pixel, the vertical distance in pixels to the nearest urban pixel of its column. The distances are limited to maxDistance
+    TEGROWTHEXPORT void calculateColumnDistances(const NeighborhoodPlane& plane, unsigned short maxDistance, std::vector<unsigned short>& vecColumnDistances);
+
+    //!< Calculates, for the given row, the squared euclidean distance of each pixel to the nearest urban pixel, from the column distances of all the rows
+    TEGROWTHEXPORT void calculateRowSquaredDistances(const std::vector<unsigned short>& vecColumnDistances, std::size_t numColumns, std::size_t row,
+                                                     std::vector<boost::uint64_t>& vecSquaredDistances, std::vector<int>& vecWorkspace);
+
+    //!< Classifies the rows [firstRow, lastRow) from the column distances. It is the body of each thread of classifyDilatedRows. If given, the progress is told about each classified row
+    TEGROWTHEXPORT void classifyDilatedRowBand(const NeighborhoodPlane* plane, const std::vector<unsigned short>* vecColumnDistances, unsigned int squaredRadius,
+                                               NeighborhoodRowClassifier* classifier, std::size_t firstRow, std::size_t lastRow, RowProgress* progress = 0);
+
+    /*!
+      \brief Dilates the urban pixels of the plane by a circle of the given squared radius and gives the result of each row to the row classifier.
+
+      The urban count given to the classifier is 1 when there is at least one urban pixel within the circle and 0 otherwise. The valid count is not calculated.
+      The cost does not depend on the radius, as the distance transform visits each pixel a fixed number of times. The plane is never changed, so the result
+      does not depend on the processing order.
+    */
+    TEGROWTHEXPORT void classifyDilatedRows(const NeighborhoodPlane& plane, unsigned int squaredRadius, std::size_t numberOfThreads, NeighborhoodRowClassifier& classifier, const std::string& taskMessage);
+  }
+}
+
+#endif //__URBANANALYSIS_INTERNAL_GROWTH_DILATION_H
@@ -0,0 +1,217 @@
+/*  Copyright (C) 2011-2012 National Institute For Space Research (INPE) - Brazil.
+
+This file is part of the TerraLib - a Framework for building GIS enabled applications.
+
+TerraLib is free software: you can redistribute it and/or modify
+it under the terms of the GNU Lesser General Public License as published by
+the Free Software Foundation, either version 3 of the License,
+or (at your option) any later version.
+
+TerraLib is distributed in the hope that it will be useful,
+but WITHOUT ANY WARRANTY; without even the implied warranty of
+MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE. See the
+GNU Lesser General Public License for more details.
+
+You should have received a copy of the GNU Lesser General Public License
+along with TerraLib. See COPYING. If not, write to
+TerraLib Team at <terralib-team@terralib.org>.
+*/
+
+/*!
+\file urban_analysis/src/growth/FourierTransform.cpp
+
+\brief This file contains a radix-2 fast fourier transform of two dimensional blocks, used to convolve the neighborhood planes with large masks
+*/
+
+#include "FourierTransform.h"
+
+#include <terralib/common/Exception.h>
+
+#include <algorithm>
+#include <cmath>
+
+std::size_t te::urban::getNextPowerOfTwo(std::size_t value)
+{
+  std::size_t power = 1;
+  while (power < value)
+  {
+    power *= 2;
+  }
+  return power;
+}
+
+te::urban::FourierTransform2D::FourierTransform2D(std::size_t numRows, std::size_t numColumns)
+  : m_numRows(numRows)
+  , m_numColumns(numColumns)
+{
+  if (numRows == 0 || numColumns == 0 || getNextPowerOfTwo(numRows) != numRows || getNextPowerOfTwo(numColumns) != numColumns)
+  {
+    throw te::common::Exception("The size of the fourier transform must be a power of two. Error in function: FourierTransform2D");
+  }
+
+  const double pi = 3.14159265358979323846;
+
+  std::size_t sizes[] = { numColumns, numRows };
+  std::vector<std::complex<double> >* vecTwiddles[] = { &m_vecRowTwiddles, &m_vecColumnTwiddles };
+  std::vector<std::size_t>* vecReversals[] = { &m_vecRowReversal, &m_vecColumnReversal };
+
+  for (int i = 0; i < 2; ++i)
+  {
+    std::size_t size = sizes[i];
+
+    vecTwiddles[i]->resize(std::max(size / 2, (std::size_t)1));
+    for (std::size_t k = 0; k < size / 2; ++k)
+    {
+      double angle = -2. * pi * (double)k / (double)size;
+      (*vecTwiddles[i])[k] = std::complex<double>(std::cos(angle), std::sin(angle));
+    }
+
+    std::size_t numBits = 0;
+    while (((std::size_t)1 << numBits) < size)
+    {
+      ++numBits;
+    }
+
+    vecReversals[i]->resize(size);
+    for (std::size_t k = 0; k < size; ++k)
+    {
+      std::size_t reversed = 0;
+      for (std::size_t bit = 0; bit < numBits; ++bit)
+      {
+        if (k & ((std::size_t)1 << bit))
+        {
+          reversed |= (std::size_t)1 << (numBits - 1 - bit);
+        }
+      }
+      (*vecReversals[i])[k] = reversed;
+    }
+  }
+}
+
+te::urban::FourierTransform2D::~FourierTransform2D()
+{
+}
+
+void te::urban::FourierTransform2D::transform(std::vector<std::complex<double> >& vecBlock, bool inverse) const
+{
+  if (vecBlock.size() != m_numRows * m_numColumns)
+  {
+    throw te::common::Exception("The block does not have the size of the fourier transform. Error in function: FourierTransform2D::transform");
+  }
+
+  std::complex<double>* block = &vecBlock[0];
+
+  transformRows(block, inverse);
+  transformColumns(block, inverse);
+
+  if (inverse)
+  {
+    double scale = 1. / (double)vecBlock.size();
+    for (std::size_t i = 0; i < vecBlock.size(); ++i)
+    {
+      block[i] *= scale;
+    }
+  }
+}
+
+std::size_t te::urban::FourierTransform2D::getNumberOfRows() const
+{
+  return m_numRows;
+}
+
+std::size_t te::urban::FourierTransform2D::getNumberOfColumns() const
+{
+  return m_numColumns;
+}
+
+void te::urban::FourierTransform2D::transformRows(std::complex<double>* block, bool inverse) const
+{
+  std::size_t size = m_numColumns;
+
+  for (std::size_t row = 0; row < m_numRows; ++row)
+  {
+    std::complex<double>* data = block + row * size;
+
+    for (std::size_t k = 0; k < size; ++k)
+    {
+      std::size_t reversed = m_vecRowReversal[k];
+      if (k < reversed)
+      {
+        std::swap(data[k], data[reversed]);
+      }
+    }
+
+    for (std::size_t length = 2; length <= size; length *= 2)
+    {
+      std::size_t half = length / 2;
+      std::size_t twiddleStep = size / length;
+
+      for (std::size_t start = 0; start < size; start += length)
+      {
+        for (std::size_t k = 0; k < half; ++k)
+        {
+          std::complex<double> twiddle = m_vecRowTwiddles[k * twiddleStep];
+          if (inverse)
+          {
+            twiddle = std::conj(twiddle);
+          }
+
+          //the product is written explicitly, as std::complex checks the infinite results of each multiplication
+          std::complex<double> even = data[start + k];
+          std::complex<double> value = data[start + k + half];
+          std::complex<double> odd(value.real() * twiddle.real() - value.imag() * twiddle.imag(), value.real() * twiddle.imag() + value.imag() * twiddle.real());
+
+          data[start + k] = even + odd;
+          data[start + k + half] = even - odd;
+        }
+      }
+    }
+  }
+}
+
+void te::urban::FourierTransform2D::transformColumns(std::complex<double>* block, bool inverse) const
+{
+  std::size_t size = m_numRows;
+  std::size_t numColumns = m_numColumns;
+
+  //all the columns are transformed together, by swapping and combining entire rows
+  for (std::size_t k = 0; k < size; ++k)
+  {
+    std::size_t reversed = m_vecColumnReversal[k];
+    if (k < reversed)
+    {
+      std::swap_ranges(block + k * numColumns, block + (k + 1) * numColumns, block + reversed * numColumns);
+    }
+  }
+
+  for (std::size_t length = 2; length <= size; length *= 2)
+  {
+    std::size_t half = length / 2;
+    std::size_t twiddleStep = size / length;
+
+    for (std::size_t start = 0; start < size; start += length)
+    {
+      for (std::size_t k = 0; k < half; ++k)
+      {
+        std::complex<double> twiddle = m_vecColumnTwiddles[k * twiddleStep];
+        if (inverse)
+        {
+          twiddle = std::conj(twiddle);
+        }
+
+        std::complex<double>* evenRow = block + (start + k) * numColumns;
+        std::complex<double>* oddRow = block + (start + k + half) * numColumns;
+
+        for (std::size_t column = 0; column < numColumns; ++column)
+        {
+          std::complex<double> even = evenRow[column];
+          std::complex<double> value = oddRow[column];
+          std::complex<double> odd(value.real() * twiddle.real() - value.imag() * twiddle.imag(), value.real() * twiddle.imag() + value.imag() * twiddle.real());
+
+          evenRow[column] = even + odd;
+          oddRow[column] = even - odd;
+        }
+      }
+    }
+  }
+}
@@ -0,0 +1,81 @@
+/*  Copyright (C) 2011-2012 National Institute For Space Research (INPE) - Brazil.
+
+This file is part of the TerraLib - a Framework for building GIS enabled applications.
+
+TerraLib is free software: you can redistribute it and/or modify
+it under the terms of the GNU Lesser General Public License as published by
+the Free Software Foundation, either version 3 of the License,
+or (at your option) any later version.
+
+TerraLib is distributed in the hope that it will be useful,
+but WITHOUT ANY WARRANTY; without even the implied warranty of
+MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE. See the
+GNU Lesser General Public License for more details.
+
+You should have received a copy of the GNU Lesser General Public License
+along with TerraLib. See COPYING. If not, write to
+TerraLib Team at <terralib-team@terralib.org>.
+*/
+
+/*!
+\file urban_analysis/src/growth/FourierTransform.h
+
+\brief This file contains a radix-2 fast fourier transform of two dimensional blocks, used to convolve the neighborhood planes with large masks
+*/
+
+#ifndef __URBANANALYSIS_INTERNAL_GROWTH_FOURIERTRANSFORM_H
+#define __URBANANALYSIS_INTERNAL_GROWTH_FOURIERTRANSFORM_H
+
+#include "Config.h"
+
+#include <complex>
+#include <cstddef>
+#include <vector>
+
+namespace te
+{
+  namespace urban
+  {
+    //!< Returns the smallest power of two that is greater or equal than the given value
+    TEGROWTHEXPORT std::size_t getNextPowerOfTwo(std::size_t value);
+
+    /*!
+      \brief Calculates the discrete fourier transform of row-major blocks with a fixed number of rows and columns, both powers of two.
+
+      The twiddle factors are calculated directly, not by recurrence, to keep the rounding errors small. The columns are transformed by butterflies
+      between entire rows, so the block is always accessed in sequence. The transform can be shared between threads.
+    */
+    class TEGROWTHEXPORT FourierTransform2D
+    {
+      public:
+
+        FourierTransform2D(std::size_t numRows, std::size_t numColumns);
+
+        ~FourierTransform2D();
+
+        //!< Transforms the block in place. The inverse transform is divided by the number of elements, so it restores the original block
+        void transform(std::vector<std::complex<double> >& vecBlock, bool inverse) const;
+
+        std::size_t getNumberOfRows() const;
+
+        std::size_t getNumberOfColumns() const;
+
+      protected:
+
+        //!< Transforms each row of the block
+        void transformRows(std::complex<double>* block, bool inverse) const;
+
+        //!< Transforms each column of the block
+        void transformColumns(std::complex<double>* block, bool inverse) const;
+
+        std::size_t m_numRows;
+        std::size_t m_numColumns;
+        std::vector<std::complex<double> > m_vecRowTwiddles;     //!< exp(-2 pi i k / numColumns), used to transform the rows
+        std::vector<std::complex<double> > m_vecColumnTwiddles;  //!< exp(-2 pi i k / numRows), used to transform the columns
+        std::vector<std::size_t> m_vecRowReversal;               //!< the bit reversed position of each element of a row
+        std::vector<std::size_t> m_vecColumnReversal;            //!< the bit reversed position of each element of a column
+    };
+  }
+}
+
+#endif //__URBANANALYSIS_INTERNAL_GROWTH_FOURIERTRANSFORM_H
@@ -0,0 +1,145 @@
+/*  Copyright (C) 2011-2012 National Institute For Space Research (INPE) - Brazil.
+
+This file is part of the TerraLib - a Framework for building GIS enabled applications.
+
+TerraLib is free software: you can redistribute it and/or modify
+it under the terms of the GNU Lesser General Public License as published by
+the Free Software Foundation, either version 3 of the License,
+or (at your option) any later version.
+
+TerraLib is distributed in the hope that it will be useful,
+but WITHOUT ANY WARRANTY; without even the implied warranty of
+MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE. See the
+GNU Lesser General Public License for more details.
+
+You should have received a copy of the GNU Lesser General Public License
+along with TerraLib. See COPYING. If not, write to
+TerraLib Team at <terralib-team@terralib.org>.
+*/
+
+
+/*!
+\file urban_analysis/src/growth/GridTransformer.cpp
+
+\brief This file contains the transformation of the pixels of a grid into the pixels of another grid, row by row
+*/
+
+#include "GridTransformer.h"
+
+//Terralib
+#include <terralib/common/Exception.h>
+#include <terralib/raster/Grid.h>
+#include <terralib/srs/Converter.h>
+
+#include <cassert>
+#include <cmath>
+
+te::urban::GridTransformer::GridTransformer(const te::rst::Grid* targetGrid, const te::rst::Grid* sourceGrid, double maxError)
+  : m_targetGrid(targetGrid)
+  , m_sourceGrid(sourceGrid)
+  , m_maxError(maxError)
+  , m_numExactTransformations(0)
+{
+  assert(targetGrid);
+  assert(sourceGrid);
+
+  if (targetGrid->getSRID() != sourceGrid->getSRID())
+  {
+    m_converter.reset(new te::srs::Converter());
+    m_converter->setSourceSRID(targetGrid->getSRID());
+    m_converter->setTargetSRID(sourceGrid->getSRID());
+  }
+}
+
+te::urban::GridTransformer::~GridTransformer()
+{
+}
+
+void te::urban::GridTransformer::transformRow(std::size_t row, std::size_t firstColumn, std::size_t numColumns, double* sourceColumns, double* sourceRows)
+{
+  if (numColumns == 0)
+  {
+    return;
+  }
+
+  //with the same SRID the transformation is affine, so it is always transformed exactly
+  if (m_maxError <= 0. || m_converter.get() == 0 || numColumns <= TEGROWTH_TRANSFORM_MINIMUM_SPAN)
+  {
+    transformExact(row, firstColumn, numColumns, sourceColumns, sourceRows);
+    return;
+  }
+
+  transformExact(row, firstColumn, 1, sourceColumns, sourceRows);
+  transformExact(row, firstColumn + numColumns - 1, 1, sourceColumns + numColumns - 1, sourceRows + numColumns - 1);
+
+  transformSpan(row, firstColumn, numColumns, sourceColumns, sourceRows);
+}
+
+void te::urban::GridTransformer::transformExact(std::size_t row, std::size_t firstColumn, std::size_t numColumns, double* sourceColumns, double* sourceRows)
+{
+  m_vecX.resize(numColumns);
+  m_vecY.resize(numColumns);
+
+  for (std::size_t i = 0; i < numColumns; ++i)
+  {
+    m_targetGrid->gridToGeo((double)(firstColumn + i), (double)row, m_vecX[i], m_vecY[i]);
+  }
+
+  //all the coordinates of the row are converted in a single call
+  if (m_converter.get() != 0)
+  {
+    if (m_converter->convert(&m_vecX[0], &m_vecY[0], (long)numColumns, 1) == false)
+    {
+      throw te::common::Exception("Could not convert the coordinates between the spatial reference systems. Error in function: GridTransformer::transformExact");
+    }
+  }
+
+  for (std::size_t i = 0; i < numColumns; ++i)
+  {
+    m_sourceGrid->geoToGrid(m_vecX[i], m_vecY[i], sourceColumns[i], sourceRows[i]);
+  }
+
+  m_numExactTransformations += numColumns;
+}
+
+void te::urban::GridTransformer::transformSpan(std::size_t row, std::size_t firstColumn, std::size_t numColumns, double* sourceColumns, double* sourceRows)
+{
+  if (numColumns <= 2)
+  {
+    return;
+  }
+
+  std::size_t last = numColumns - 1;
+
+  //the short spans are transformed exactly, as checking them would cost as much as transforming them
+  if (numColumns <= TEGROWTH_TRANSFORM_MINIMUM_SPAN)
+  {
+    transformExact(row, firstColumn + 1, numColumns - 2, sourceColumns + 1, sourceRows + 1);
+    return;
+  }
+
+  std::size_t middle = last / 2;
+  transformExact(row, firstColumn + middle, 1, sourceColumns + middle, sourceRows + middle);
+
+  double columnStep = (sourceColumns[last] - sourceColumns[0]) / (double)last;
+  double rowStep = (sourceRows[last] - sourceRows[0]) / (double)last;
+
+  double columnError = std::fabs(sourceColumns[0] + columnStep * (double)middle - sourceColumns[middle]);
+  double rowError = std::fabs(sourceRows[0] + rowStep * (double)middle - sourceRows[middle]);
+
+  if (columnError > m_maxError || rowError > m_maxError)
+  {
+    transformSpan(row, firstColumn, middle + 1, sourceColumns, sourceRows);
+    transformSpan(row, firstColumn + middle, numColumns - middle, sourceColumns + middle, sourceRows + middle);
+    return;
+  }
+
+  for (std::size_t i = 1; i < last; ++i)
+  {
+    if (i != middle)
+    {
+      sourceColumns[i] = sourceColumns[0] + columnStep * (double)i;
+      sourceRows[i] = sourceRows[0] + rowStep * (double)i;
+    }
+  }
+}
@@ -0,0 +1,92 @@
+/*  Copyright (C) 2011-2012 National Institute For Space Research (INPE) - Brazil.
+
+This file is part of the TerraLib - a Framework for building GIS enabled applications.
+
+TerraLib is free software: you can redistribute it and/or modify
+it under the terms of the GNU Lesser General Public License as published by
+the Free Software Foundation, either version 3 of the License,
+or (at your option) any later version.
+
+TerraLib is distributed in the hope that it will be useful,
+but WITHOUT ANY WARRANTY; without even the implied warranty of
+MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE. See the
+GNU Lesser General Public License for more details.
+
+You should have received a copy of the GNU Lesser General Public License
+along with TerraLib. See COPYING. If not, write to
+TerraLib Team at <terralib-team@terralib.org>.
+*/
+
+
+/*!
+\file urban_analysis/src/growth/GridTransformer.h
+
+\brief This file contains the transformation of the pixels of a grid into the pixels of another grid, row by row
+*/
+
+#ifndef __URBANANALYSIS_INTERNAL_GROWTH_GRIDTRANSFORMER_H
+#define __URBANANALYSIS_INTERNAL_GROWTH_GRIDTRANSFORMER_H
+
+#include "Config.h"
+
+#include <cstddef>
+#include <memory>
+#include <vector>
+
+namespace te
+{
+  namespace rst
+  {
+    class Grid;
+  }
+
+  namespace srs
+  {
+    class Converter;
+  }
+
+  namespace urban
+  {
+    /*!
+      \brief Transforms the centers of the pixels of a target grid into the fractional column and row of the same locations in a source grid.
+
+      The pixels are transformed a row at a time, so the coordinates of the row are converted between the spatial reference systems in a single call.
+      When the maximum error is greater than 0, the transformer is approximate, like the approximate transformer of GDAL: a span of the row is only
+      transformed exactly at its ends and middle, and if the linear interpolation of the ends is within the maximum error, in source pixels, at the middle,
+      the rest of the span is interpolated. Otherwise the span is divided in two and each half is checked again.
+    */
+    class TEGROWTHEXPORT GridTransformer
+    {
+      public:
+
+        //!< The maximum error is given in pixels of the source grid. If it is 0, all the pixels are transformed exactly
+        GridTransformer(const te::rst::Grid* targetGrid, const te::rst::Grid* sourceGrid, double maxError = 0.);
+
+        ~GridTransformer();
+
+        //!< Transforms the pixels [firstColumn, firstColumn + numColumns) of the given row of the target grid into columns and rows of the source grid
+        void transformRow(std::size_t row, std::size_t firstColumn, std::size_t numColumns, double* sourceColumns, double* sourceRows);
+
+        //!< Returns the number of pixels that were transformed exactly, to measure the gain of the approximation
+        std::size_t getNumberOfExactTransformations() const { return m_numExactTransformations; }
+
+      protected:
+
+        //!< Transforms exactly the given columns of the row
+        void transformExact(std::size_t row, std::size_t firstColumn, std::size_t numColumns, double* sourceColumns, double* sourceRows);
+
+        //!< Transforms the given columns of the row, whose first and last pixels are already transformed, by interpolation when the error allows it
+        void transformSpan(std::size_t row, std::size_t firstColumn, std::size_t numColumns, double* sourceColumns, double* sourceRows);
+
+        const te::rst::Grid* m_targetGrid;
+        const te::rst::Grid* m_sourceGrid;
+        double m_maxError;
+        std::auto_ptr<te::srs::Converter> m_converter; //!< null if the grids have the same SRID
+        std::vector<double> m_vecX;
+        std::vector<double> m_vecY;
+        std::size_t m_numExactTransformations;
+    };
+  }
+}
+
+#endif //__URBANANALYSIS_INTERNAL_GROWTH_GRIDTRANSFORMER_H
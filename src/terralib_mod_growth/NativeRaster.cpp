@@ -0,0 +1,545 @@
+/*  Copyright (C) 2011-2012 National Institute For Space Research (INPE) - Brazil.
+
+This file is part of the TerraLib - a Framework for building GIS enabled applications.
+
+TerraLib is free software: you can redistribute it and/or modify
+it under the terms of the GNU Lesser General Public License as published by
+the Free Software Foundation, either version 3 of the License,
+or (at your option) any later version.
+
+TerraLib is distributed in the hope that it will be useful,
+but WITHOUT ANY WARRANTY; without even the implied warranty of
+MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE. See the
+GNU Lesser General Public License for more details.
+
+You should have received a copy of the GNU Lesser General Public License
+along with TerraLib. See COPYING. If not, write to
+TerraLib Team at <terralib-team@terralib.org>.
+*/
+
+
+/*!
+\file urban_analysis/src/growth/NativeRaster.cpp
+
+\brief This file contains the native raster format of the intermediate rasters, which can be memory-mapped without any copy
+*/
+
+#include "NativeRaster.h"
+#include "PixelPlane.h"
+#include "Utils.h"
+
+//Terralib
+#include <terralib/common/Exception.h>
+#include <terralib/geometry/Envelope.h>
+#include <terralib/raster/Band.h>
+#include <terralib/raster/BandProperty.h>
+#include <terralib/raster/Grid.h>
+#include <terralib/raster/Raster.h>
+#include <terralib/raster/RasterFactory.h>
+
+//Boost
+#include <boost/algorithm/string.hpp>
+#include <boost/filesystem.hpp>
+#include <boost/lexical_cast.hpp>
+#include <boost/thread.hpp>
+
+#ifdef TEGROWTH_LZ4
+  #include <lz4.h>
+#endif
+
+#include <algorithm>
+#include <cstring>
+#include <fstream>
+
+namespace te
+{
+  namespace urban
+  {
+    //!< The first bytes of every native raster file
+    const char NATIVE_RASTER_MAGIC[8] = { 'U', 'A', 'G', 'R', 'O', 'W', 'T', 'H' };
+
+    const boost::uint32_t NATIVE_RASTER_VERSION = 1;
+
+    template<class T> void appendHeaderValue(std::vector<unsigned char>& vecHeader, T value)
+    {
+      const unsigned char* bytes = (const unsigned char*)&value;
+      vecHeader.insert(vecHeader.end(), bytes, bytes + sizeof(T));
+    }
+
+    //!< Reads a value of the header and moves the position after it. Throws an exception if the header ends before the value
+    template<class T> T readHeaderValue(const unsigned char* data, std::size_t size, std::size_t& position)
+    {
+      if (position + sizeof(T) > size)
+      {
+        throw te::common::Exception("The header of the native raster is truncated. Error in function: readNativeRasterHeader");
+      }
+
+      T value;
+      std::memcpy(&value, data + position, sizeof(T));
+      position += sizeof(T);
+      return value;
+    }
+
+    void writeNativeRasterHeader(const NativeRasterHeader& header, std::vector<unsigned char>& vecHeader)
+    {
+      vecHeader.assign(NATIVE_RASTER_MAGIC, NATIVE_RASTER_MAGIC + sizeof(NATIVE_RASTER_MAGIC));
+
+      appendHeaderValue(vecHeader, NATIVE_RASTER_VERSION);
+      appendHeaderValue(vecHeader, (boost::uint32_t)header.m_vecDataTypes.size());
+      appendHeaderValue(vecHeader, (boost::uint32_t)header.m_numRows);
+      appendHeaderValue(vecHeader, (boost::uint32_t)header.m_numColumns);
+      appendHeaderValue(vecHeader, (boost::int32_t)header.m_srid);
+      appendHeaderValue(vecHeader, header.m_llx);
+      appendHeaderValue(vecHeader, header.m_lly);
+      appendHeaderValue(vecHeader, header.m_urx);
+      appendHeaderValue(vecHeader, header.m_ury);
+      appendHeaderValue(vecHeader, (boost::uint32_t)header.m_compression);
+      appendHeaderValue(vecHeader, (boost::uint32_t)header.m_chunkRows);
+      appendHeaderValue(vecHeader, header.m_dataOffset);
+
+      for (std::size_t band = 0; band < header.m_vecDataTypes.size(); ++band)
+      {
+        appendHeaderValue(vecHeader, (boost::int32_t)header.m_vecDataTypes[band]);
+        appendHeaderValue(vecHeader, header.m_vecNoDataValues[band]);
+      }
+
+      for (std::size_t chunk = 0; chunk < header.m_vecChunks.size(); ++chunk)
+      {
+        appendHeaderValue(vecHeader, header.m_vecChunks[chunk].m_offset);
+        appendHeaderValue(vecHeader, header.m_vecChunks[chunk].m_size);
+      }
+    }
+
+    //!< Creates the grid and the band properties of a raster with the size, extent and bands of the header. The bands have a single block, as the bands of a memory raster
+    te::rst::Grid* createNativeRasterGrid(const NativeRasterHeader& header, std::vector<te::rst::BandProperty*>& vecBandProperties)
+    {
+      te::gm::Envelope* extent = new te::gm::Envelope(header.m_llx, header.m_lly, header.m_urx, header.m_ury);
+      te::rst::Grid* grid = new te::rst::Grid((unsigned int)header.m_numColumns, (unsigned int)header.m_numRows, extent, header.m_srid);
+
+      for (std::size_t band = 0; band < header.m_vecDataTypes.size(); ++band)
+      {
+        te::rst::BandProperty* bandProperty = new te::rst::BandProperty(band, header.m_vecDataTypes[band]);
+        bandProperty->m_noDataValue = header.m_vecNoDataValues[band];
+        bandProperty->m_blkw = (int)header.m_numColumns;
+        bandProperty->m_blkh = (int)header.m_numRows;
+        bandProperty->m_nblocksx = 1;
+        bandProperty->m_nblocksy = 1;
+
+        vecBandProperties.push_back(bandProperty);
+      }
+
+      return grid;
+    }
+
+    //!< Reads the given rows of a band into the buffer in the data type of the band, as they are stored in the native raster files
+    template<class T> void readNativeRasterRows(te::rst::Raster* raster, std::size_t band, std::size_t firstRow, std::size_t numRows, std::vector<unsigned char>& vecRows)
+    {
+      PixelPlane<T> plane;
+      plane.read(raster, band, firstRow, numRows);
+
+      vecRows.resize(plane.getNumberOfRows() * plane.getNumberOfColumns() * sizeof(T));
+      std::memcpy(&vecRows[0], plane.getRow(0), vecRows.size());
+    }
+
+    void readNativeRasterRows(te::rst::Raster* raster, std::size_t band, std::size_t firstRow, std::size_t numRows, std::vector<unsigned char>& vecRows)
+    {
+      switch (raster->getBand(band)->getProperty()->getType())
+      {
+        case te::dt::CHAR_TYPE: readNativeRasterRows<char>(raster, band, firstRow, numRows, vecRows); break;
+        case te::dt::UCHAR_TYPE: readNativeRasterRows<unsigned char>(raster, band, firstRow, numRows, vecRows); break;
+        case te::dt::INT16_TYPE: readNativeRasterRows<short>(raster, band, firstRow, numRows, vecRows); break;
+        case te::dt::UINT16_TYPE: readNativeRasterRows<unsigned short>(raster, band, firstRow, numRows, vecRows); break;
+        case te::dt::INT32_TYPE: readNativeRasterRows<int>(raster, band, firstRow, numRows, vecRows); break;
+        case te::dt::UINT32_TYPE: readNativeRasterRows<unsigned int>(raster, band, firstRow, numRows, vecRows); break;
+        case te::dt::FLOAT_TYPE: readNativeRasterRows<float>(raster, band, firstRow, numRows, vecRows); break;
+        case te::dt::DOUBLE_TYPE: readNativeRasterRows<double>(raster, band, firstRow, numRows, vecRows); break;
+      }
+    }
+
+    void deleteNativeRasterBuffer(void* buffer)
+    {
+      delete[] (unsigned char*)buffer;
+    }
+
+    //!< Decompresses the chunks [firstChunk, lastChunk) of a native raster into the planes of the given buffer
+    void decompressNativeRasterChunks(const NativeRasterHeader& header, const unsigned char* fileData, unsigned char* buffer,
+                                      std::size_t firstChunk, std::size_t lastChunk, std::string& errorMessage)
+    {
+      std::size_t numChunksPerBand = header.getNumberOfChunksPerBand();
+
+      for (std::size_t chunk = firstChunk; chunk < lastChunk; ++chunk)
+      {
+        std::size_t band = chunk / numChunksPerBand;
+        std::size_t chunkFirstRow = (chunk % numChunksPerBand) * header.m_chunkRows;
+        std::size_t chunkNumRows = std::min(header.m_chunkRows, header.m_numRows - chunkFirstRow);
+
+        std::size_t rowSize = header.m_numColumns * getPixelPlaneDataTypeSize(header.m_vecDataTypes[band]);
+        std::size_t planeOffset = 0;
+        for (std::size_t previousBand = 0; previousBand < band; ++previousBand)
+        {
+          planeOffset += header.getPlaneSize(previousBand);
+        }
+
+        unsigned char* target = buffer + planeOffset + chunkFirstRow * rowSize;
+        std::size_t targetSize = chunkNumRows * rowSize;
+
+        const NativeRasterChunk& nativeChunk = header.m_vecChunks[chunk];
+        const unsigned char* source = fileData + nativeChunk.m_offset;
+
+#ifdef TEGROWTH_LZ4
+        int decompressedSize = LZ4_decompress_safe((const char*)source, (char*)target, (int)nativeChunk.m_size, (int)targetSize);
+        if (decompressedSize != (int)targetSize)
+        {
+          errorMessage = "Could not decompress the chunk " + boost::lexical_cast<std::string>(chunk) + " of the native raster.";
+          return;
+        }
+#else
+        errorMessage = "The module was built without the LZ4 library.";
+        return;
+#endif
+      }
+    }
+  }
+}
+
+te::urban::NativeRasterHeader::NativeRasterHeader()
+  : m_numRows(0)
+  , m_numColumns(0)
+  , m_srid(0)
+  , m_llx(0.)
+  , m_lly(0.)
+  , m_urx(0.)
+  , m_ury(0.)
+  , m_compression(NATIVE_RASTER_COMPRESSION_NONE)
+  , m_chunkRows(TEGROWTH_NATIVE_RASTER_CHUNK_ROWS)
+  , m_dataOffset(0)
+{
+}
+
+std::size_t te::urban::NativeRasterHeader::getNumberOfChunksPerBand() const
+{
+  return (m_numRows + m_chunkRows - 1) / m_chunkRows;
+}
+
+std::size_t te::urban::NativeRasterHeader::getPlaneSize(std::size_t band) const
+{
+  return m_numRows * m_numColumns * getPixelPlaneDataTypeSize(m_vecDataTypes[band]);
+}
+
+te::urban::MappedFileHolder::MappedFileHolder(const std::string& fileName)
+{
+  try
+  {
+    m_file = boost::interprocess::file_mapping(fileName.c_str(), boost::interprocess::read_only);
+    m_region = boost::interprocess::mapped_region(m_file, boost::interprocess::copy_on_write);
+  }
+  catch (const std::exception& e)
+  {
+    throw te::common::Exception("Could not map the file " + fileName + ": " + e.what() + " Error in function: MappedFileHolder");
+  }
+}
+
+te::urban::MappedFileHolder::~MappedFileHolder()
+{
+}
+
+te::urban::MappedRaster::MappedRaster(const std::string& fileName)
+  : MappedFileHolder(fileName)
+  , te::mem::Raster()
+{
+  unsigned char* fileData = (unsigned char*)m_region.get_address();
+
+  NativeRasterHeader header;
+  readNativeRasterHeader(fileData, m_region.get_size(), header);
+
+  if (header.m_compression != NATIVE_RASTER_COMPRESSION_NONE)
+  {
+    throw te::common::Exception("The compressed native raster " + fileName + " cannot be mapped. Error in function: MappedRaster");
+  }
+
+  std::vector<te::rst::BandProperty*> vecBandProperties;
+  te::rst::Grid* grid = createNativeRasterGrid(header, vecBandProperties);
+
+  //the planes are used as the data buffer of the bands, and are never released by the memory raster
+  std::map<std::string, std::string> rasterInfo;
+  rasterInfo["MEM_IS_DATA_BUFFER"] = "TRUE";
+
+  create(grid, vecBandProperties, rasterInfo, fileData + header.m_dataOffset, 0);
+}
+
+te::urban::MappedRaster::~MappedRaster()
+{
+}
+
+bool te::urban::isNativeRasterFile(const std::string& fileName)
+{
+  std::string extension = boost::filesystem::path(fileName).extension().string();
+
+  return boost::iequals(extension, TEGROWTH_NATIVE_RASTER_EXTENSION);
+}
+
+bool te::urban::isNativeRasterCompressionSupported(NativeRasterCompression compression)
+{
+#ifdef TEGROWTH_LZ4
+  return true;
+#else
+  return compression == NATIVE_RASTER_COMPRESSION_NONE;
+#endif
+}
+
+void te::urban::readNativeRasterHeader(const unsigned char* data, std::size_t size, NativeRasterHeader& header)
+{
+  if (size < sizeof(NATIVE_RASTER_MAGIC) || std::memcmp(data, NATIVE_RASTER_MAGIC, sizeof(NATIVE_RASTER_MAGIC)) != 0)
+  {
+    throw te::common::Exception("The file is not a native raster. Error in function: readNativeRasterHeader");
+  }
+
+  std::size_t position = sizeof(NATIVE_RASTER_MAGIC);
+
+  boost::uint32_t version = readHeaderValue<boost::uint32_t>(data, size, position);
+  if (version != NATIVE_RASTER_VERSION)
+  {
+    throw te::common::Exception("The version of the native raster is not supported. Error in function: readNativeRasterHeader");
+  }
+
+  std::size_t numBands = readHeaderValue<boost::uint32_t>(data, size, position);
+  header.m_numRows = readHeaderValue<boost::uint32_t>(data, size, position);
+  header.m_numColumns = readHeaderValue<boost::uint32_t>(data, size, position);
+  header.m_srid = readHeaderValue<boost::int32_t>(data, size, position);
+  header.m_llx = readHeaderValue<double>(data, size, position);
+  header.m_lly = readHeaderValue<double>(data, size, position);
+  header.m_urx = readHeaderValue<double>(data, size, position);
+  header.m_ury = readHeaderValue<double>(data, size, position);
+  header.m_compression = (NativeRasterCompression)readHeaderValue<boost::uint32_t>(data, size, position);
+  header.m_chunkRows = readHeaderValue<boost::uint32_t>(data, size, position);
+  header.m_dataOffset = readHeaderValue<boost::uint64_t>(data, size, position);
+
+  if (numBands == 0 || header.m_chunkRows == 0)
+  {
+    throw te::common::Exception("The native raster has no bands or no rows per chunk. Error in function: readNativeRasterHeader");
+  }
+
+  if (isNativeRasterCompressionSupported(header.m_compression) == false)
+  {
+    throw te::common::Exception("The compression of the native raster is not supported. Error in function: readNativeRasterHeader");
+  }
+
+  header.m_vecDataTypes.resize(numBands);
+  header.m_vecNoDataValues.resize(numBands);
+  for (std::size_t band = 0; band < numBands; ++band)
+  {
+    header.m_vecDataTypes[band] = readHeaderValue<boost::int32_t>(data, size, position);
+    header.m_vecNoDataValues[band] = readHeaderValue<double>(data, size, position);
+
+    if (getPixelPlaneDataTypeSize(header.m_vecDataTypes[band]) == 0)
+    {
+      throw te::common::Exception("The data type of the native raster is not supported. Error in function: readNativeRasterHeader");
+    }
+  }
+
+  std::size_t numChunksPerBand = header.getNumberOfChunksPerBand();
+  header.m_vecChunks.resize(numBands * numChunksPerBand);
+  for (std::size_t chunk = 0; chunk < header.m_vecChunks.size(); ++chunk)
+  {
+    header.m_vecChunks[chunk].m_offset = readHeaderValue<boost::uint64_t>(data, size, position);
+    header.m_vecChunks[chunk].m_size = readHeaderValue<boost::uint64_t>(data, size, position);
+
+    //the header is only valid if all the chunks are inside the given memory
+    if (header.m_vecChunks[chunk].m_offset + header.m_vecChunks[chunk].m_size > size)
+    {
+      throw te::common::Exception("The native raster is truncated. Error in function: readNativeRasterHeader");
+    }
+  }
+
+  //an uncompressed file is mapped, so its planes must be contiguous
+  if (header.m_compression == NATIVE_RASTER_COMPRESSION_NONE)
+  {
+    boost::uint64_t dataSize = 0;
+    for (std::size_t band = 0; band < numBands; ++band)
+    {
+      dataSize += header.getPlaneSize(band);
+    }
+
+    if (header.m_dataOffset + dataSize > size)
+    {
+      throw te::common::Exception("The native raster is truncated. Error in function: readNativeRasterHeader");
+    }
+  }
+}
+
+void te::urban::saveNativeRaster(const std::string& fileName, te::rst::Raster* raster, NativeRasterCompression compression, std::size_t chunkRows)
+{
+  assert(raster);
+
+  if (isNativeRasterCompressionSupported(compression) == false)
+  {
+    throw te::common::Exception("The module was built without the LZ4 library. Error in function: saveNativeRaster");
+  }
+
+  NativeRasterHeader header;
+  header.m_numRows = raster->getNumberOfRows();
+  header.m_numColumns = raster->getNumberOfColumns();
+  header.m_srid = raster->getSRID();
+  header.m_llx = raster->getExtent()->m_llx;
+  header.m_lly = raster->getExtent()->m_lly;
+  header.m_urx = raster->getExtent()->m_urx;
+  header.m_ury = raster->getExtent()->m_ury;
+  header.m_compression = compression;
+  header.m_chunkRows = std::max(chunkRows, (std::size_t)1);
+
+  std::size_t numBands = raster->getNumberOfBands();
+  for (std::size_t band = 0; band < numBands; ++band)
+  {
+    const te::rst::BandProperty* bandProperty = raster->getBand(band)->getProperty();
+    if (getPixelPlaneDataTypeSize(bandProperty->getType()) == 0)
+    {
+      throw te::common::Exception("The data type of the raster is not supported by the native format. Error in function: saveNativeRaster");
+    }
+
+    header.m_vecDataTypes.push_back(bandProperty->getType());
+    header.m_vecNoDataValues.push_back(bandProperty->m_noDataValue);
+  }
+
+  std::size_t numChunksPerBand = header.getNumberOfChunksPerBand();
+  header.m_vecChunks.resize(numBands * numChunksPerBand);
+
+  //the size of the header does not depend on the positions of the chunks, so the position of the planes is known before they are written
+  std::vector<unsigned char> vecHeader;
+  writeNativeRasterHeader(header, vecHeader);
+  header.m_dataOffset = ((vecHeader.size() + TEGROWTH_NATIVE_RASTER_ALIGNMENT - 1) / TEGROWTH_NATIVE_RASTER_ALIGNMENT) * TEGROWTH_NATIVE_RASTER_ALIGNMENT;
+
+  std::ofstream file(fileName.c_str(), std::ios::out | std::ios::binary | std::ios::trunc);
+  if (file.is_open() == false)
+  {
+    throw te::common::Exception("Could not create the file " + fileName + ". Error in function: saveNativeRaster");
+  }
+
+  std::vector<char> vecPadding((std::size_t)header.m_dataOffset, 0);
+  file.write(&vecPadding[0], (std::streamsize)vecPadding.size());
+
+  boost::uint64_t offset = header.m_dataOffset;
+
+  std::vector<unsigned char> vecChunk;
+  std::vector<unsigned char> vecCompressedChunk;
+  for (std::size_t band = 0; band < numBands; ++band)
+  {
+    int dataType = header.m_vecDataTypes[band];
+    std::size_t rowSize = header.m_numColumns * getPixelPlaneDataTypeSize(dataType);
+
+    //the planes held in memory are written directly from the memory, and the others are read in their data type, chunk by chunk
+    const unsigned char* bandMemory = getBandMemory(raster, band);
+
+    for (std::size_t chunk = 0; chunk < numChunksPerBand; ++chunk)
+    {
+      std::size_t chunkFirstRow = chunk * header.m_chunkRows;
+      std::size_t chunkNumRows = std::min(header.m_chunkRows, header.m_numRows - chunkFirstRow);
+
+      const unsigned char* chunkData = 0;
+      std::size_t chunkSize = chunkNumRows * rowSize;
+
+      if (bandMemory != 0)
+      {
+        chunkData = bandMemory + chunkFirstRow * rowSize;
+      }
+      else
+      {
+        readNativeRasterRows(raster, band, chunkFirstRow, chunkNumRows, vecChunk);
+        chunkData = &vecChunk[0];
+      }
+
+#ifdef TEGROWTH_LZ4
+      if (compression == NATIVE_RASTER_COMPRESSION_LZ4)
+      {
+        vecCompressedChunk.resize(LZ4_compressBound((int)chunkSize));
+        chunkSize = LZ4_compress_default((const char*)chunkData, (char*)&vecCompressedChunk[0], (int)chunkSize, (int)vecCompressedChunk.size());
+        if (chunkSize == 0)
+        {
+          throw te::common::Exception("Could not compress the raster. Error in function: saveNativeRaster");
+        }
+        chunkData = &vecCompressedChunk[0];
+      }
+#endif
+
+      file.write((const char*)chunkData, (std::streamsize)chunkSize);
+
+      NativeRasterChunk& nativeChunk = header.m_vecChunks[band * numChunksPerBand + chunk];
+      nativeChunk.m_offset = offset;
+      nativeChunk.m_size = chunkSize;
+
+      offset += chunkSize;
+    }
+  }
+
+  //now the header has the positions of the chunks
+  writeNativeRasterHeader(header, vecHeader);
+  file.seekp(0);
+  file.write((const char*)&vecHeader[0], (std::streamsize)vecHeader.size());
+
+  file.close();
+  if (file.fail())
+  {
+    throw te::common::Exception("Could not write the file " + fileName + ". Error in function: saveNativeRaster");
+  }
+}
+
+std::auto_ptr<te::rst::Raster> te::urban::openNativeRaster(const std::string& fileName)
+{
+  std::auto_ptr<MappedFileHolder> mappedFile(new MappedFileHolder(fileName));
+
+  const unsigned char* fileData = (const unsigned char*)mappedFile->m_region.get_address();
+
+  NativeRasterHeader header;
+  readNativeRasterHeader(fileData, mappedFile->m_region.get_size(), header);
+
+  if (header.m_compression == NATIVE_RASTER_COMPRESSION_NONE)
+  {
+    mappedFile.reset();
+
+    std::auto_ptr<te::rst::Raster> mappedRaster(new MappedRaster(fileName));
+    return mappedRaster;
+  }
+
+  std::size_t bufferSize = 0;
+  for (std::size_t band = 0; band < header.m_vecDataTypes.size(); ++band)
+  {
+    bufferSize += header.getPlaneSize(band);
+  }
+
+  unsigned char* buffer = new unsigned char[bufferSize];
+
+  //the chunks are compressed independently, so they are decompressed in parallel
+  std::size_t numChunks = header.m_vecChunks.size();
+  std::size_t numThreads = std::max(std::min((std::size_t)boost::thread::hardware_concurrency(), numChunks), (std::size_t)1);
+  std::size_t chunksPerThread = (numChunks + numThreads - 1) / numThreads;
+
+  std::vector<std::string> vecErrorMessages(numThreads);
+
+  boost::thread_group threadGroup;
+  for (std::size_t i = 0; i < numThreads; ++i)
+  {
+    std::size_t firstChunk = std::min(i * chunksPerThread, numChunks);
+    std::size_t lastChunk = std::min(firstChunk + chunksPerThread, numChunks);
+
+    threadGroup.create_thread(boost::bind(&decompressNativeRasterChunks, boost::cref(header), fileData, buffer, firstChunk, lastChunk, boost::ref(vecErrorMessages[i])));
+  }
+  threadGroup.join_all();
+
+  for (std::size_t i = 0; i < numThreads; ++i)
+  {
+    if (vecErrorMessages[i].empty() == false)
+    {
+      delete[] buffer;
+      throw te::common::Exception(vecErrorMessages[i] + " File: " + fileName + ". Error in function: openNativeRaster");
+    }
+  }
+
+  std::vector<te::rst::BandProperty*> vecBandProperties;
+  te::rst::Grid* grid = createNativeRasterGrid(header, vecBandProperties);
+
+  //the memory raster takes the ownership of the decompressed planes
+  std::map<std::string, std::string> rasterInfo;
+  rasterInfo["MEM_IS_DATA_BUFFER"] = "TRUE";
+
+  std::auto_ptr<te::rst::Raster> raster(te::rst::RasterFactory::make("MEM", grid, vecBandProperties, rasterInfo, buffer, &deleteNativeRasterBuffer));
+  return raster;
+}
@@ -0,0 +1,141 @@
+/*  Copyright (C) 2011-2012 National Institute For Space Research (INPE) - Brazil.
+
+This file is part of the TerraLib - a Framework for building GIS enabled applications.
+
+TerraLib is free software: you can redistribute it and/or modify
+it under the terms of the GNU Lesser General Public License as published by
+the Free Software Foundation, either version 3 of the License,
+or (at your option) any later version.
+
+TerraLib is distributed in the hope that it will be useful,
+but WITHOUT ANY WARRANTY; without even the implied warranty of
+MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE. See the
+GNU Lesser General Public License for more details.
+
+You should have received a copy of the GNU Lesser General Public License
+along with TerraLib. See COPYING. If not, write to
+TerraLib Team at <terralib-team@terralib.org>.
+*/
+
+
+/*!
+\file urban_analysis/src/growth/NativeRaster.h
+
+\brief This file contains the native raster format of the intermediate rasters, which can be memory-mapped without any copy
+*/
+
+#ifndef __URBANANALYSIS_INTERNAL_GROWTH_NATIVERASTER_H
+#define __URBANANALYSIS_INTERNAL_GROWTH_NATIVERASTER_H
+
+#include "Config.h"
+
+//Terralib
+#include <terralib/memory/Raster.h>
+
+//Boost
+#include <boost/cstdint.hpp>
+#include <boost/interprocess/file_mapping.hpp>
+#include <boost/interprocess/mapped_region.hpp>
+
+#include <cstddef>
+#include <memory>
+#include <string>
+#include <vector>
+
+namespace te
+{
+  namespace rst
+  {
+    class Raster;
+  }
+
+  namespace urban
+  {
+    enum NativeRasterCompression
+    {
+      NATIVE_RASTER_COMPRESSION_NONE, //!< the planes are stored as they are in memory, so the file can be memory-mapped
+      NATIVE_RASTER_COMPRESSION_LZ4   //!< each chunk is compressed with LZ4. Only available when the module is built with TEGROWTH_LZ4
+    };
+
+    struct NativeRasterChunk
+    {
+      boost::uint64_t m_offset; //!< the position of the chunk in the file
+      boost::uint64_t m_size;   //!< the number of bytes of the chunk in the file
+    };
+
+    /*!
+      \brief The header of a native raster file.
+
+      The file starts with the header, in the native byte order, followed by the planes of the bands. The planes start at a position aligned to
+      TEGROWTH_NATIVE_RASTER_ALIGNMENT and, when the file is not compressed, are stored one after the other, row by row, exactly as a memory raster
+      stores them. Each plane is divided in chunks of rows, which are compressed independently.
+    */
+    struct TEGROWTHEXPORT NativeRasterHeader
+    {
+      NativeRasterHeader();
+
+      std::size_t m_numRows;
+      std::size_t m_numColumns;
+      int m_srid;
+      double m_llx; //!< the extent of the raster
+      double m_lly;
+      double m_urx;
+      double m_ury;
+      NativeRasterCompression m_compression;
+      std::size_t m_chunkRows;                     //!< the number of rows of each chunk
+      boost::uint64_t m_dataOffset;                //!< the position of the first plane in the file
+      std::vector<int> m_vecDataTypes;             //!< the data type of each band
+      std::vector<double> m_vecNoDataValues;       //!< the no data value of each band
+      std::vector<NativeRasterChunk> m_vecChunks;  //!< the chunks of all the bands, band by band
+
+      std::size_t getNumberOfChunksPerBand() const;
+
+      //!< Returns the number of bytes of the given band when it is not compressed
+      std::size_t getPlaneSize(std::size_t band) const;
+    };
+
+    //!< Keeps the memory mapping of a MappedRaster. As it is the first base, the file is mapped before the raster is created and unmapped after it is destroyed
+    struct TEGROWTHEXPORT MappedFileHolder
+    {
+      explicit MappedFileHolder(const std::string& fileName);
+
+      ~MappedFileHolder();
+
+      boost::interprocess::file_mapping m_file;
+      boost::interprocess::mapped_region m_region;
+    };
+
+    /*!
+      \brief A memory raster whose pixels are the planes of an uncompressed native raster file, mapped into memory without any copy.
+
+      The pages of the file are only read when they are accessed, and are shared by all the processes that map the same file. The mapping is copy on
+      write: the raster can be changed, but the changes are never written into the file. Its bands are a single block, so the PixelPlanes read and write
+      their rows in place in the mapping, and only the pages of these rows are touched.
+    */
+    class TEGROWTHEXPORT MappedRaster : protected MappedFileHolder, public te::mem::Raster
+    {
+      public:
+
+        explicit MappedRaster(const std::string& fileName);
+
+        ~MappedRaster();
+    };
+
+    //!< Returns true if the given file name has the extension of the native raster files
+    TEGROWTHEXPORT bool isNativeRasterFile(const std::string& fileName);
+
+    //!< Returns true if the module can read and write the given compression
+    TEGROWTHEXPORT bool isNativeRasterCompressionSupported(NativeRasterCompression compression);
+
+    //!< Reads the header of a native raster from the given memory. Throws an exception if it is not a valid header
+    TEGROWTHEXPORT void readNativeRasterHeader(const unsigned char* data, std::size_t size, NativeRasterHeader& header);
+
+    //!< Saves the raster in the native format
+    TEGROWTHEXPORT void saveNativeRaster(const std::string& fileName, te::rst::Raster* raster, NativeRasterCompression compression = NATIVE_RASTER_COMPRESSION_NONE, std::size_t chunkRows = TEGROWTH_NATIVE_RASTER_CHUNK_ROWS);
+
+    //!< Opens a native raster. An uncompressed file is memory-mapped, and the chunks of a compressed one are decompressed in parallel into memory
+    TEGROWTHEXPORT std::auto_ptr<te::rst::Raster> openNativeRaster(const std::string& fileName);
+  }
+}
+
+#endif //__URBANANALYSIS_INTERNAL_GROWTH_NATIVERASTER_H
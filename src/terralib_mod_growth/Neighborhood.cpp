@@ -0,0 +1,1229 @@
+/*  Copyright (C) 2011-2012 National Institute For Space Research (INPE) - Brazil.
+
+This file is part of the TerraLib - a Framework for building GIS enabled applications.
+
+TerraLib is free software: you can redistribute it and/or modify
+it under the terms of the GNU Lesser General Public License as published by
+the Free Software Foundation, either version 3 of the License,
+or (at your option) any later version.
+
+TerraLib is distributed in the hope that it will be useful,
+but WITHOUT ANY WARRANTY; without even the implied warranty of
+MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE. See the
+GNU Lesser General Public License for more details.
+
+You should have received a copy of the GNU Lesser General Public License
+along with TerraLib. See COPYING. If not, write to
+TerraLib Team at <terralib-team@terralib.org>.
+*/
+
+/*!
+\file urban_analysis/src/growth/Neighborhood.cpp
+
+\brief This file contains the engine used to count the urban and valid pixels within a circular neighborhood
+*/
+
+#include "Neighborhood.h"
+#include "PixelPlane.h"
+#include "RasterWriter.h"
+
+//Terralib
+#include <terralib/common/Exception.h>
+#include <terralib/common/STLUtils.h>
+#include <terralib/common/progress/TaskProgress.h>
+#include <terralib/raster/Raster.h>
+
+#include <boost/thread.hpp>
+
+#include <algorithm>
+#include <cmath>
+#include <cstdlib>
+#include <limits>
+
+te::urban::NeighborhoodCounter::NeighborhoodCounter(const NeighborhoodPlane& plane, const std::vector<MaskSpan>& vecSpans, SpanInstructionSet instructionSet)
+  : m_plane(plane)
+  , m_vecSpans(vecSpans)
+  , m_maskRadius(0)
+  , m_spanKernels(getSpanKernels(instructionSet))
+{
+  for (std::size_t i = 0; i < m_vecSpans.size(); ++i)
+  {
+    m_maskRadius = std::max(m_maskRadius, std::abs(m_vecSpans[i].m_rowOffset));
+  }
+}
+
+te::urban::NeighborhoodCounter::~NeighborhoodCounter()
+{
+}
+
+const te::urban::NeighborhoodPlane& te::urban::NeighborhoodCounter::getPlane() const
+{
+  return m_plane;
+}
+
+te::urban::SpanInstructionSet te::urban::NeighborhoodCounter::getInstructionSet() const
+{
+  return m_spanKernels.m_instructionSet;
+}
+
+void te::urban::NeighborhoodCounter::removeCenterPixels(std::size_t row, std::vector<unsigned int>& vecUrbanCount, std::vector<unsigned int>& vecValidCount) const
+{
+  //the center pixel is always inside the mask, but it must not be considered
+  const unsigned char* flags = m_plane.getRow(row);
+  for (std::size_t column = 0; column < m_plane.m_numColumns; ++column)
+  {
+    vecUrbanCount[column] -= (flags[column] & NEIGHBORHOOD_URBAN) ? 1 : 0;
+    vecValidCount[column] -= (flags[column] & NEIGHBORHOOD_VALID) ? 1 : 0;
+  }
+}
+
+te::urban::PrefixSumNeighborhoodCounter::PrefixSumNeighborhoodCounter(const NeighborhoodPlane& plane, const std::vector<MaskSpan>& vecSpans, SpanInstructionSet instructionSet)
+  : NeighborhoodCounter(plane, vecSpans, instructionSet)
+{
+  //the cache must hold all the rows covered by the mask
+  std::size_t cacheSize = (2 * m_maskRadius) + 1;
+
+  m_vecCachedRows.resize(cacheSize, std::numeric_limits<std::size_t>::max());
+  m_vecUrbanPrefix.resize(cacheSize);
+  m_vecValidPrefix.resize(cacheSize);
+}
+
+te::urban::PrefixSumNeighborhoodCounter::~PrefixSumNeighborhoodCounter()
+{
+}
+
+std::size_t te::urban::PrefixSumNeighborhoodCounter::getPrefixRow(std::size_t row)
+{
+  std::size_t slot = row % m_vecCachedRows.size();
+  if (m_vecCachedRows[slot] == row)
+  {
+    return slot;
+  }
+
+  std::size_t numColumns = m_plane.m_numColumns;
+
+  std::vector<unsigned int>& vecUrbanPrefix = m_vecUrbanPrefix[slot];
+  std::vector<unsigned int>& vecValidPrefix = m_vecValidPrefix[slot];
+  vecUrbanPrefix.resize(numColumns + 1);
+  vecValidPrefix.resize(numColumns + 1);
+
+  const unsigned char* flags = m_plane.getRow(row);
+
+  unsigned int urbanSum = 0;
+  unsigned int validSum = 0;
+  vecUrbanPrefix[0] = 0;
+  vecValidPrefix[0] = 0;
+  for (std::size_t column = 0; column < numColumns; ++column)
+  {
+    urbanSum += (flags[column] & NEIGHBORHOOD_URBAN) ? 1 : 0;
+    validSum += (flags[column] & NEIGHBORHOOD_VALID) ? 1 : 0;
+
+    vecUrbanPrefix[column + 1] = urbanSum;
+    vecValidPrefix[column + 1] = validSum;
+  }
+
+  m_vecCachedRows[slot] = row;
+
+  return slot;
+}
+
+void te::urban::PrefixSumNeighborhoodCounter::countRow(std::size_t row, std::vector<unsigned int>& vecUrbanCount, std::vector<unsigned int>& vecValidCount)
+{
+  vecUrbanCount.assign(m_plane.m_numColumns, 0);
+  vecValidCount.assign(m_plane.m_numColumns, 0);
+
+  accumulateSpans(row, m_vecSpans, vecUrbanCount, vecValidCount);
+
+  removeCenterPixels(row, vecUrbanCount, vecValidCount);
+}
+
+void te::urban::PrefixSumNeighborhoodCounter::accumulateSpans(std::size_t row, const std::vector<MaskSpan>& vecSpans, std::vector<unsigned int>& vecUrbanCount, std::vector<unsigned int>& vecValidCount)
+{
+  int numRows = (int)m_plane.m_numRows;
+  int numColumns = (int)m_plane.m_numColumns;
+
+  for (std::size_t s = 0; s < vecSpans.size(); ++s)
+  {
+    const MaskSpan& span = vecSpans[s];
+
+    int rasterRow = (int)row + span.m_rowOffset;
+    if (rasterRow < 0 || rasterRow >= numRows)
+    {
+      continue;
+    }
+
+    std::size_t slot = getPrefixRow((std::size_t)rasterRow);
+    const unsigned int* urbanPrefix = &m_vecUrbanPrefix[slot][0];
+    const unsigned int* validPrefix = &m_vecValidPrefix[slot][0];
+
+    //the windows of the columns in [interiorFirst, interiorLast) are inside the raster, so they are accumulated by the span kernel
+    int interiorFirst = std::min(std::max(-span.m_columnStart, 0), numColumns);
+    int interiorLast = std::max(std::min(numColumns - span.m_columnEnd, numColumns), interiorFirst);
+
+    if (interiorFirst < interiorLast)
+    {
+      m_spanKernels.m_accumulateWindows(urbanPrefix + interiorFirst + span.m_columnEnd + 1, urbanPrefix + interiorFirst + span.m_columnStart,
+                                        validPrefix + interiorFirst + span.m_columnEnd + 1, validPrefix + interiorFirst + span.m_columnStart,
+                                        (std::size_t)(interiorLast - interiorFirst), &vecUrbanCount[interiorFirst], &vecValidCount[interiorFirst]);
+    }
+
+    //each span is a window [column + start, column + end] clipped to the raster. The count of the window is given by the difference between two prefix sums
+    for (int column = 0; column < numColumns; ++column)
+    {
+      if (column == interiorFirst)
+      {
+        column = interiorLast;
+        if (column >= numColumns)
+        {
+          break;
+        }
+      }
+
+      int first = std::max(column + span.m_columnStart, 0);
+      int last = std::min(column + span.m_columnEnd, numColumns - 1);
+      if (first > last)
+      {
+        continue;
+      }
+
+      vecUrbanCount[column] += urbanPrefix[last + 1] - urbanPrefix[first];
+      vecValidCount[column] += validPrefix[last + 1] - validPrefix[first];
+    }
+  }
+}
+
+te::urban::MultiRadiusNeighborhoodCounter::MultiRadiusNeighborhoodCounter(const NeighborhoodPlane& plane, const std::vector<std::vector<MaskSpan> >& vecRadiusSpans, SpanInstructionSet instructionSet)
+  : PrefixSumNeighborhoodCounter(plane, vecRadiusSpans.empty() ? std::vector<MaskSpan>() : vecRadiusSpans.back(), instructionSet)
+  , m_vecRadiusSpans(vecRadiusSpans)
+{
+}
+
+te::urban::MultiRadiusNeighborhoodCounter::~MultiRadiusNeighborhoodCounter()
+{
+}
+
+void te::urban::MultiRadiusNeighborhoodCounter::countRowForAllRadii(std::size_t row, std::vector<std::vector<unsigned int> >& vecUrbanCounts, std::vector<std::vector<unsigned int> >& vecValidCounts)
+{
+  vecUrbanCounts.resize(m_vecRadiusSpans.size());
+  vecValidCounts.resize(m_vecRadiusSpans.size());
+
+  //the prefix sums of the rows covered by the largest mask are calculated once and reused by all the masks
+  for (std::size_t r = 0; r < m_vecRadiusSpans.size(); ++r)
+  {
+    vecUrbanCounts[r].assign(m_plane.m_numColumns, 0);
+    vecValidCounts[r].assign(m_plane.m_numColumns, 0);
+
+    accumulateSpans(row, m_vecRadiusSpans[r], vecUrbanCounts[r], vecValidCounts[r]);
+
+    removeCenterPixels(row, vecUrbanCounts[r], vecValidCounts[r]);
+  }
+}
+
+
+te::urban::SlidingWindowNeighborhoodCounter::SlidingWindowNeighborhoodCounter(const NeighborhoodPlane& plane, const std::vector<MaskSpan>& vecSpans, SpanInstructionSet instructionSet)
+  : NeighborhoodCounter(plane, vecSpans, instructionSet)
+{
+}
+
+te::urban::SlidingWindowNeighborhoodCounter::~SlidingWindowNeighborhoodCounter()
+{
+}
+
+void te::urban::SlidingWindowNeighborhoodCounter::countRow(std::size_t row, std::vector<unsigned int>& vecUrbanCount, std::vector<unsigned int>& vecValidCount)
+{
+  int numRows = (int)m_plane.m_numRows;
+  int numColumns = (int)m_plane.m_numColumns;
+
+  vecUrbanCount.assign(numColumns, 0);
+  vecValidCount.assign(numColumns, 0);
+
+  if (numColumns == 0)
+  {
+    return;
+  }
+
+  for (std::size_t s = 0; s < m_vecSpans.size(); ++s)
+  {
+    const MaskSpan& span = m_vecSpans[s];
+
+    int rasterRow = (int)row + span.m_rowOffset;
+    if (rasterRow < 0 || rasterRow >= numRows)
+    {
+      continue;
+    }
+
+    const unsigned char* flags = m_plane.getRow((std::size_t)rasterRow);
+
+    //the window of the first column is counted entirely
+    unsigned int urbanSum = 0;
+    unsigned int validSum = 0;
+
+    int first = std::max(span.m_columnStart, 0);
+    int last = std::min(span.m_columnEnd, numColumns - 1);
+    if (first <= last)
+    {
+      m_spanKernels.m_countFlags(flags + first, (std::size_t)(last - first + 1), urbanSum, validSum);
+    }
+
+    vecUrbanCount[0] += urbanSum;
+    vecValidCount[0] += validSum;
+
+    //then the window slides one column at a time
+    for (int column = 1; column < numColumns; ++column)
+    {
+      int leaving = column - 1 + span.m_columnStart;
+      if (leaving >= 0 && leaving < numColumns)
+      {
+        urbanSum -= (flags[leaving] & NEIGHBORHOOD_URBAN) ? 1 : 0;
+        validSum -= (flags[leaving] & NEIGHBORHOOD_VALID) ? 1 : 0;
+      }
+
+      int entering = column + span.m_columnEnd;
+      if (entering >= 0 && entering < numColumns)
+      {
+        urbanSum += (flags[entering] & NEIGHBORHOOD_URBAN) ? 1 : 0;
+        validSum += (flags[entering] & NEIGHBORHOOD_VALID) ? 1 : 0;
+      }
+
+      vecUrbanCount[column] += urbanSum;
+      vecValidCount[column] += validSum;
+    }
+  }
+
+  removeCenterPixels(row, vecUrbanCount, vecValidCount);
+}
+
+te::urban::PopcountNeighborhoodCounter::PopcountNeighborhoodCounter(const NeighborhoodPlane& plane, const std::vector<MaskSpan>& vecSpans, SpanInstructionSet instructionSet)
+  : NeighborhoodCounter(plane, vecSpans, instructionSet)
+{
+  if (!plane.isPacked() && plane.m_numRows * plane.m_numColumns != 0)
+  {
+    throw te::common::Exception("The neighborhood plane must be packed to be used by the popcount kernel. Error in function: PopcountNeighborhoodCounter");
+  }
+}
+
+te::urban::PopcountNeighborhoodCounter::~PopcountNeighborhoodCounter()
+{
+}
+
+void te::urban::PopcountNeighborhoodCounter::countRow(std::size_t row, std::vector<unsigned int>& vecUrbanCount, std::vector<unsigned int>& vecValidCount)
+{
+  int numRows = (int)m_plane.m_numRows;
+  int numColumns = (int)m_plane.m_numColumns;
+
+  vecUrbanCount.assign(numColumns, 0);
+  vecValidCount.assign(numColumns, 0);
+
+  if (numColumns == 0)
+  {
+    return;
+  }
+
+  for (std::size_t s = 0; s < m_vecSpans.size(); ++s)
+  {
+    const MaskSpan& span = m_vecSpans[s];
+
+    int rasterRow = (int)row + span.m_rowOffset;
+    if (rasterRow < 0 || rasterRow >= numRows)
+    {
+      continue;
+    }
+
+    m_spanKernels.m_accumulateBitWindows(m_plane.getUrbanBitRow((std::size_t)rasterRow), m_plane.getValidBitRow((std::size_t)rasterRow), numColumns,
+                                         span.m_columnStart, span.m_columnEnd, &vecUrbanCount[0], &vecValidCount[0]);
+  }
+
+  removeCenterPixels(row, vecUrbanCount, vecValidCount);
+}
+
+te::urban::FFTNeighborhoodCounter::FFTNeighborhoodCounter(const NeighborhoodPlane& plane, const std::vector<MaskSpan>& vecSpans, SpanInstructionSet instructionSet)
+  : NeighborhoodCounter(plane, vecSpans, instructionSet)
+  , m_tileRows(0)
+  , m_tileColumns(0)
+  , m_stripFirstRow(0)
+  , m_stripNumRows(0)
+{
+  std::size_t border = 2 * (std::size_t)m_maskRadius;
+
+  //the tiles are at least as large as the mask, so most of each transformed block is inside the tile. They are not larger than the plane
+  std::size_t minimumBlockSize = std::max(2 * (border + 1), (std::size_t)64);
+  std::size_t blockRows = std::min(getNextPowerOfTwo(minimumBlockSize), getNextPowerOfTwo(std::max(plane.m_numRows, (std::size_t)1) + border));
+  std::size_t blockColumns = std::min(getNextPowerOfTwo(minimumBlockSize), getNextPowerOfTwo(std::max(plane.m_numColumns, (std::size_t)1) + border));
+
+  m_tileRows = blockRows - border;
+  m_tileColumns = blockColumns - border;
+
+  std::shared_ptr<FourierTransform2D> transform(new FourierTransform2D(blockRows, blockColumns));
+
+  //the count is a correlation with the mask, so each offset of the mask is placed in the mirrored position of the block
+  std::shared_ptr<std::vector<std::complex<double> > > maskSpectrum(new std::vector<std::complex<double> >(blockRows * blockColumns, std::complex<double>(0., 0.)));
+  for (std::size_t s = 0; s < m_vecSpans.size(); ++s)
+  {
+    const MaskSpan& span = m_vecSpans[s];
+
+    std::size_t blockRow = (blockRows - span.m_rowOffset) % blockRows;
+    for (int column = span.m_columnStart; column <= span.m_columnEnd; ++column)
+    {
+      std::size_t blockColumn = (blockColumns - column) % blockColumns;
+      (*maskSpectrum)[blockRow * blockColumns + blockColumn] = std::complex<double>(1., 0.);
+    }
+  }
+
+  transform->transform(*maskSpectrum, false);
+
+  m_transform = transform;
+  m_maskSpectrum = maskSpectrum;
+}
+
+te::urban::FFTNeighborhoodCounter::FFTNeighborhoodCounter(const FFTNeighborhoodCounter& rhs)
+  : NeighborhoodCounter(rhs)
+  , m_transform(rhs.m_transform)
+  , m_maskSpectrum(rhs.m_maskSpectrum)
+  , m_tileRows(rhs.m_tileRows)
+  , m_tileColumns(rhs.m_tileColumns)
+  , m_stripFirstRow(0)
+  , m_stripNumRows(0)
+{
+}
+
+te::urban::FFTNeighborhoodCounter::~FFTNeighborhoodCounter()
+{
+}
+
+std::size_t te::urban::FFTNeighborhoodCounter::getCounterMemorySize() const
+{
+  std::size_t blockSize = m_transform->getNumberOfRows() * m_transform->getNumberOfColumns() * sizeof(std::complex<double>);
+  std::size_t stripSize = 2 * std::min(m_tileRows, m_plane.m_numRows) * m_plane.m_numColumns * sizeof(unsigned int);
+
+  return blockSize + stripSize;
+}
+
+std::size_t te::urban::FFTNeighborhoodCounter::getSharedMemorySize() const
+{
+  return m_maskSpectrum->size() * sizeof(std::complex<double>);
+}
+
+void te::urban::FFTNeighborhoodCounter::countRow(std::size_t row, std::vector<unsigned int>& vecUrbanCount, std::vector<unsigned int>& vecValidCount)
+{
+  if (m_stripNumRows == 0 || row < m_stripFirstRow || row >= m_stripFirstRow + m_stripNumRows)
+  {
+    countStrip(row);
+  }
+
+  std::size_t numColumns = m_plane.m_numColumns;
+  std::size_t offset = (row - m_stripFirstRow) * numColumns;
+
+  vecUrbanCount.assign(m_vecUrbanStrip.begin() + offset, m_vecUrbanStrip.begin() + offset + numColumns);
+  vecValidCount.assign(m_vecValidStrip.begin() + offset, m_vecValidStrip.begin() + offset + numColumns);
+
+  removeCenterPixels(row, vecUrbanCount, vecValidCount);
+}
+
+void te::urban::FFTNeighborhoodCounter::countStrip(std::size_t firstRow)
+{
+  int numRows = (int)m_plane.m_numRows;
+  int numColumns = (int)m_plane.m_numColumns;
+  int radius = m_maskRadius;
+
+  std::size_t blockRows = m_transform->getNumberOfRows();
+  std::size_t blockColumns = m_transform->getNumberOfColumns();
+
+  m_stripFirstRow = firstRow;
+  m_stripNumRows = std::min(m_tileRows, m_plane.m_numRows - firstRow);
+
+  m_vecUrbanStrip.resize(m_stripNumRows * numColumns);
+  m_vecValidStrip.resize(m_stripNumRows * numColumns);
+
+  for (int firstColumn = 0; firstColumn < numColumns; firstColumn += (int)m_tileColumns)
+  {
+    int tileColumns = std::min((int)m_tileColumns, numColumns - firstColumn);
+
+    //the block has the tile and the pixels within the radius around it. The pixels outside the plane are not valid
+    m_vecBlock.assign(blockRows * blockColumns, std::complex<double>(0., 0.));
+    for (int blockRow = 0; blockRow < (int)m_stripNumRows + 2 * radius; ++blockRow)
+    {
+      int planeRow = (int)firstRow - radius + blockRow;
+      if (planeRow < 0 || planeRow >= numRows)
+      {
+        continue;
+      }
+
+      const unsigned char* flags = m_plane.getRow((std::size_t)planeRow);
+      std::complex<double>* block = &m_vecBlock[blockRow * blockColumns];
+
+      int firstPlaneColumn = std::max(firstColumn - radius, 0);
+      int lastPlaneColumn = std::min(firstColumn + tileColumns + radius, numColumns);
+      for (int column = firstPlaneColumn; column < lastPlaneColumn; ++column)
+      {
+        unsigned char pixelFlags = flags[column];
+        block[column - firstColumn + radius] = std::complex<double>((pixelFlags & NEIGHBORHOOD_URBAN) ? 1. : 0., (pixelFlags & NEIGHBORHOOD_VALID) ? 1. : 0.);
+      }
+    }
+
+    m_transform->transform(m_vecBlock, false);
+
+    const std::vector<std::complex<double> >& vecMaskSpectrum = *m_maskSpectrum;
+    for (std::size_t i = 0; i < m_vecBlock.size(); ++i)
+    {
+      const std::complex<double>& value = m_vecBlock[i];
+      const std::complex<double>& mask = vecMaskSpectrum[i];
+      m_vecBlock[i] = std::complex<double>(value.real() * mask.real() - value.imag() * mask.imag(), value.real() * mask.imag() + value.imag() * mask.real());
+    }
+
+    m_transform->transform(m_vecBlock, true);
+
+    //the counts of the tile are in the center of the block, away from the wrapped borders of the circular convolution
+    for (std::size_t stripRow = 0; stripRow < m_stripNumRows; ++stripRow)
+    {
+      const std::complex<double>* block = &m_vecBlock[(stripRow + radius) * blockColumns + radius];
+      unsigned int* urbanCount = &m_vecUrbanStrip[stripRow * numColumns + firstColumn];
+      unsigned int* validCount = &m_vecValidStrip[stripRow * numColumns + firstColumn];
+
+      for (int column = 0; column < tileColumns; ++column)
+      {
+        urbanCount[column] = (unsigned int)std::max(std::floor(block[column].real() + 0.5), 0.);
+        validCount[column] = (unsigned int)std::max(std::floor(block[column].imag() + 0.5), 0.);
+      }
+    }
+  }
+}
+
+std::auto_ptr<te::urban::NeighborhoodCounter> te::urban::createNeighborhoodCounter(NeighborhoodKernel kernel, const NeighborhoodPlane& plane, const std::vector<MaskSpan>& vecSpans)
+{
+  std::auto_ptr<NeighborhoodCounter> counter;
+
+  switch (kernel)
+  {
+    case KERNEL_PREFIX_SUM:
+      counter.reset(new PrefixSumNeighborhoodCounter(plane, vecSpans));
+      break;
+    case KERNEL_SLIDING_WINDOW:
+      counter.reset(new SlidingWindowNeighborhoodCounter(plane, vecSpans));
+      break;
+    case KERNEL_POPCOUNT:
+      counter.reset(new PopcountNeighborhoodCounter(plane, vecSpans));
+      break;
+    case KERNEL_FFT:
+      counter.reset(new FFTNeighborhoodCounter(plane, vecSpans));
+      break;
+    case KERNEL_AUTOMATIC:
+      counter = createNeighborhoodCounter(selectNeighborhoodKernel(kernel, vecSpans), plane, vecSpans);
+      break;
+    default:
+      throw te::common::Exception("Invalid neighborhood kernel. Error in function: createNeighborhoodCounter");
+  }
+
+  return counter;
+}
+
+te::urban::NeighborhoodKernel te::urban::selectNeighborhoodKernel(NeighborhoodKernel kernel, const std::vector<MaskSpan>& vecSpans)
+{
+  if (kernel != KERNEL_AUTOMATIC)
+  {
+    return kernel;
+  }
+
+  int maskRadius = 0;
+  for (std::size_t i = 0; i < vecSpans.size(); ++i)
+  {
+    maskRadius = std::max(maskRadius, std::abs(vecSpans[i].m_rowOffset));
+  }
+
+  //the cost of the prefix sums grows with the radius, while the cost of the FFT grows with its logarithm
+  if (maskRadius >= TEGROWTH_FFT_MINIMUM_RADIUS)
+  {
+    return KERNEL_FFT;
+  }
+  return KERNEL_PREFIX_SUM;
+}
+
+te::urban::NeighborhoodKernel te::urban::selectRingPlaneKernel(NeighborhoodKernel kernel, const std::vector<MaskSpan>& vecSpans)
+{
+  kernel = selectNeighborhoodKernel(kernel, vecSpans);
+  if (kernel == KERNEL_POPCOUNT || kernel == KERNEL_FFT)
+  {
+    return KERNEL_PREFIX_SUM;
+  }
+  return kernel;
+}
+
+std::string te::urban::getNeighborhoodKernelName(NeighborhoodKernel kernel, SpanInstructionSet instructionSet)
+{
+  switch (kernel)
+  {
+    case KERNEL_PREFIX_SUM:
+      return "prefix sum " + getSpanInstructionSetName(instructionSet);
+    case KERNEL_SLIDING_WINDOW:
+      return "sliding window";
+    case KERNEL_POPCOUNT:
+      return "popcount " + getSpanInstructionSetName(instructionSet);
+    case KERNEL_FFT:
+      return "fft";
+    case KERNEL_AUTOMATIC:
+      return "automatic";
+  }
+
+  return "unknown";
+}
+
+te::urban::NeighborhoodRowClassifier::~NeighborhoodRowClassifier()
+{
+}
+
+te::urban::UrbanIndexesStatistics::UrbanIndexesStatistics(const NeighborhoodPlane& plane, const unsigned char* studyArea)
+  : m_studyArea(studyArea)
+  , m_numColumns(plane.m_numColumns)
+  , m_numWords((plane.m_numColumns + 63) / 64)
+  , m_vecUrbanBits(plane.m_numRows * m_numWords, 0)
+  , m_vecNumUrbanPixels(plane.m_numRows, 0)
+  , m_vecSumPermUrb(plane.m_numRows, 0.)
+{
+  calculateEdgeBitmap(plane, getSupportedSpanInstructionSet(), m_numWords, m_vecEdgeBits);
+}
+
+void te::urban::UrbanIndexesStatistics::calculateUrbanIndexes(UrbanIndexes& urbanIndexes) const
+{
+  std::size_t numUrbanPixels = 0;
+  double sumPermUrb = 0.;
+  for (std::size_t row = 0; row < m_vecNumUrbanPixels.size(); ++row)
+  {
+    numUrbanPixels += m_vecNumUrbanPixels[row];
+    sumPermUrb += m_vecSumPermUrb[row];
+  }
+
+  //the considered pixels that are also edges
+  std::size_t numEdgePixels = 0;
+  if (m_vecUrbanBits.empty() == false)
+  {
+    numEdgePixels = getSpanKernels(getSupportedSpanInstructionSet()).m_countCommonBits(&m_vecUrbanBits[0], &m_vecEdgeBits[0], m_vecUrbanBits.size());
+  }
+
+  //a study area without urban pixels has no openness nor edges
+  if (numUrbanPixels == 0)
+  {
+    urbanIndexes["openness"] = 0.;
+    urbanIndexes["edgeIndex"] = 0.;
+    return;
+  }
+
+  urbanIndexes["openness"] = 1. - (sumPermUrb / numUrbanPixels);
+  urbanIndexes["edgeIndex"] = double(numEdgePixels) / numUrbanPixels;
+}
+
+te::urban::UrbanAreasRowClassifier::UrbanAreasRowClassifier(const InputClassesMap& inputClassesMap, std::size_t numColumns, unsigned char* urbanizedArea, unsigned char* urbanFootprint, float* permUrb, std::size_t firstRow)
+  : m_inputClassesMap(inputClassesMap)
+  , m_inputUrban(inputClassesMap.find(INPUT_URBAN)->second)
+  , m_inputOther(inputClassesMap.find(INPUT_OTHER)->second)
+  , m_numColumns(numColumns)
+  , m_urbanizedArea(urbanizedArea)
+  , m_urbanFootprint(urbanFootprint)
+  , m_permUrb(permUrb)
+  , m_firstRow(firstRow)
+  , m_urbanIndexesStatistics(0)
+{
+}
+
+te::urban::UrbanAreasRowClassifier::~UrbanAreasRowClassifier()
+{
+}
+
+void te::urban::UrbanAreasRowClassifier::setUrbanIndexesStatistics(UrbanIndexesStatistics* urbanIndexesStatistics)
+{
+  m_urbanIndexesStatistics = urbanIndexesStatistics;
+}
+
+void te::urban::UrbanAreasRowClassifier::classifyRow(std::size_t row, const unsigned char* flags, const std::vector<unsigned int>& vecUrbanCount, const std::vector<unsigned int>& vecValidCount)
+{
+  std::size_t offset = (row - m_firstRow) * m_numColumns;
+
+  const unsigned char* studyArea = 0;
+  boost::uint64_t* urbanBits = 0;
+  std::size_t numUrbanPixels = 0;
+  double sumPermUrb = 0.;
+  if (m_urbanIndexesStatistics != 0)
+  {
+    if (m_urbanIndexesStatistics->m_studyArea != 0)
+    {
+      studyArea = m_urbanIndexesStatistics->m_studyArea + row * m_numColumns;
+    }
+    urbanBits = &m_urbanIndexesStatistics->m_vecUrbanBits[row * m_urbanIndexesStatistics->m_numWords];
+  }
+
+  for (std::size_t column = 0; column < m_numColumns; ++column)
+  {
+    //gets the flags of the current center pixel
+    unsigned char centerFlags = flags[column];
+
+    std::size_t urbanCount = vecUrbanCount[column];
+    std::size_t validCount = vecValidCount[column];
+
+    double permUrb = -1.;
+
+    //urbanized area
+    if (m_urbanizedArea != 0 || m_permUrb != 0 || m_urbanIndexesStatistics != 0)
+    {
+      double value = OUTPUT_NO_DATA;
+      if (centerFlags & NEIGHBORHOOD_WATER)
+      {
+        value = OUTPUT_WATER;
+      }
+      else if (centerFlags & (NEIGHBORHOOD_URBAN | NEIGHBORHOOD_OTHER))
+      {
+        short centerPixel = (centerFlags & NEIGHBORHOOD_URBAN) ? m_inputUrban : m_inputOther;
+
+        value = calculateUrbanizedArea(centerPixel, m_inputClassesMap, urbanCount, validCount, permUrb);
+        if (validCount == 0)
+        {
+          permUrb = -1.;
+        }
+      }
+
+      if (m_urbanizedArea != 0)
+      {
+        m_urbanizedArea[offset + column] = (unsigned char)value;
+      }
+      if (m_permUrb != 0)
+      {
+        m_permUrb[offset + column] = (float)permUrb;
+      }
+
+      //urban indexes
+      if (m_urbanIndexesStatistics != 0 && (centerFlags & NEIGHBORHOOD_URBAN) && value != OUTPUT_NO_DATA)
+      {
+        if (studyArea == 0 || studyArea[column] != 0)
+        {
+          ++numUrbanPixels;
+          sumPermUrb += permUrb;
+          urbanBits[column >> 6] |= ((boost::uint64_t)1) << (column & 63);
+        }
+      }
+    }
+
+    //urban footprint
+    if (m_urbanFootprint != 0)
+    {
+      double value = OUTPUT_NO_DATA;
+      if (centerFlags & NEIGHBORHOOD_WATER)
+      {
+        value = OUTPUT_WATER;
+      }
+      else if (centerFlags & NEIGHBORHOOD_OTHER)
+      {
+        value = OUTPUT_URBANIZED_OS;
+      }
+      else if (centerFlags & NEIGHBORHOOD_URBAN)
+      {
+        double footprintPermUrb = 0.;
+        value = calculateUrbanFootprint(m_inputUrban, m_inputClassesMap, urbanCount, validCount, footprintPermUrb);
+      }
+
+      m_urbanFootprint[offset + column] = (unsigned char)value;
+    }
+  }
+
+  if (m_urbanIndexesStatistics != 0)
+  {
+    m_urbanIndexesStatistics->m_vecNumUrbanPixels[row] = numUrbanPixels;
+    m_urbanIndexesStatistics->m_vecSumPermUrb[row] = sumPermUrb;
+  }
+}
+
+te::urban::UrbanOpenAreaRowClassifier::UrbanOpenAreaRowClassifier(std::size_t numColumns, unsigned char* urbanFootprint, std::size_t firstRow)
+  : m_numColumns(numColumns)
+  , m_urbanFootprint(urbanFootprint)
+  , m_firstRow(firstRow)
+{
+}
+
+te::urban::UrbanOpenAreaRowClassifier::~UrbanOpenAreaRowClassifier()
+{
+}
+
+void te::urban::UrbanOpenAreaRowClassifier::classifyRow(std::size_t row, const unsigned char* flags, const std::vector<unsigned int>& vecUrbanCount, const std::vector<unsigned int>& /*vecValidCount*/)
+{
+  std::size_t offset = (row - m_firstRow) * m_numColumns;
+
+  for (std::size_t column = 0; column < m_numColumns; ++column)
+  {
+    if ((flags[column] & NEIGHBORHOOD_OTHER) == 0)
+    {
+      continue;
+    }
+
+    m_urbanFootprint[offset + column] = (unsigned char)((vecUrbanCount[column] > 0) ? OUTPUT_URBANIZED_OS : OUTPUT_RURAL_OS);
+  }
+}
+
+std::size_t te::urban::getNumberOfThreads(std::size_t requestedThreads)
+{
+  if (requestedThreads != 0)
+  {
+    return requestedThreads;
+  }
+
+  std::size_t numberOfCores = boost::thread::hardware_concurrency();
+  if (numberOfCores == 0)
+  {
+    return 1;
+  }
+  return numberOfCores;
+}
+
+te::urban::RowProgress::RowProgress(te::common::TaskProgress* task)
+  : m_task(task)
+{
+}
+
+std::size_t te::urban::RowProgress::getNumberOfStrips(std::size_t firstRow, std::size_t lastRow)
+{
+  return (lastRow - firstRow + TEGROWTH_PROGRESS_STRIP_ROWS - 1) / TEGROWTH_PROGRESS_STRIP_ROWS;
+}
+
+void te::urban::RowProgress::finishRow(std::size_t row, std::size_t firstRow, std::size_t lastRow)
+{
+  if (m_task == 0)
+  {
+    return;
+  }
+
+  if (((row - firstRow + 1) % TEGROWTH_PROGRESS_STRIP_ROWS) != 0 && (row + 1) != lastRow)
+  {
+    return;
+  }
+
+  boost::mutex::scoped_lock lock(m_mutex);
+  m_task->pulse();
+}
+
+void te::urban::classifyNeighborhoodRowBand(NeighborhoodCounter* counter, NeighborhoodRowClassifier* classifier, std::size_t firstRow, std::size_t lastRow, RowProgress* progress)
+{
+  const NeighborhoodPlane& plane = counter->getPlane();
+
+  std::vector<unsigned int> vecUrbanCount;
+  std::vector<unsigned int> vecValidCount;
+
+  for (std::size_t row = firstRow; row < lastRow; ++row)
+  {
+    counter->countRow(row, vecUrbanCount, vecValidCount);
+
+    classifier->classifyRow(row, plane.getRow(row), vecUrbanCount, vecValidCount);
+
+    if (progress != 0)
+    {
+      progress->finishRow(row, firstRow, lastRow);
+    }
+  }
+}
+
+te::urban::SpanInstructionSet te::urban::classifyNeighborhoodRows(const NeighborhoodPlane& plane, const std::vector<MaskSpan>& vecSpans, NeighborhoodKernel kernel, std::size_t numberOfThreads, NeighborhoodRowClassifier& classifier, const std::string& taskMessage)
+{
+  //one step for each strip of the bands, set by the classification of the range
+  te::common::TaskProgress task(taskMessage);
+  task.useTimer(true);
+
+  return classifyNeighborhoodRowRange(plane, vecSpans, kernel, numberOfThreads, 0, plane.m_numRows, classifier, &task);
+}
+
+te::urban::SpanInstructionSet te::urban::classifyNeighborhoodRowRange(const NeighborhoodPlane& plane, const std::vector<MaskSpan>& vecSpans, NeighborhoodKernel kernel, std::size_t numberOfThreads,
+                                                                      std::size_t firstRow, std::size_t lastRow, NeighborhoodRowClassifier& classifier, te::common::TaskProgress* task)
+{
+  std::size_t numRows = lastRow - firstRow;
+
+  std::size_t numberOfBands = std::min(getNumberOfThreads(numberOfThreads), std::max(numRows, (std::size_t)1));
+
+  //the counters are created before the threads, so any error is reported in the calling thread
+  std::vector<NeighborhoodCounter*> vecCounters;
+  vecCounters.push_back(createNeighborhoodCounter(kernel, plane, vecSpans).release());
+
+  //the FFT counters share the spectrum of the mask, but each one has a block as large as it. Fewer threads are used when the blocks do not fit in the memory budget
+  FFTNeighborhoodCounter* fftCounter = dynamic_cast<FFTNeighborhoodCounter*>(vecCounters[0]);
+  if (fftCounter != 0)
+  {
+    std::size_t memorySize = (std::size_t)TEGROWTH_FFT_MEMORY_SIZE * 1024 * 1024;
+    std::size_t sharedMemorySize = fftCounter->getSharedMemorySize();
+    std::size_t counterMemorySize = fftCounter->getCounterMemorySize();
+
+    std::size_t maximumNumberOfBands = (memorySize > sharedMemorySize) ? (memorySize - sharedMemorySize) / counterMemorySize : 0;
+    numberOfBands = std::max(std::min(numberOfBands, maximumNumberOfBands), (std::size_t)1);
+  }
+
+  for (std::size_t i = 1; i < numberOfBands; ++i)
+  {
+    if (fftCounter != 0)
+    {
+      vecCounters.push_back(new FFTNeighborhoodCounter(*fftCounter));
+    }
+    else
+    {
+      vecCounters.push_back(createNeighborhoodCounter(kernel, plane, vecSpans).release());
+    }
+  }
+
+  std::size_t bandSize = (numRows + numberOfBands - 1) / numberOfBands;
+
+  SpanInstructionSet instructionSet = vecCounters[0]->getInstructionSet();
+
+  //the threads pulse the task as they finish the strips of their bands
+  RowProgress progress(task);
+
+  std::size_t numberOfStrips = 0;
+  for (std::size_t i = 0; i < numberOfBands; ++i)
+  {
+    std::size_t bandFirstRow = std::min(firstRow + i * bandSize, lastRow);
+    std::size_t bandLastRow = std::min(bandFirstRow + bandSize, lastRow);
+
+    numberOfStrips += RowProgress::getNumberOfStrips(bandFirstRow, bandLastRow);
+  }
+
+  if (task != 0)
+  {
+    task->setTotalSteps((int)numberOfStrips);
+  }
+
+  std::vector<boost::thread*> vecThreads;
+  for (std::size_t i = 0; i < numberOfBands; ++i)
+  {
+    std::size_t bandFirstRow = std::min(firstRow + i * bandSize, lastRow);
+    std::size_t bandLastRow = std::min(bandFirstRow + bandSize, lastRow);
+
+    vecThreads.push_back(new boost::thread(&classifyNeighborhoodRowBand, vecCounters[i], &classifier, bandFirstRow, bandLastRow, &progress));
+  }
+
+  for (std::size_t i = 0; i < vecThreads.size(); ++i)
+  {
+    vecThreads[i]->join();
+  }
+
+  te::common::FreeContents(vecThreads);
+  te::common::FreeContents(vecCounters);
+
+  return instructionSet;
+}
+
+void te::urban::classifyMultiRadiusRowBand(MultiRadiusNeighborhoodCounter* counter, const std::vector<NeighborhoodRowClassifier*>* vecClassifiers, std::size_t firstRow, std::size_t lastRow, RowProgress* progress)
+{
+  const NeighborhoodPlane& plane = counter->getPlane();
+
+  std::vector<std::vector<unsigned int> > vecUrbanCounts;
+  std::vector<std::vector<unsigned int> > vecValidCounts;
+
+  for (std::size_t row = firstRow; row < lastRow; ++row)
+  {
+    counter->countRowForAllRadii(row, vecUrbanCounts, vecValidCounts);
+
+    for (std::size_t r = 0; r < vecClassifiers->size(); ++r)
+    {
+      (*vecClassifiers)[r]->classifyRow(row, plane.getRow(row), vecUrbanCounts[r], vecValidCounts[r]);
+    }
+
+    if (progress != 0)
+    {
+      progress->finishRow(row, firstRow, lastRow);
+    }
+  }
+}
+
+te::urban::SpanInstructionSet te::urban::classifyNeighborhoodRowsForRadii(const NeighborhoodPlane& plane, const std::vector<std::vector<MaskSpan> >& vecRadiusSpans, std::size_t numberOfThreads,
+                                                                          const std::vector<NeighborhoodRowClassifier*>& vecClassifiers, const std::string& taskMessage)
+{
+  if (vecRadiusSpans.size() != vecClassifiers.size())
+  {
+    throw te::common::Exception("Each radius must have its own row classifier. Error in function: classifyNeighborhoodRowsForRadii");
+  }
+
+  std::size_t numRows = plane.m_numRows;
+
+  std::size_t numberOfBands = std::min(getNumberOfThreads(numberOfThreads), std::max(numRows, (std::size_t)1));
+  std::size_t bandSize = (numRows + numberOfBands - 1) / numberOfBands;
+
+  std::vector<MultiRadiusNeighborhoodCounter*> vecCounters;
+  for (std::size_t i = 0; i < numberOfBands; ++i)
+  {
+    vecCounters.push_back(new MultiRadiusNeighborhoodCounter(plane, vecRadiusSpans));
+  }
+
+  SpanInstructionSet instructionSet = vecCounters[0]->getInstructionSet();
+
+  //one step for each strip of the bands, pulsed by the threads as they finish them
+  std::size_t numberOfStrips = 0;
+  for (std::size_t i = 0; i < numberOfBands; ++i)
+  {
+    std::size_t firstRow = std::min(i * bandSize, numRows);
+    std::size_t lastRow = std::min(firstRow + bandSize, numRows);
+
+    numberOfStrips += RowProgress::getNumberOfStrips(firstRow, lastRow);
+  }
+
+  te::common::TaskProgress task(taskMessage);
+  task.setTotalSteps((int)numberOfStrips);
+  task.useTimer(true);
+
+  RowProgress progress(&task);
+
+  std::vector<boost::thread*> vecThreads;
+  for (std::size_t i = 0; i < numberOfBands; ++i)
+  {
+    std::size_t firstRow = std::min(i * bandSize, numRows);
+    std::size_t lastRow = std::min(firstRow + bandSize, numRows);
+
+    vecThreads.push_back(new boost::thread(&classifyMultiRadiusRowBand, vecCounters[i], &vecClassifiers, firstRow, lastRow, &progress));
+  }
+
+  for (std::size_t i = 0; i < vecThreads.size(); ++i)
+  {
+    vecThreads[i]->join();
+  }
+
+  te::common::FreeContents(vecThreads);
+  te::common::FreeContents(vecCounters);
+
+  return instructionSet;
+}
+
+std::vector<te::urban::MaskSpan> te::urban::createMaskSpans(const boost::numeric::ublas::matrix<bool>& mask)
+{
+  std::vector<MaskSpan> vecSpans;
+
+  int maskRadius = (int)(mask.size1() / 2);
+
+  for (std::size_t localRow = 0; localRow < mask.size1(); ++localRow)
+  {
+    int columnStart = -1;
+    int columnEnd = -1;
+    for (std::size_t localColumn = 0; localColumn < mask.size2(); ++localColumn)
+    {
+      if (mask(localRow, localColumn) == false)
+      {
+        continue;
+      }
+
+      if (columnStart < 0)
+      {
+        columnStart = (int)localColumn;
+      }
+      columnEnd = (int)localColumn;
+    }
+
+    //the rows in the extremities of the mask may be empty
+    if (columnStart < 0)
+    {
+      continue;
+    }
+
+    vecSpans.push_back(MaskSpan((int)localRow - maskRadius, columnStart - maskRadius, columnEnd - maskRadius));
+  }
+
+  return vecSpans;
+}
+
+void te::urban::createNeighborhoodPlane(te::rst::Raster* inputRaster, const InputClassesMap& inputClassesMap, NeighborhoodPlane& plane)
+{
+  assert(inputRaster);
+
+  plane.m_numRows = inputRaster->getNumberOfRows();
+  plane.m_numColumns = inputRaster->getNumberOfColumns();
+  plane.m_numBufferRows = 0;
+  plane.m_vecFlags.assign(plane.m_numRows * plane.m_numColumns, 0);
+
+  readNeighborhoodRows(inputRaster, inputClassesMap, 0, plane.m_numRows, plane);
+}
+
+void te::urban::createNeighborhoodRingPlane(std::size_t numRows, std::size_t numColumns, std::size_t numBufferRows, NeighborhoodPlane& plane)
+{
+  plane.m_numRows = numRows;
+  plane.m_numColumns = numColumns;
+  plane.m_numBufferRows = std::max(std::min(numBufferRows, numRows), (std::size_t)1);
+  plane.m_vecFlags.assign(plane.m_numBufferRows * numColumns, 0);
+}
+
+void te::urban::readNeighborhoodRows(te::rst::Raster* inputRaster, const InputClassesMap& inputClassesMap, std::size_t firstRow, std::size_t numRows, NeighborhoodPlane& plane)
+{
+  assert(inputRaster);
+
+  const short InputWater = inputClassesMap.find(INPUT_WATER)->second;
+  const short InputUrban = inputClassesMap.find(INPUT_URBAN)->second;
+  const short InputOther = inputClassesMap.find(INPUT_OTHER)->second;
+
+  std::size_t lastRow = std::min(firstRow + numRows, plane.m_numRows);
+
+  //the input is read in strips of rows to limit the memory used by the typed copy of its pixels
+  std::size_t stripNumRows = getStripNumberOfRows(inputRaster);
+
+  PixelPlane<double> strip;
+  for (std::size_t stripFirstRow = firstRow; stripFirstRow < lastRow; stripFirstRow += stripNumRows)
+  {
+    strip.read(inputRaster, 0, stripFirstRow, std::min(stripNumRows, lastRow - stripFirstRow));
+
+    for (std::size_t stripRow = 0; stripRow < strip.getNumberOfRows(); ++stripRow)
+    {
+      const double* values = strip.getRow(stripRow);
+      unsigned char* flags = plane.getRow(stripFirstRow + stripRow);
+
+      for (std::size_t currentColumn = 0; currentColumn < plane.m_numColumns; ++currentColumn)
+      {
+        double value = values[currentColumn];
+
+        unsigned char currentFlags = 0;
+        if (value == InputWater)
+        {
+          currentFlags |= NEIGHBORHOOD_VALID | NEIGHBORHOOD_WATER;
+        }
+        if (value == InputUrban)
+        {
+          currentFlags |= NEIGHBORHOOD_VALID | NEIGHBORHOOD_URBAN;
+        }
+        if (value == InputOther)
+        {
+          currentFlags |= NEIGHBORHOOD_VALID | NEIGHBORHOOD_OTHER;
+        }
+
+        flags[currentColumn] = currentFlags;
+      }
+    }
+  }
+}
+
+void te::urban::convertFootprintToNeighborhoodFlags(const unsigned char* urbanFootprint, std::size_t numColumns, unsigned char* flags)
+{
+  for (std::size_t column = 0; column < numColumns; ++column)
+  {
+    unsigned char value = urbanFootprint[column];
+
+    flags[column] = 0;
+    if (value == OUTPUT_URBAN || value == OUTPUT_SUB_URBAN)
+    {
+      flags[column] = NEIGHBORHOOD_VALID | NEIGHBORHOOD_URBAN;
+    }
+    else if (value == OUTPUT_URBANIZED_OS)
+    {
+      flags[column] = NEIGHBORHOOD_VALID | NEIGHBORHOOD_OTHER;
+    }
+  }
+}
+
+void te::urban::calculateEdgeBitmap(const NeighborhoodPlane& plane, SpanInstructionSet instructionSet, std::size_t numWords, std::vector<boost::uint64_t>& vecEdgeBits)
+{
+  assert(numWords * 64 >= plane.m_numColumns);
+
+  CalculateEdgeBitsFunction calculateEdgeBits = getSpanKernels(instructionSet).m_calculateEdgeBits;
+
+  vecEdgeBits.assign(plane.m_numRows * numWords, 0);
+
+  for (std::size_t row = 0; row < plane.m_numRows; ++row)
+  {
+    const unsigned char* previousFlags = (row > 0) ? plane.getRow(row - 1) : 0;
+    const unsigned char* nextFlags = (row + 1 < plane.m_numRows) ? plane.getRow(row + 1) : 0;
+
+    calculateEdgeBits(previousFlags, plane.getRow(row), nextFlags, plane.m_numColumns, &vecEdgeBits[row * numWords]);
+  }
+}
+
+void te::urban::saveEdgeBitmap(const std::string& fileName, te::rst::Raster* referenceRaster, std::size_t numWords, const std::vector<boost::uint64_t>& vecEdgeBits,
+                               RasterWriter* rasterWriter, const RasterCreationOptions& options)
+{
+  assert(referenceRaster);
+
+  std::size_t numRows = referenceRaster->getNumberOfRows();
+  std::size_t numColumns = referenceRaster->getNumberOfColumns();
+
+  std::auto_ptr<te::rst::Raster> edgeRaster = cloneRasterIntoMem(referenceRaster, false);
+
+  //the bitmap is unpacked one strip at a time
+  std::size_t stripNumRows = getStripNumberOfRows(edgeRaster.get());
+
+  for (std::size_t stripFirstRow = 0; stripFirstRow < numRows; stripFirstRow += stripNumRows)
+  {
+    std::size_t stripLastRow = std::min(stripFirstRow + stripNumRows, numRows);
+
+    PixelPlane<unsigned char> strip(stripLastRow - stripFirstRow, numColumns, 0);
+    strip.setFirstRow(stripFirstRow);
+
+    for (std::size_t row = stripFirstRow; row < stripLastRow; ++row)
+    {
+      const boost::uint64_t* edgeBits = &vecEdgeBits[row * numWords];
+      unsigned char* values = strip.getRow(row - stripFirstRow);
+
+      for (std::size_t column = 0; column < numColumns; ++column)
+      {
+        values[column] = (unsigned char)((edgeBits[column >> 6] >> (column & 63)) & 1);
+      }
+    }
+
+    strip.write(edgeRaster.get());
+  }
+
+  //the writer takes the raster, which is freed when it is saved
+  if (rasterWriter != 0)
+  {
+    rasterWriter->write(fileName, edgeRaster, options);
+  }
+  else
+  {
+    saveRaster(fileName, edgeRaster.get(), options);
+  }
+}
+
+void te::urban::packNeighborhoodPlane(NeighborhoodPlane& plane)
+{
+  //the padding word allows the rank of the bit after the last column to be read
+  std::size_t numWords = ((plane.m_numColumns + 63) / 64) + 1;
+
+  plane.m_numWords = numWords;
+  plane.m_vecUrbanBits.assign(plane.m_numRows * numWords, 0);
+  plane.m_vecValidBits.assign(plane.m_numRows * numWords, 0);
+  plane.m_vecUrbanRanks.assign(plane.m_numRows * numWords, 0);
+  plane.m_vecValidRanks.assign(plane.m_numRows * numWords, 0);
+
+  for (std::size_t row = 0; row < plane.m_numRows; ++row)
+  {
+    const unsigned char* flags = plane.getRow(row);
+    boost::uint64_t* urbanBits = &plane.m_vecUrbanBits[row * numWords];
+    boost::uint64_t* validBits = &plane.m_vecValidBits[row * numWords];
+
+    for (std::size_t column = 0; column < plane.m_numColumns; ++column)
+    {
+      boost::uint64_t bit = ((boost::uint64_t)1) << (column & 63);
+
+      if (flags[column] & NEIGHBORHOOD_URBAN)
+      {
+        urbanBits[column >> 6] |= bit;
+      }
+      if (flags[column] & NEIGHBORHOOD_VALID)
+      {
+        validBits[column >> 6] |= bit;
+      }
+    }
+
+    unsigned int* urbanRanks = &plane.m_vecUrbanRanks[row * numWords];
+    unsigned int* validRanks = &plane.m_vecValidRanks[row * numWords];
+
+    unsigned int urbanRank = 0;
+    unsigned int validRank = 0;
+    for (std::size_t column = 0; column < plane.m_numColumns; ++column)
+    {
+      if ((column & 63) == 0)
+      {
+        urbanRanks[column >> 6] = urbanRank;
+        validRanks[column >> 6] = validRank;
+      }
+
+      urbanRank += (flags[column] & NEIGHBORHOOD_URBAN) ? 1 : 0;
+      validRank += (flags[column] & NEIGHBORHOOD_VALID) ? 1 : 0;
+    }
+
+    //the words after the last column
+    for (std::size_t word = (plane.m_numColumns + 63) / 64; word < numWords; ++word)
+    {
+      urbanRanks[word] = urbanRank;
+      validRanks[word] = validRank;
+    }
+  }
+}
+
+void te::urban::prepareNeighborhoodPlane(NeighborhoodKernel kernel, NeighborhoodPlane& plane)
+{
+  if (kernel == KERNEL_POPCOUNT)
+  {
+    packNeighborhoodPlane(plane);
+  }
+}
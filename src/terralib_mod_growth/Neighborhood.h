@@ -0,0 +1,498 @@
+/*  Copyright (C) 2011-2012 National Institute For Space Research (INPE) - Brazil.
+
+This file is part of the TerraLib - a Framework for building GIS enabled applications.
+
+TerraLib is free software: you can redistribute it and/or modify
+it under the terms of the GNU Lesser General Public License as published by
+the Free Software Foundation, either version 3 of the License,
+or (at your option) any later version.
+
+TerraLib is distributed in the hope that it will be useful,
+but WITHOUT ANY WARRANTY; without even the implied warranty of
+MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE. See the
+GNU Lesser General Public License for more details.
+
+You should have received a copy of the GNU Lesser General Public License
+along with TerraLib. See COPYING. If not, write to
+TerraLib Team at <terralib-team@terralib.org>.
+*/
+
+/*!
+\file urban_analysis/src/growth/Neighborhood.h
+
+\brief This file contains the engine used to count the urban and valid pixels within a circular neighborhood
+*/
+
+#ifndef __URBANANALYSIS_INTERNAL_GROWTH_NEIGHBORHOOD_H
+#define __URBANANALYSIS_INTERNAL_GROWTH_NEIGHBORHOOD_H
+
+#include "Config.h"
+
+#include "FourierTransform.h"
+#include "SpanKernels.h"
+#include "Utils.h"
+
+#include <boost/cstdint.hpp>
+#include <boost/numeric/ublas/matrix.hpp>
+#include <boost/thread/mutex.hpp>
+
+#include <memory>
+#include <string>
+#include <vector>
+
+namespace te
+{
+  namespace common
+  {
+    class TaskProgress;
+  }
+
+  namespace rst
+  {
+    class Raster;
+  }
+
+  namespace urban
+  {
+    class RasterWriter;
+
+    //!< Flags that describe each input pixel in the neighborhood analysis. A pixel is valid if it is water, urban or other
+    enum NeighborhoodPixelFlags
+    {
+      NEIGHBORHOOD_VALID = 1, NEIGHBORHOOD_URBAN = 2, NEIGHBORHOOD_WATER = 4, NEIGHBORHOOD_OTHER = 8
+    };
+
+    //!< One row of a radius mask. The columns from m_columnStart to m_columnEnd (relative to the center pixel) are inside the mask
+    struct MaskSpan
+    {
+      MaskSpan(int rowOffset, int columnStart, int columnEnd)
+        : m_rowOffset(rowOffset)
+        , m_columnStart(columnStart)
+        , m_columnEnd(columnEnd)
+      {}
+
+      int m_rowOffset;
+      int m_columnStart;
+      int m_columnEnd;
+    };
+
+    /*!
+      \brief The input raster converted to neighborhood flags, one byte per pixel stored row by row.
+
+      The plane may also be packed into two bit planes, one bit per pixel for the valid and for the urban flags, that are used by the popcount kernel.
+      Each bit row is followed by one padding word and has the number of bits set before each of its words.
+
+      A plane created by createNeighborhoodRingPlane keeps only m_numBufferRows rows in memory, each raster row in the position (row % m_numBufferRows).
+      The rows must then be read while the raster is processed, and only the counters that read the rows through getRow can be used.
+    */
+    struct NeighborhoodPlane
+    {
+      NeighborhoodPlane()
+        : m_numRows(0)
+        , m_numColumns(0)
+        , m_numBufferRows(0)
+        , m_numWords(0)
+      {}
+
+      const unsigned char* getRow(std::size_t row) const
+      {
+        return &m_vecFlags[getBufferRow(row) * m_numColumns];
+      }
+
+      unsigned char* getRow(std::size_t row)
+      {
+        return &m_vecFlags[getBufferRow(row) * m_numColumns];
+      }
+
+      //!< Returns the position of the given raster row in the flags
+      std::size_t getBufferRow(std::size_t row) const
+      {
+        return (m_numBufferRows != 0) ? row % m_numBufferRows : row;
+      }
+
+      //!< Returns true if the bit planes were created by packNeighborhoodPlane
+      bool isPacked() const
+      {
+        return m_numWords != 0;
+      }
+
+      PackedBitRow getUrbanBitRow(std::size_t row) const
+      {
+        PackedBitRow bitRow = { &m_vecUrbanBits[row * m_numWords], &m_vecUrbanRanks[row * m_numWords] };
+        return bitRow;
+      }
+
+      PackedBitRow getValidBitRow(std::size_t row) const
+      {
+        PackedBitRow bitRow = { &m_vecValidBits[row * m_numWords], &m_vecValidRanks[row * m_numWords] };
+        return bitRow;
+      }
+
+      std::size_t m_numRows;
+      std::size_t m_numColumns;
+      std::vector<unsigned char> m_vecFlags;
+
+      std::size_t m_numBufferRows;                  //!< the number of rows kept in memory by a ring plane, or 0 if all the rows are kept
+      std::size_t m_numWords;                       //!< the number of words of each bit row, including one padding word
+      std::vector<boost::uint64_t> m_vecUrbanBits;  //!< the urban flags, one bit per pixel
+      std::vector<boost::uint64_t> m_vecValidBits;  //!< the valid flags, one bit per pixel
+      std::vector<unsigned int> m_vecUrbanRanks;    //!< the number of urban bits of the row before each word
+      std::vector<unsigned int> m_vecValidRanks;    //!< the number of valid bits of the row before each word
+    };
+
+    //!< The algorithms available to count the pixels within the radius mask. The automatic kernel is the prefix sum for small masks and the FFT for large ones
+    enum NeighborhoodKernel
+    {
+      KERNEL_PREFIX_SUM, KERNEL_SLIDING_WINDOW, KERNEL_POPCOUNT, KERNEL_FFT, KERNEL_AUTOMATIC
+    };
+
+    /*!
+      \brief Counts the urban and the valid pixels within the radius mask of every pixel of a row.
+
+      A counter must not be shared between threads.
+    */
+    class TEGROWTHEXPORT NeighborhoodCounter
+    {
+      public:
+
+        NeighborhoodCounter(const NeighborhoodPlane& plane, const std::vector<MaskSpan>& vecSpans, SpanInstructionSet instructionSet = getSupportedSpanInstructionSet());
+
+        virtual ~NeighborhoodCounter();
+
+        //!< Counts, for each column of the given row, the urban and the valid pixels within the mask. The center pixel is not considered
+        virtual void countRow(std::size_t row, std::vector<unsigned int>& vecUrbanCount, std::vector<unsigned int>& vecValidCount) = 0;
+
+        const NeighborhoodPlane& getPlane() const;
+
+        //!< Returns the instruction set used by the span kernels of this counter
+        SpanInstructionSet getInstructionSet() const;
+
+      protected:
+
+        //!< Removes the center pixel of each column from the given counts
+        void removeCenterPixels(std::size_t row, std::vector<unsigned int>& vecUrbanCount, std::vector<unsigned int>& vecValidCount) const;
+
+        const NeighborhoodPlane& m_plane;
+        std::vector<MaskSpan> m_vecSpans;
+        int m_maskRadius;
+        const SpanKernels& m_spanKernels;
+    };
+
+    /*!
+      \brief Counts the neighborhood of each column as the difference between two prefix sums of each row covered by the mask.
+
+      The counter keeps the prefix sums of the (2r + 1) rows around the last requested row, so the rows must preferably be requested in sequence.
+      The columns whose windows are not clipped by the raster borders are accumulated by the vectorized span kernel.
+    */
+    class TEGROWTHEXPORT PrefixSumNeighborhoodCounter : public NeighborhoodCounter
+    {
+      public:
+
+        PrefixSumNeighborhoodCounter(const NeighborhoodPlane& plane, const std::vector<MaskSpan>& vecSpans, SpanInstructionSet instructionSet = getSupportedSpanInstructionSet());
+
+        virtual ~PrefixSumNeighborhoodCounter();
+
+        virtual void countRow(std::size_t row, std::vector<unsigned int>& vecUrbanCount, std::vector<unsigned int>& vecValidCount);
+
+      protected:
+
+        //!< Adds the windows of the given spans, centered in the given row, to the counts. The cache must hold all the rows covered by the spans
+        void accumulateSpans(std::size_t row, const std::vector<MaskSpan>& vecSpans, std::vector<unsigned int>& vecUrbanCount, std::vector<unsigned int>& vecValidCount);
+
+        //!< Returns the prefix sums of the given row, calculating them if they are not in the cache
+        std::size_t getPrefixRow(std::size_t row);
+
+        std::vector<std::size_t> m_vecCachedRows;                   //!< the row stored in each cache slot
+        std::vector<std::vector<unsigned int> > m_vecUrbanPrefix;   //!< the urban prefix sums of each cache slot
+        std::vector<std::vector<unsigned int> > m_vecValidPrefix;   //!< the valid prefix sums of each cache slot
+    };
+
+    /*!
+      \brief Counts the neighborhoods of many radii at once, sharing the prefix sums of the rows covered by the largest mask.
+
+      The window of a span costs a single difference of prefix sums whatever its width, so each radius only adds the spans of its own mask
+      to the counts. The input rows are converted to prefix sums only once for all the radii.
+    */
+    class TEGROWTHEXPORT MultiRadiusNeighborhoodCounter : public PrefixSumNeighborhoodCounter
+    {
+      public:
+
+        //!< The largest mask must be the last one
+        MultiRadiusNeighborhoodCounter(const NeighborhoodPlane& plane, const std::vector<std::vector<MaskSpan> >& vecRadiusSpans, SpanInstructionSet instructionSet = getSupportedSpanInstructionSet());
+
+        virtual ~MultiRadiusNeighborhoodCounter();
+
+        //!< Counts the given row for each mask. The counts of each mask are stored in the position of the mask
+        void countRowForAllRadii(std::size_t row, std::vector<std::vector<unsigned int> >& vecUrbanCounts, std::vector<std::vector<unsigned int> >& vecValidCounts);
+
+      protected:
+
+        std::vector<std::vector<MaskSpan> > m_vecRadiusSpans;
+    };
+
+    /*!
+      \brief Counts the neighborhood of each column by sliding the mask along the row.
+
+      When the mask moves from one column to the next, only the first pixel of each span leaves the window and only the pixel after its last one enters it,
+      so each span is updated with one subtraction and one addition. No state is kept between rows.
+    */
+    class TEGROWTHEXPORT SlidingWindowNeighborhoodCounter : public NeighborhoodCounter
+    {
+      public:
+
+        SlidingWindowNeighborhoodCounter(const NeighborhoodPlane& plane, const std::vector<MaskSpan>& vecSpans, SpanInstructionSet instructionSet = getSupportedSpanInstructionSet());
+
+        virtual ~SlidingWindowNeighborhoodCounter();
+
+        virtual void countRow(std::size_t row, std::vector<unsigned int>& vecUrbanCount, std::vector<unsigned int>& vecValidCount);
+    };
+
+    /*!
+      \brief Counts the neighborhood of each column by counting the bits of each span window in the packed plane.
+
+      The count of each window is the difference between two ranks, each one given by the rank stored before a word plus the popcount of the bits
+      of that word. The bit planes and their ranks use 3 bits per pixel, against the 64 bits of the prefix sums, so the rows around the current one
+      stay in the processor cache even for very wide rasters. The plane must have been packed by packNeighborhoodPlane.
+    */
+    class TEGROWTHEXPORT PopcountNeighborhoodCounter : public NeighborhoodCounter
+    {
+      public:
+
+        PopcountNeighborhoodCounter(const NeighborhoodPlane& plane, const std::vector<MaskSpan>& vecSpans, SpanInstructionSet instructionSet = getSupportedSpanInstructionSet());
+
+        virtual ~PopcountNeighborhoodCounter();
+
+        virtual void countRow(std::size_t row, std::vector<unsigned int>& vecUrbanCount, std::vector<unsigned int>& vecValidCount);
+    };
+
+    /*!
+      \brief Counts the neighborhood of a strip of rows at once, convolving the urban and the valid flags with the mask by fast fourier transforms.
+
+      The strip is split in tiles. Each tile is transformed together with the (r) pixels around it, so the circular convolution of the block is equal to
+      the direct count inside the tile. The urban and the valid flags are the real and the imaginary parts of the same block, as the mask is real.
+      The counts are rounded to the nearest integer. The rounding error of the transform is many orders of magnitude below 0.5 for the supported sizes,
+      so the counts are exactly the same of the other kernels. The cost of each pixel grows with the logarithm of the radius, not with the radius.
+      The transform and the spectrum of the mask are never changed after the construction, so the counters of the threads share them.
+    */
+    class TEGROWTHEXPORT FFTNeighborhoodCounter : public NeighborhoodCounter
+    {
+      public:
+
+        FFTNeighborhoodCounter(const NeighborhoodPlane& plane, const std::vector<MaskSpan>& vecSpans, SpanInstructionSet instructionSet = getSupportedSpanInstructionSet());
+
+        //!< Creates a counter that shares the transform and the spectrum of the mask of the given counter. Only the block and the strips are allocated
+        FFTNeighborhoodCounter(const FFTNeighborhoodCounter& rhs);
+
+        virtual ~FFTNeighborhoodCounter();
+
+        virtual void countRow(std::size_t row, std::vector<unsigned int>& vecUrbanCount, std::vector<unsigned int>& vecValidCount);
+
+        //!< Returns the memory, in bytes, of the block and the strips allocated by each counter
+        std::size_t getCounterMemorySize() const;
+
+        //!< Returns the memory, in bytes, of the spectrum of the mask shared by the counters
+        std::size_t getSharedMemorySize() const;
+
+      protected:
+
+        //!< Counts the rows of the strip that starts in the given row
+        void countStrip(std::size_t firstRow);
+
+        std::shared_ptr<const FourierTransform2D> m_transform;
+        std::shared_ptr<const std::vector<std::complex<double> > > m_maskSpectrum; //!< the transform of the mask, mirrored around the origin of the block
+        std::vector<std::complex<double> > m_vecBlock;
+        std::size_t m_tileRows;
+        std::size_t m_tileColumns;
+        std::size_t m_stripFirstRow;
+        std::size_t m_stripNumRows;
+        std::vector<unsigned int> m_vecUrbanStrip;
+        std::vector<unsigned int> m_vecValidStrip;
+    };
+
+    //!< Creates the counter that implements the given kernel
+    TEGROWTHEXPORT std::auto_ptr<NeighborhoodCounter> createNeighborhoodCounter(NeighborhoodKernel kernel, const NeighborhoodPlane& plane, const std::vector<MaskSpan>& vecSpans);
+
+    //!< Returns the kernel to be used with the given mask. The automatic kernel is replaced by the FFT when the radius of the mask is at least TEGROWTH_FFT_MINIMUM_RADIUS pixels, and by the prefix sum otherwise
+    TEGROWTHEXPORT NeighborhoodKernel selectNeighborhoodKernel(NeighborhoodKernel kernel, const std::vector<MaskSpan>& vecSpans);
+
+    //!< Returns the kernel to be used with a ring plane. The popcount and the FFT kernels need more rows than the ring keeps, so they are replaced by the prefix sums
+    TEGROWTHEXPORT NeighborhoodKernel selectRingPlaneKernel(NeighborhoodKernel kernel, const std::vector<MaskSpan>& vecSpans);
+
+    //!< Gets the name of the given kernel and of the instruction set used by its counters, to be used in the log messages
+    TEGROWTHEXPORT std::string getNeighborhoodKernelName(NeighborhoodKernel kernel, SpanInstructionSet instructionSet);
+
+    /*!
+      \brief Decides the output of the pixels of a row, given the neighborhood counts of each column.
+
+      The rows are classified by many threads at the same time, so a row classifier must only write to the outputs of the given row.
+    */
+    class TEGROWTHEXPORT NeighborhoodRowClassifier
+    {
+      public:
+
+        virtual ~NeighborhoodRowClassifier();
+
+        virtual void classifyRow(std::size_t row, const unsigned char* flags, const std::vector<unsigned int>& vecUrbanCount, const std::vector<unsigned int>& vecValidCount) = 0;
+    };
+
+    /*!
+      \brief The statistics of the urban pixels of each row that are used to calculate the urban indexes.
+
+      Only the urban pixels within the study area whose neighborhood has valid pixels are considered. Each row is only written by the thread that classifies it,
+      and the totals are summed in the order of the rows, so the indexes do not depend on the number of threads. The edge index is the number of considered pixels
+      that are also set in the edge bitmap of the plane, counted word by word.
+    */
+    struct TEGROWTHEXPORT UrbanIndexesStatistics
+    {
+      //!< The study area has one byte for each pixel of the plane, not zero within the spatial limits. If it is null, all the pixels are within the study area. The edge bitmap is calculated here
+      UrbanIndexesStatistics(const NeighborhoodPlane& plane, const unsigned char* studyArea);
+
+      //!< Calculates the openness and the edge index from the statistics of all the rows
+      void calculateUrbanIndexes(UrbanIndexes& urbanIndexes) const;
+
+      const unsigned char* m_studyArea;
+      std::size_t m_numColumns;
+      std::size_t m_numWords;                         //!< the number of words of each row of the bitmaps
+      std::vector<boost::uint64_t> m_vecEdgeBits;     //!< the edge bitmap of the plane, created by calculateEdgeBitmap
+      std::vector<boost::uint64_t> m_vecUrbanBits;    //!< the considered urban pixels of each row
+      std::vector<std::size_t> m_vecNumUrbanPixels;   //!< the number of considered urban pixels of each row
+      std::vector<double> m_vecSumPermUrb;            //!< the sum of the urban percentage of the considered urban pixels of each row
+    };
+
+    //!< Classifies the urbanized area, the urban footprint and the urban percentage into row major buffers. The null buffers are not calculated
+    class TEGROWTHEXPORT UrbanAreasRowClassifier : public NeighborhoodRowClassifier
+    {
+      public:
+
+        //!< The buffers start at the given raster row
+        UrbanAreasRowClassifier(const InputClassesMap& inputClassesMap, std::size_t numColumns, unsigned char* urbanizedArea, unsigned char* urbanFootprint, float* permUrb, std::size_t firstRow = 0);
+
+        virtual ~UrbanAreasRowClassifier();
+
+        //!< Accumulates the statistics of the urban indexes while the rows are classified, so the neighborhoods are not counted again to calculate them
+        void setUrbanIndexesStatistics(UrbanIndexesStatistics* urbanIndexesStatistics);
+
+        virtual void classifyRow(std::size_t row, const unsigned char* flags, const std::vector<unsigned int>& vecUrbanCount, const std::vector<unsigned int>& vecValidCount);
+
+      protected:
+
+        InputClassesMap m_inputClassesMap;
+        short m_inputUrban;
+        short m_inputOther;
+        std::size_t m_numColumns;
+        unsigned char* m_urbanizedArea;
+        unsigned char* m_urbanFootprint;
+        float* m_permUrb;
+        std::size_t m_firstRow;
+        UrbanIndexesStatistics* m_urbanIndexesStatistics;
+    };
+
+    /*!
+      \brief Classifies the urban open areas of a footprint buffer in place.
+
+      The plane must flag the urban and suburban pixels of the footprint as NEIGHBORHOOD_URBAN and the candidate open area pixels as NEIGHBORHOOD_OTHER.
+      A candidate remains an urbanized open area if there is at least one urban pixel in its neighborhood, otherwise it becomes a rural open area.
+    */
+    class TEGROWTHEXPORT UrbanOpenAreaRowClassifier : public NeighborhoodRowClassifier
+    {
+      public:
+
+        //!< The buffer starts at the given raster row
+        UrbanOpenAreaRowClassifier(std::size_t numColumns, unsigned char* urbanFootprint, std::size_t firstRow = 0);
+
+        virtual ~UrbanOpenAreaRowClassifier();
+
+        virtual void classifyRow(std::size_t row, const unsigned char* flags, const std::vector<unsigned int>& vecUrbanCount, const std::vector<unsigned int>& vecValidCount);
+
+      protected:
+
+        std::size_t m_numColumns;
+        unsigned char* m_urbanFootprint;
+        std::size_t m_firstRow;
+    };
+
+    /*!
+      \brief Pulses a task once for each strip of TEGROWTH_PROGRESS_STRIP_ROWS rows classified by the threads.
+
+      The bands of the threads are split in strips from their first row, and the last strip of a band may be shorter. The task is pulsed by the thread that
+      finished the strip, under a mutex, so the progress advances while the bands are classified.
+    */
+    class TEGROWTHEXPORT RowProgress
+    {
+      public:
+
+        //!< If the task is null, nothing is pulsed
+        explicit RowProgress(te::common::TaskProgress* task);
+
+        //!< Returns the number of strips of the band [firstRow, lastRow)
+        static std::size_t getNumberOfStrips(std::size_t firstRow, std::size_t lastRow);
+
+        //!< Tells that the given row of the band [firstRow, lastRow) was classified. The task is pulsed if it is the last row of a strip
+        void finishRow(std::size_t row, std::size_t firstRow, std::size_t lastRow);
+
+      protected:
+
+        te::common::TaskProgress* m_task;
+        boost::mutex m_mutex;
+    };
+
+    //!< Classifies the rows [firstRow, lastRow) using the given counter. It is the body of each thread of classifyNeighborhoodRows. If given, the progress is told about each classified row
+    TEGROWTHEXPORT void classifyNeighborhoodRowBand(NeighborhoodCounter* counter, NeighborhoodRowClassifier* classifier, std::size_t firstRow, std::size_t lastRow, RowProgress* progress = 0);
+
+    //!< Returns the number of threads to be used. If the requested number is 0, all the available cores are used
+    TEGROWTHEXPORT std::size_t getNumberOfThreads(std::size_t requestedThreads);
+
+    /*!
+      \brief Counts the neighborhood of all the rows of the plane and gives them to the row classifier.
+
+      The rows are split in contiguous bands, one for each thread. Each thread has its own counter and reads the (2r + 1) rows around its rows from the shared plane,
+      so the result does not depend on the number of threads. Returns the instruction set used by the counters.
+    */
+    TEGROWTHEXPORT SpanInstructionSet classifyNeighborhoodRows(const NeighborhoodPlane& plane, const std::vector<MaskSpan>& vecSpans, NeighborhoodKernel kernel, std::size_t numberOfThreads, NeighborhoodRowClassifier& classifier, const std::string& taskMessage);
+
+    //!< Classifies the rows [firstRow, lastRow) of the plane in the same way as classifyNeighborhoodRows. The rows within the radius of the range must be in the plane. The FFT counters of the threads share the spectrum of the mask, and the number of threads is reduced so they fit in TEGROWTH_FFT_MEMORY_SIZE megabytes. If given, the steps of the task are the strips of the bands and it is pulsed once for each strip. Returns the instruction set used by the counters
+    TEGROWTHEXPORT SpanInstructionSet classifyNeighborhoodRowRange(const NeighborhoodPlane& plane, const std::vector<MaskSpan>& vecSpans, NeighborhoodKernel kernel, std::size_t numberOfThreads,
+                                                     std::size_t firstRow, std::size_t lastRow, NeighborhoodRowClassifier& classifier, te::common::TaskProgress* task = 0);
+
+    //!< Classifies the rows [firstRow, lastRow) for all the radii of the counter, giving the counts of each radius to the classifier in the same position. If given, the progress is told about each classified row
+    TEGROWTHEXPORT void classifyMultiRadiusRowBand(MultiRadiusNeighborhoodCounter* counter, const std::vector<NeighborhoodRowClassifier*>* vecClassifiers, std::size_t firstRow, std::size_t lastRow, RowProgress* progress = 0);
+
+    /*!
+      \brief Counts the neighborhood of all the rows of the plane for many radii in a single scan, giving the counts of each radius to its row classifier.
+
+      The masks must be sorted by radius. The rows are split in bands in the same way as in classifyNeighborhoodRows. Returns the instruction set used by the counters.
+    */
+    TEGROWTHEXPORT SpanInstructionSet classifyNeighborhoodRowsForRadii(const NeighborhoodPlane& plane, const std::vector<std::vector<MaskSpan> >& vecRadiusSpans, std::size_t numberOfThreads,
+                                                         const std::vector<NeighborhoodRowClassifier*>& vecClassifiers, const std::string& taskMessage);
+
+    //!< Converts the given radius mask into a list of row spans
+    TEGROWTHEXPORT std::vector<MaskSpan> createMaskSpans(const boost::numeric::ublas::matrix<bool>& mask);
+
+    //!< Reads the input raster once and converts its values into neighborhood flags
+    TEGROWTHEXPORT void createNeighborhoodPlane(te::rst::Raster* inputRaster, const InputClassesMap& inputClassesMap, NeighborhoodPlane& plane);
+
+    //!< Creates a plane for a raster with the given size that keeps only numBufferRows rows in memory. The rows are read by readNeighborhoodRows
+    TEGROWTHEXPORT void createNeighborhoodRingPlane(std::size_t numRows, std::size_t numColumns, std::size_t numBufferRows, NeighborhoodPlane& plane);
+
+    //!< Reads the rows [firstRow, firstRow + numRows) of the input raster into the plane, converting their values into neighborhood flags
+    TEGROWTHEXPORT void readNeighborhoodRows(te::rst::Raster* inputRaster, const InputClassesMap& inputClassesMap, std::size_t firstRow, std::size_t numRows, NeighborhoodPlane& plane);
+
+    //!< Converts a row of an urban footprint into the flags used to classify the urban open areas. The urban and suburban pixels are urban and the urbanized open areas are candidates
+    TEGROWTHEXPORT void convertFootprintToNeighborhoodFlags(const unsigned char* urbanFootprint, std::size_t numColumns, unsigned char* flags);
+
+    //!< Creates the urban and the valid bit planes from the flags of the plane
+    TEGROWTHEXPORT void packNeighborhoodPlane(NeighborhoodPlane& plane);
+
+    //!< Creates the extra data needed by the given kernel. It must be called after the flags of the plane are set and before its counters are created
+    TEGROWTHEXPORT void prepareNeighborhoodPlane(NeighborhoodKernel kernel, NeighborhoodPlane& plane);
+
+    //!< Creates a bitmap with numWords words for each row of the plane, set in the urban pixels that have a not urban pixel in their 4-neighborhood. The pixels outside the plane are not considered
+    TEGROWTHEXPORT void calculateEdgeBitmap(const NeighborhoodPlane& plane, SpanInstructionSet instructionSet, std::size_t numWords, std::vector<boost::uint64_t>& vecEdgeBits);
+
+    //!< Saves the edge bitmap as a raster with the grid of the reference raster, with 1 in the edge pixels and 0 in the others. The raster is created in memory and queued in the given writer. If the writer is null, it is saved before returning
+    TEGROWTHEXPORT void saveEdgeBitmap(const std::string& fileName, te::rst::Raster* referenceRaster, std::size_t numWords, const std::vector<boost::uint64_t>& vecEdgeBits,
+                                       RasterWriter* rasterWriter, const RasterCreationOptions& options);
+  }
+}
+
+#endif //__URBANANALYSIS_INTERNAL_GROWTH_NEIGHBORHOOD_H
@@ -0,0 +1,433 @@
+/*  Copyright (C) 2011-2012 National Institute For Space Research (INPE) - Brazil.
+
+This file is part of the TerraLib - a Framework for building GIS enabled applications.
+
+TerraLib is free software: you can redistribute it and/or modify
+it under the terms of the GNU Lesser General Public License as published by
+the Free Software Foundation, either version 3 of the License,
+or (at your option) any later version.
+
+TerraLib is distributed in the hope that it will be useful,
+but WITHOUT ANY WARRANTY; without even the implied warranty of
+MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE. See the
+GNU Lesser General Public License for more details.
+
+You should have received a copy of the GNU Lesser General Public License
+along with TerraLib. See COPYING. If not, write to
+TerraLib Team at <terralib-team@terralib.org>.
+*/
+
+/*!
+\file urban_analysis/src/growth/PixelPlane.h
+
+\brief This file contains a typed and contiguous copy of the pixels of a raster band
+*/
+
+#ifndef __URBANANALYSIS_INTERNAL_GROWTH_PIXELPLANE_H
+#define __URBANANALYSIS_INTERNAL_GROWTH_PIXELPLANE_H
+
+//Terralib
+#include <terralib/datatype/Enums.h>
+#include <terralib/memory/Raster.h>
+#include <terralib/raster/Band.h>
+#include <terralib/raster/BandProperty.h>
+#include <terralib/raster/Raster.h>
+
+#include <algorithm>
+#include <cassert>
+#include <vector>
+
+namespace te
+{
+  namespace urban
+  {
+    //!< Returns the size in bytes of a pixel of the given TerraLib data type, or 0 if the data type is not supported by the pixel planes
+    inline std::size_t getPixelPlaneDataTypeSize(int dataType)
+    {
+      switch (dataType)
+      {
+        case te::dt::CHAR_TYPE:
+        case te::dt::UCHAR_TYPE:
+          return 1;
+        case te::dt::INT16_TYPE:
+        case te::dt::UINT16_TYPE:
+          return 2;
+        case te::dt::INT32_TYPE:
+        case te::dt::UINT32_TYPE:
+        case te::dt::FLOAT_TYPE:
+          return 4;
+        case te::dt::DOUBLE_TYPE:
+          return 8;
+      }
+
+      return 0;
+    }
+
+    template<class S, class D> inline void convertPixels(const S* source, D* target, std::size_t count)
+    {
+      for (std::size_t i = 0; i < count; ++i)
+      {
+        target[i] = static_cast<D>(source[i]);
+      }
+    }
+
+    //!< Converts pixels stored in a band block with the given data type into T
+    template<class T> inline void convertFromDataType(int dataType, const unsigned char* source, T* target, std::size_t count)
+    {
+      switch (dataType)
+      {
+        case te::dt::CHAR_TYPE: convertPixels((const char*)source, target, count); break;
+        case te::dt::UCHAR_TYPE: convertPixels((const unsigned char*)source, target, count); break;
+        case te::dt::INT16_TYPE: convertPixels((const short*)source, target, count); break;
+        case te::dt::UINT16_TYPE: convertPixels((const unsigned short*)source, target, count); break;
+        case te::dt::INT32_TYPE: convertPixels((const int*)source, target, count); break;
+        case te::dt::UINT32_TYPE: convertPixels((const unsigned int*)source, target, count); break;
+        case te::dt::FLOAT_TYPE: convertPixels((const float*)source, target, count); break;
+        case te::dt::DOUBLE_TYPE: convertPixels((const double*)source, target, count); break;
+      }
+    }
+
+    //!< Converts T pixels into a band block with the given data type
+    template<class T> inline void convertToDataType(int dataType, const T* source, unsigned char* target, std::size_t count)
+    {
+      switch (dataType)
+      {
+        case te::dt::CHAR_TYPE: convertPixels(source, (char*)target, count); break;
+        case te::dt::UCHAR_TYPE: convertPixels(source, (unsigned char*)target, count); break;
+        case te::dt::INT16_TYPE: convertPixels(source, (short*)target, count); break;
+        case te::dt::UINT16_TYPE: convertPixels(source, (unsigned short*)target, count); break;
+        case te::dt::INT32_TYPE: convertPixels(source, (int*)target, count); break;
+        case te::dt::UINT32_TYPE: convertPixels(source, (unsigned int*)target, count); break;
+        case te::dt::FLOAT_TYPE: convertPixels(source, (float*)target, count); break;
+        case te::dt::DOUBLE_TYPE: convertPixels(source, (double*)target, count); break;
+      }
+    }
+
+    //!< Returns the pixels of the given band when they are held in memory in a single block, as the bands of the MEM rasters, so they can be accessed in place. Otherwise returns null
+    inline unsigned char* getBandMemory(const te::rst::Raster* raster, std::size_t band = 0)
+    {
+      if (dynamic_cast<const te::mem::Raster*>(raster) == 0)
+      {
+        return 0;
+      }
+
+      te::rst::Band* rasterBand = const_cast<te::rst::Band*>(raster->getBand(band));
+      const te::rst::BandProperty* property = rasterBand->getProperty();
+
+      if (getPixelPlaneDataTypeSize(property->getType()) == 0 || property->m_nblocksx != 1 || property->m_nblocksy != 1 ||
+          property->m_blkw != (int)raster->getNumberOfColumns() || property->m_blkh != (int)raster->getNumberOfRows())
+      {
+        return 0;
+      }
+
+      //the block of a memory band is its buffer, so it is returned without any copy
+      return (unsigned char*)rasterBand->read(0, 0);
+    }
+
+    //!< Returns the number of rows that should be read at a time when a raster is processed in strips. It is the smallest multiple of the block height of the band that has at least the given number of rows, so a strip never writes only a part of a tile. The bands held in memory are not limited by their block
+    inline std::size_t getStripNumberOfRows(const te::rst::Raster* raster, std::size_t band = 0, std::size_t minimumRows = 256)
+    {
+      if (getBandMemory(raster, band) != 0)
+      {
+        return std::max(minimumRows, (std::size_t)1);
+      }
+
+      std::size_t blockHeight = (std::size_t)std::max(raster->getBand(band)->getProperty()->m_blkh, 1);
+
+      return ((minimumRows + blockHeight - 1) / blockHeight) * blockHeight;
+    }
+
+    /*!
+      \brief A typed and contiguous copy of a set of rows of a raster band, or of a window of them, stored row by row.
+
+      The pixels are copied from and to the raster block by block, converting them from and to the data type of the band in a single typed loop per block row.
+      The bands held in memory are accessed in place, row by row, instead of block by block. If the blocks of the band cannot be used, the pixels are copied using getValue and setValue.
+    */
+    template<class T> class PixelPlane
+    {
+      public:
+
+        PixelPlane()
+          : m_firstRow(0)
+          , m_firstColumn(0)
+          , m_numRows(0)
+          , m_numColumns(0)
+        {}
+
+        PixelPlane(std::size_t numRows, std::size_t numColumns, T value = T())
+          : m_firstRow(0)
+          , m_firstColumn(0)
+          , m_numRows(numRows)
+          , m_numColumns(numColumns)
+          , m_vecData(numRows * numColumns, value)
+        {}
+
+        //!< Reads the rows [firstRow, firstRow + numRows) of the given band. If numRows is 0, all the rows from firstRow are read. The columns are limited in the same way, and only the blocks of the window are read
+        void read(const te::rst::Raster* raster, std::size_t band = 0, std::size_t firstRow = 0, std::size_t numRows = 0, std::size_t firstColumn = 0, std::size_t numColumns = 0);
+
+        //!< Writes the plane into the given band, starting at the first row of the plane. The plane must have all the columns of the raster
+        void write(te::rst::Raster* raster, std::size_t band = 0) const;
+
+        //!< Sets the raster row that corresponds to the first row of the plane
+        void setFirstRow(std::size_t firstRow) { m_firstRow = firstRow; }
+
+        std::size_t getFirstRow() const { return m_firstRow; }
+
+        //!< Sets the raster column that corresponds to the first column of the plane
+        void setFirstColumn(std::size_t firstColumn) { m_firstColumn = firstColumn; }
+
+        //!< Returns the raster column that corresponds to the first column of the plane
+        std::size_t getFirstColumn() const { return m_firstColumn; }
+
+        std::size_t getNumberOfRows() const { return m_numRows; }
+
+        std::size_t getNumberOfColumns() const { return m_numColumns; }
+
+        //!< Returns the given row, relative to the first row of the plane
+        T* getRow(std::size_t row) { return &m_vecData[row * m_numColumns]; }
+
+        const T* getRow(std::size_t row) const { return &m_vecData[row * m_numColumns]; }
+
+        T& operator()(std::size_t row, std::size_t column) { return m_vecData[(row * m_numColumns) + column]; }
+
+        const T& operator()(std::size_t row, std::size_t column) const { return m_vecData[(row * m_numColumns) + column]; }
+
+      protected:
+
+        //!< Returns true if the blocks of the band cover the raster and have the expected size
+        static bool hasBlockAccess(const te::rst::Raster* raster, std::size_t band);
+
+        std::size_t m_firstRow;
+        std::size_t m_firstColumn;
+        std::size_t m_numRows;
+        std::size_t m_numColumns;
+        std::vector<T> m_vecData;
+    };
+
+    template<class T> bool PixelPlane<T>::hasBlockAccess(const te::rst::Raster* raster, std::size_t band)
+    {
+      const te::rst::Band* rasterBand = raster->getBand(band);
+      const te::rst::BandProperty* property = rasterBand->getProperty();
+
+      std::size_t pixelSize = getPixelPlaneDataTypeSize(property->getType());
+      if (pixelSize == 0 || property->m_blkw <= 0 || property->m_blkh <= 0)
+      {
+        return false;
+      }
+
+      std::size_t blockWidth = (std::size_t)property->m_blkw;
+      std::size_t blockHeight = (std::size_t)property->m_blkh;
+
+      if (blockWidth * (std::size_t)property->m_nblocksx < raster->getNumberOfColumns() || blockHeight * (std::size_t)property->m_nblocksy < raster->getNumberOfRows())
+      {
+        return false;
+      }
+
+      return (std::size_t)rasterBand->getBlockSize() == blockWidth * blockHeight * pixelSize;
+    }
+
+    template<class T> void PixelPlane<T>::read(const te::rst::Raster* raster, std::size_t band, std::size_t firstRow, std::size_t numRows, std::size_t firstColumn, std::size_t numColumns)
+    {
+      assert(raster);
+
+      std::size_t rasterNumRows = raster->getNumberOfRows();
+      std::size_t rasterNumColumns = raster->getNumberOfColumns();
+
+      m_firstRow = std::min(firstRow, rasterNumRows);
+      m_numRows = rasterNumRows - m_firstRow;
+      if (numRows != 0)
+      {
+        m_numRows = std::min(numRows, m_numRows);
+      }
+      m_firstColumn = std::min(firstColumn, rasterNumColumns);
+      m_numColumns = rasterNumColumns - m_firstColumn;
+      if (numColumns != 0)
+      {
+        m_numColumns = std::min(numColumns, m_numColumns);
+      }
+      m_vecData.resize(m_numRows * m_numColumns);
+
+      if (m_vecData.empty())
+      {
+        return;
+      }
+
+      const unsigned char* bandMemory = getBandMemory(raster, band);
+      if (bandMemory != 0)
+      {
+        int dataType = raster->getBand(band)->getProperty()->getType();
+        std::size_t pixelSize = getPixelPlaneDataTypeSize(dataType);
+
+        for (std::size_t row = 0; row < m_numRows; ++row)
+        {
+          const unsigned char* source = bandMemory + ((m_firstRow + row) * rasterNumColumns + m_firstColumn) * pixelSize;
+          convertFromDataType(dataType, source, getRow(row), m_numColumns);
+        }
+        return;
+      }
+
+      if (hasBlockAccess(raster, band) == false)
+      {
+        for (std::size_t row = 0; row < m_numRows; ++row)
+        {
+          T* rowData = getRow(row);
+          for (std::size_t column = 0; column < m_numColumns; ++column)
+          {
+            double value = 0.;
+            raster->getValue((unsigned int)(m_firstColumn + column), (unsigned int)(m_firstRow + row), value, band);
+            rowData[column] = static_cast<T>(value);
+          }
+        }
+        return;
+      }
+
+      const te::rst::Band* rasterBand = raster->getBand(band);
+      const te::rst::BandProperty* property = rasterBand->getProperty();
+
+      int dataType = property->getType();
+      std::size_t pixelSize = getPixelPlaneDataTypeSize(dataType);
+      std::size_t blockWidth = (std::size_t)property->m_blkw;
+      std::size_t blockHeight = (std::size_t)property->m_blkh;
+
+      std::vector<unsigned char> vecBlock(rasterBand->getBlockSize());
+
+      std::size_t lastRow = m_firstRow + m_numRows;
+      std::size_t lastColumn = m_firstColumn + m_numColumns;
+      for (std::size_t blockY = m_firstRow / blockHeight; blockY * blockHeight < lastRow; ++blockY)
+      {
+        std::size_t blockFirstRow = blockY * blockHeight;
+        std::size_t rowBegin = std::max(blockFirstRow, m_firstRow);
+        std::size_t rowEnd = std::min(blockFirstRow + blockHeight, lastRow);
+
+        for (std::size_t blockX = m_firstColumn / blockWidth; blockX * blockWidth < lastColumn; ++blockX)
+        {
+          std::size_t blockFirstColumn = blockX * blockWidth;
+          std::size_t columnBegin = std::max(blockFirstColumn, m_firstColumn);
+          std::size_t columnEnd = std::min(blockFirstColumn + blockWidth, lastColumn);
+
+          rasterBand->read((int)blockX, (int)blockY, &vecBlock[0]);
+
+          for (std::size_t row = rowBegin; row < rowEnd; ++row)
+          {
+            const unsigned char* source = &vecBlock[((row - blockFirstRow) * blockWidth + (columnBegin - blockFirstColumn)) * pixelSize];
+            convertFromDataType(dataType, source, getRow(row - m_firstRow) + (columnBegin - m_firstColumn), columnEnd - columnBegin);
+          }
+        }
+      }
+    }
+
+    template<class T> void PixelPlane<T>::write(te::rst::Raster* raster, std::size_t band) const
+    {
+      assert(raster);
+      assert(m_firstColumn == 0);
+      assert(m_numColumns == raster->getNumberOfColumns());
+      assert(m_firstRow + m_numRows <= raster->getNumberOfRows());
+
+      if (m_vecData.empty())
+      {
+        return;
+      }
+
+      unsigned char* bandMemory = getBandMemory(raster, band);
+      if (bandMemory != 0)
+      {
+        int dataType = raster->getBand(band)->getProperty()->getType();
+        std::size_t pixelSize = getPixelPlaneDataTypeSize(dataType);
+
+        for (std::size_t row = 0; row < m_numRows; ++row)
+        {
+          convertToDataType(dataType, getRow(row), bandMemory + (m_firstRow + row) * m_numColumns * pixelSize, m_numColumns);
+        }
+        return;
+      }
+
+      if (hasBlockAccess(raster, band) == false)
+      {
+        for (std::size_t row = 0; row < m_numRows; ++row)
+        {
+          const T* rowData = getRow(row);
+          for (std::size_t column = 0; column < m_numColumns; ++column)
+          {
+            raster->setValue((unsigned int)column, (unsigned int)(m_firstRow + row), (double)rowData[column], band);
+          }
+        }
+        return;
+      }
+
+      te::rst::Band* rasterBand = raster->getBand(band);
+      const te::rst::BandProperty* property = rasterBand->getProperty();
+
+      int dataType = property->getType();
+      std::size_t pixelSize = getPixelPlaneDataTypeSize(dataType);
+      std::size_t blockWidth = (std::size_t)property->m_blkw;
+      std::size_t blockHeight = (std::size_t)property->m_blkh;
+      std::size_t rasterNumRows = raster->getNumberOfRows();
+
+      std::vector<unsigned char> vecBlock(rasterBand->getBlockSize());
+
+      std::size_t lastRow = m_firstRow + m_numRows;
+      for (std::size_t blockY = m_firstRow / blockHeight; blockY * blockHeight < lastRow; ++blockY)
+      {
+        std::size_t blockFirstRow = blockY * blockHeight;
+        std::size_t rowBegin = std::max(blockFirstRow, m_firstRow);
+        std::size_t rowEnd = std::min(blockFirstRow + blockHeight, lastRow);
+
+        //if the plane does not cover all the raster rows of the block, the block must be read before being changed
+        bool partialBlock = (rowBegin != blockFirstRow) || (rowEnd != std::min(blockFirstRow + blockHeight, rasterNumRows));
+
+        for (std::size_t blockX = 0; blockX * blockWidth < m_numColumns; ++blockX)
+        {
+          std::size_t blockFirstColumn = blockX * blockWidth;
+          std::size_t blockNumColumns = std::min(blockWidth, m_numColumns - blockFirstColumn);
+
+          if (partialBlock)
+          {
+            rasterBand->read((int)blockX, (int)blockY, &vecBlock[0]);
+          }
+
+          for (std::size_t row = rowBegin; row < rowEnd; ++row)
+          {
+            unsigned char* target = &vecBlock[(row - blockFirstRow) * blockWidth * pixelSize];
+            convertToDataType(dataType, getRow(row - m_firstRow) + blockFirstColumn, target, blockNumColumns);
+          }
+
+          rasterBand->write((int)blockX, (int)blockY, &vecBlock[0]);
+        }
+      }
+    }
+
+    //!< Reads the given rows of a band as a mask of its pixels that are not no data, stored row by row. The values are read a block row at a time, so only the mask of the whole rows is held
+    inline void readDataMask(const te::rst::Raster* raster, std::size_t band, std::size_t firstRow, std::size_t numRows, std::vector<unsigned char>& vecMask)
+    {
+      std::size_t numColumns = raster->getNumberOfColumns();
+      std::size_t lastRow = std::min(firstRow + numRows, (std::size_t)raster->getNumberOfRows());
+      double noDataValue = raster->getBand(band)->getProperty()->m_noDataValue;
+
+      vecMask.resize((lastRow - firstRow) * numColumns);
+
+      std::size_t blockNumRows = getStripNumberOfRows(raster, band, 1);
+      PixelPlane<double> strip;
+
+      for (std::size_t stripFirstRow = firstRow; stripFirstRow < lastRow; )
+      {
+        std::size_t stripLastRow = std::min((stripFirstRow / blockNumRows + 1) * blockNumRows, lastRow);
+        strip.read(raster, band, stripFirstRow, stripLastRow - stripFirstRow);
+
+        for (std::size_t stripRow = 0; stripRow < strip.getNumberOfRows(); ++stripRow)
+        {
+          const double* values = strip.getRow(stripRow);
+          unsigned char* mask = &vecMask[(stripFirstRow - firstRow + stripRow) * numColumns];
+
+          for (std::size_t column = 0; column < numColumns; ++column)
+          {
+            mask[column] = (values[column] != noDataValue) ? 1 : 0;
+          }
+        }
+
+        stripFirstRow = stripLastRow;
+      }
+    }
+  }
+}
+
+#endif //__URBANANALYSIS_INTERNAL_GROWTH_PIXELPLANE_H
@@ -0,0 +1,184 @@
+/*  Copyright (C) 2011-2012 National Institute For Space Research (INPE) - Brazil.
+
+This file is part of the TerraLib - a Framework for building GIS enabled applications.
+
+TerraLib is free software: you can redistribute it and/or modify
+it under the terms of the GNU Lesser General Public License as published by
+the Free Software Foundation, either version 3 of the License,
+or (at your option) any later version.
+
+TerraLib is distributed in the hope that it will be useful,
+but WITHOUT ANY WARRANTY; without even the implied warranty of
+MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE. See the
+GNU Lesser General Public License for more details.
+
+You should have received a copy of the GNU Lesser General Public License
+along with TerraLib. See COPYING. If not, write to
+TerraLib Team at <terralib-team@terralib.org>.
+*/
+
+
+/*!
+\file urban_analysis/src/growth/RasterWriter.cpp
+
+\brief This file contains a queue of rasters that are saved into files by background threads
+*/
+
+#include "RasterWriter.h"
+#include "Utils.h"
+
+//Terralib
+#include <terralib/common/Exception.h>
+#include <terralib/raster/Band.h>
+#include <terralib/raster/BandProperty.h>
+#include <terralib/raster/Raster.h>
+
+//Boost
+#include <boost/lexical_cast.hpp>
+
+te::urban::RasterWriter::RasterWriter(std::size_t numberOfThreads, std::size_t maxQueuedRasters)
+  : m_maxQueuedRasters(maxQueuedRasters)
+  , m_numWritingRasters(0)
+  , m_stop(false)
+{
+  if (numberOfThreads == 0)
+  {
+    numberOfThreads = 1;
+  }
+  if (m_maxQueuedRasters == 0)
+  {
+    m_maxQueuedRasters = 1;
+  }
+
+  for (std::size_t i = 0; i < numberOfThreads; ++i)
+  {
+    m_threads.create_thread(boost::bind(&RasterWriter::run, this));
+  }
+}
+
+te::urban::RasterWriter::~RasterWriter()
+{
+  //the threads only stop after the queue is empty
+  {
+    boost::mutex::scoped_lock lock(m_mutex);
+    m_stop = true;
+  }
+  m_queueNotEmpty.notify_all();
+
+  m_threads.join_all();
+
+  if (m_errorMessage.empty() == false)
+  {
+    logError(m_errorMessage);
+  }
+}
+
+void te::urban::RasterWriter::write(const std::string& fileName, std::auto_ptr<te::rst::Raster> raster, const RasterCreationOptions& options)
+{
+  write(fileName, std::shared_ptr<te::rst::Raster>(raster.release()), options);
+}
+
+void te::urban::RasterWriter::write(const std::string& fileName, const std::shared_ptr<te::rst::Raster>& raster, const RasterCreationOptions& options)
+{
+  QueuedRaster queuedRaster;
+  queuedRaster.m_fileName = fileName;
+  queuedRaster.m_raster = raster;
+  queuedRaster.m_options = options;
+
+  //backpressure: the caller waits while the queue is full
+  {
+    boost::mutex::scoped_lock lock(m_mutex);
+    while (m_queue.size() >= m_maxQueuedRasters)
+    {
+      m_queueNotFull.wait(lock);
+    }
+
+    m_queue.push_back(queuedRaster);
+  }
+
+  m_queueNotEmpty.notify_one();
+}
+
+void te::urban::RasterWriter::writeCopy(const std::string& fileName, te::rst::Raster* raster, const RasterCreationOptions& options)
+{
+  write(fileName, cloneRasterIntoMem(raster, true, raster->getBand(0)->getProperty()->getType()), options);
+}
+
+void te::urban::RasterWriter::wait()
+{
+  std::string errorMessage;
+  {
+    boost::mutex::scoped_lock lock(m_mutex);
+    while (m_queue.empty() == false || m_numWritingRasters != 0)
+    {
+      m_finished.wait(lock);
+    }
+
+    errorMessage.swap(m_errorMessage);
+  }
+
+  if (errorMessage.empty() == false)
+  {
+    throw te::common::Exception(errorMessage);
+  }
+}
+
+void te::urban::RasterWriter::run()
+{
+  while (true)
+  {
+    QueuedRaster queuedRaster;
+    {
+      boost::mutex::scoped_lock lock(m_mutex);
+      while (m_queue.empty() && m_stop == false)
+      {
+        m_queueNotEmpty.wait(lock);
+      }
+
+      if (m_queue.empty())
+      {
+        return;
+      }
+
+      queuedRaster = m_queue.front();
+      m_queue.pop_front();
+      ++m_numWritingRasters;
+    }
+    m_queueNotFull.notify_one();
+
+    std::string errorMessage;
+    try
+    {
+      Timer timer;
+
+      saveRaster(queuedRaster.m_fileName, queuedRaster.m_raster.get(), queuedRaster.m_options);
+
+      //the writer runs concurrently with the analysis, so only the wall time of the save is meaningful, and it is taken once for the time and the rate
+      double elapsedTime = timer.getElapsedTimeInSeconds();
+
+      std::size_t numPixels = (std::size_t)queuedRaster.m_raster->getNumberOfRows() * queuedRaster.m_raster->getNumberOfColumns() * queuedRaster.m_raster->getNumberOfBands();
+      std::size_t pixelsPerSecond = elapsedTime > 0. ? (std::size_t)(numPixels / elapsedTime) : 0;
+
+      std::string message = "RasterWriter saved " + queuedRaster.m_fileName + " in " + boost::lexical_cast<std::string>(elapsedTime) + " seconds of wall time";
+      message += " (" + boost::lexical_cast<std::string>(pixelsPerSecond) + " pixels/second)";
+      logInfo(message);
+    }
+    catch (const std::exception& e)
+    {
+      errorMessage = "Could not save the raster " + queuedRaster.m_fileName + ": " + e.what() + " Error in function: RasterWriter::run";
+    }
+
+    //the raster is released before the writer is notified, so a wait returns only after the memory of the written rasters is freed
+    queuedRaster.m_raster.reset();
+
+    {
+      boost::mutex::scoped_lock lock(m_mutex);
+      if (errorMessage.empty() == false)
+      {
+        m_errorMessage += m_errorMessage.empty() ? errorMessage : "\n" + errorMessage;
+      }
+      --m_numWritingRasters;
+    }
+    m_finished.notify_all();
+  }
+}
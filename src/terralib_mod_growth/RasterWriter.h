@@ -0,0 +1,103 @@
+/*  Copyright (C) 2011-2012 National Institute For Space Research (INPE) - Brazil.
+
+This file is part of the TerraLib - a Framework for building GIS enabled applications.
+
+TerraLib is free software: you can redistribute it and/or modify
+it under the terms of the GNU Lesser General Public License as published by
+the Free Software Foundation, either version 3 of the License,
+or (at your option) any later version.
+
+TerraLib is distributed in the hope that it will be useful,
+but WITHOUT ANY WARRANTY; without even the implied warranty of
+MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE. See the
+GNU Lesser General Public License for more details.
+
+You should have received a copy of the GNU Lesser General Public License
+along with TerraLib. See COPYING. If not, write to
+TerraLib Team at <terralib-team@terralib.org>.
+*/
+
+
+/*!
+\file urban_analysis/src/growth/RasterWriter.h
+
+\brief This file contains a queue of rasters that are saved into files by background threads
+*/
+
+#ifndef __URBANANALYSIS_INTERNAL_GROWTH_RASTERWRITER_H
+#define __URBANANALYSIS_INTERNAL_GROWTH_RASTERWRITER_H
+
+#include "Config.h"
+#include "Utils.h"
+
+//Boost
+#include <boost/thread.hpp>
+
+#include <cstddef>
+#include <deque>
+#include <memory>
+#include <string>
+
+namespace te
+{
+  namespace rst
+  {
+    class Raster;
+  }
+
+  namespace urban
+  {
+    /*!
+      \brief Saves the finished rasters into files in background, so the next step can be calculated while the previous outputs are written.
+
+      The queued rasters are written by dedicated I/O threads. The queue is bounded: when it is full, a new write blocks until an I/O thread takes
+      one of the queued rasters, so a slow disk limits the memory used by the rasters waiting to be written. The destructor waits for all the writes.
+    */
+    class TEGROWTHEXPORT RasterWriter
+    {
+      public:
+
+        RasterWriter(std::size_t numberOfThreads = TEGROWTH_RASTER_WRITER_THREADS, std::size_t maxQueuedRasters = TEGROWTH_RASTER_WRITER_QUEUE_SIZE);
+
+        ~RasterWriter();
+
+        //!< Queues the raster to be saved in the given file. The writer takes the ownership of the raster
+        void write(const std::string& fileName, std::auto_ptr<te::rst::Raster> raster, const RasterCreationOptions& options = RasterCreationOptions());
+
+        //!< Queues the raster to be saved in the given file. The raster is shared with the caller, which must not change it anymore
+        void write(const std::string& fileName, const std::shared_ptr<te::rst::Raster>& raster, const RasterCreationOptions& options = RasterCreationOptions());
+
+        //!< Queues a copy in memory of the raster, so the caller can keep changing it
+        void writeCopy(const std::string& fileName, te::rst::Raster* raster, const RasterCreationOptions& options = RasterCreationOptions());
+
+        //!< Waits for all the queued rasters to be saved. Throws an exception if any of them could not be saved
+        void wait();
+
+      protected:
+
+        struct QueuedRaster
+        {
+          std::string m_fileName;
+          std::shared_ptr<te::rst::Raster> m_raster;
+          RasterCreationOptions m_options;
+        };
+
+        //!< The loop of the I/O threads
+        void run();
+
+        std::size_t m_maxQueuedRasters;
+        std::deque<QueuedRaster> m_queue;
+        std::size_t m_numWritingRasters; //!< the rasters taken from the queue that are still being written
+        bool m_stop;
+        std::string m_errorMessage; //!< the errors of the writes since the last wait
+
+        boost::mutex m_mutex;
+        boost::condition_variable m_queueNotEmpty;
+        boost::condition_variable m_queueNotFull;
+        boost::condition_variable m_finished;
+        boost::thread_group m_threads;
+    };
+  }
+}
+
+#endif //__URBANANALYSIS_INTERNAL_GROWTH_RASTERWRITER_H
@@ -0,0 +1,292 @@
+/*  Copyright (C) 2011-2012 National Institute For Space Research (INPE) - Brazil.
+
+This file is part of the TerraLib - a Framework for building GIS enabled applications.
+
+TerraLib is free software: you can redistribute it and/or modify
+it under the terms of the GNU Lesser General Public License as published by
+the Free Software Foundation, either version 3 of the License,
+or (at your option) any later version.
+
+TerraLib is distributed in the hope that it will be useful,
+but WITHOUT ANY WARRANTY; without even the implied warranty of
+MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE. See the
+GNU Lesser General Public License for more details.
+
+You should have received a copy of the GNU Lesser General Public License
+along with TerraLib. See COPYING. If not, write to
+TerraLib Team at <terralib-team@terralib.org>.
+*/
+
+
+/*!
+\file urban_analysis/src/growth/Resampler.cpp
+
+\brief This file contains the parallel resampling of a raster into the grid of another raster
+*/
+
+#include "Resampler.h"
+#include "GridTransformer.h"
+#include "Neighborhood.h"
+
+//Terralib
+#include <terralib/common/Exception.h>
+#include <terralib/common/STLUtils.h>
+#include <terralib/common/progress/TaskProgress.h>
+#include <terralib/datatype/Enums.h>
+#include <terralib/raster/Band.h>
+#include <terralib/raster/BandProperty.h>
+#include <terralib/raster/Raster.h>
+#include <terralib/raster/Utils.h>
+
+//Boost
+#include <boost/bind.hpp>
+
+#include <algorithm>
+#include <limits>
+
+te::urban::NearestNeighborResampler::NearestNeighborResampler(te::rst::Raster* inputRaster, te::rst::Raster* outputRaster, double maxError, double noDataValue,
+                                                              std::size_t numberOfThreads, std::size_t tileSize)
+  : m_inputRaster(inputRaster)
+  , m_outputRaster(outputRaster)
+  , m_noDataValue(noDataValue)
+  , m_tileSize(std::max(tileSize, (std::size_t)1))
+  , m_stripFirstRow(0)
+  , m_stripNumRows(0)
+  , m_windowFirstRow(0)
+  , m_windowLastRow(-1)
+  , m_windowFirstColumn(0)
+  , m_windowLastColumn(-1)
+  , m_nextTile(0)
+{
+  assert(inputRaster);
+  assert(outputRaster);
+
+  //there is no gain in having more threads than tiles in a strip
+  std::size_t numTilesPerStrip = (outputRaster->getNumberOfColumns() + m_tileSize - 1) / m_tileSize;
+  numberOfThreads = std::min(getNumberOfThreads(numberOfThreads), std::max(numTilesPerStrip, (std::size_t)1));
+
+  for (std::size_t i = 0; i < numberOfThreads; ++i)
+  {
+    m_vecTransformers.push_back(new GridTransformer(outputRaster->getGrid(), inputRaster->getGrid(), maxError));
+  }
+}
+
+te::urban::NearestNeighborResampler::~NearestNeighborResampler()
+{
+  te::common::FreeContents(m_vecTransformers);
+}
+
+void te::urban::NearestNeighborResampler::resample(te::common::TaskProgress* task)
+{
+  //the pixels are resampled in the data type of the output, as nearest neighbor only copies them
+  switch (m_outputRaster->getBand(0)->getProperty()->getType())
+  {
+    case te::dt::CHAR_TYPE: resampleStrips<char>(task); break;
+    case te::dt::UCHAR_TYPE: resampleStrips<unsigned char>(task); break;
+    case te::dt::INT16_TYPE: resampleStrips<short>(task); break;
+    case te::dt::UINT16_TYPE: resampleStrips<unsigned short>(task); break;
+    case te::dt::INT32_TYPE: resampleStrips<int>(task); break;
+    case te::dt::UINT32_TYPE: resampleStrips<unsigned int>(task); break;
+    case te::dt::FLOAT_TYPE: resampleStrips<float>(task); break;
+    default: resampleStrips<double>(task); break;
+  }
+}
+
+std::size_t te::urban::NearestNeighborResampler::getNumberOfExactTransformations() const
+{
+  std::size_t numExactTransformations = 0;
+  for (std::size_t i = 0; i < m_vecTransformers.size(); ++i)
+  {
+    numExactTransformations += m_vecTransformers[i]->getNumberOfExactTransformations();
+  }
+  return numExactTransformations;
+}
+
+template<class T> void te::urban::NearestNeighborResampler::resampleStrips(te::common::TaskProgress* task)
+{
+  std::size_t numRows = m_outputRaster->getNumberOfRows();
+  std::size_t numColumns = m_outputRaster->getNumberOfColumns();
+
+  //the strips are whole rows of blocks of the output, unless the blocks are much taller than a tile. Then the strips have the height of a tile
+  std::size_t stripNumRows = getStripNumberOfRows(m_outputRaster, 0, m_tileSize);
+  if (stripNumRows > 2 * m_tileSize)
+  {
+    stripNumRows = m_tileSize;
+  }
+
+  PixelPlane<T> outputStrip;
+  PixelPlane<T> inputWindow;
+
+  for (m_stripFirstRow = 0; m_stripFirstRow < numRows; m_stripFirstRow += stripNumRows)
+  {
+    m_stripNumRows = std::min(stripNumRows, numRows - m_stripFirstRow);
+
+    //first phase - the positions of the pixels of the strip are transformed, to find the window of the input that contains them
+    m_vecInputColumns.resize(m_stripNumRows * numColumns);
+    m_vecInputRows.resize(m_stripNumRows * numColumns);
+    m_windowFirstRow = std::numeric_limits<int>::max();
+    m_windowLastRow = -1;
+    m_windowFirstColumn = std::numeric_limits<int>::max();
+    m_windowLastColumn = -1;
+
+    runThreads(boost::bind(&NearestNeighborResampler::transformTiles, this, _1));
+
+    outputStrip = PixelPlane<T>(m_stripNumRows, numColumns, (T)m_noDataValue);
+    outputStrip.setFirstRow(m_stripFirstRow);
+
+    //second phase - the window is read once and the tiles are filled from it. If the strip is outside the input, it keeps the no data value
+    if (m_windowLastRow >= 0)
+    {
+      inputWindow.read(m_inputRaster, 0, (std::size_t)m_windowFirstRow, (std::size_t)(m_windowLastRow - m_windowFirstRow + 1),
+                       (std::size_t)m_windowFirstColumn, (std::size_t)(m_windowLastColumn - m_windowFirstColumn + 1));
+
+      runThreads(boost::bind(&NearestNeighborResampler::fillTiles<T>, this, &outputStrip, &inputWindow));
+    }
+
+    outputStrip.write(m_outputRaster);
+
+    if (task != 0)
+    {
+      task->pulse();
+    }
+  }
+
+  std::vector<int>().swap(m_vecInputColumns);
+  std::vector<int>().swap(m_vecInputRows);
+}
+
+void te::urban::NearestNeighborResampler::runThreads(const boost::function<void (GridTransformer*)>& threadLoop)
+{
+  m_nextTile = 0;
+
+  boost::thread_group threadGroup;
+  for (std::size_t i = 0; i < m_vecTransformers.size(); ++i)
+  {
+    threadGroup.create_thread(boost::bind(threadLoop, m_vecTransformers[i]));
+  }
+  threadGroup.join_all();
+
+  if (m_errorMessage.empty() == false)
+  {
+    throw te::common::Exception(m_errorMessage + " Error in function: NearestNeighborResampler::resample");
+  }
+}
+
+bool te::urban::NearestNeighborResampler::takeNextTile(std::size_t& tileFirstColumn)
+{
+  boost::mutex::scoped_lock lock(m_tileMutex);
+  if (m_errorMessage.empty() == false || m_nextTile * m_tileSize >= m_outputRaster->getNumberOfColumns())
+  {
+    return false;
+  }
+
+  tileFirstColumn = m_nextTile * m_tileSize;
+  ++m_nextTile;
+  return true;
+}
+
+void te::urban::NearestNeighborResampler::transformTiles(GridTransformer* transformer)
+{
+  std::vector<double> vecInputColumns;
+  std::vector<double> vecInputRows;
+
+  std::size_t tileFirstColumn = 0;
+  while (takeNextTile(tileFirstColumn))
+  {
+    try
+    {
+      transformTile(transformer, tileFirstColumn, vecInputColumns, vecInputRows);
+    }
+    catch (const std::exception& e)
+    {
+      boost::mutex::scoped_lock lock(m_tileMutex);
+      m_errorMessage = e.what();
+      return;
+    }
+  }
+}
+
+void te::urban::NearestNeighborResampler::transformTile(GridTransformer* transformer, std::size_t tileFirstColumn, std::vector<double>& vecInputColumns, std::vector<double>& vecInputRows)
+{
+  std::size_t numColumns = m_outputRaster->getNumberOfColumns();
+  std::size_t tileNumColumns = std::min(m_tileSize, numColumns - tileFirstColumn);
+
+  int inputNumRows = (int)m_inputRaster->getNumberOfRows();
+  int inputNumColumns = (int)m_inputRaster->getNumberOfColumns();
+
+  vecInputColumns.resize(tileNumColumns);
+  vecInputRows.resize(tileNumColumns);
+
+  int windowFirstColumn = std::numeric_limits<int>::max();
+  int windowLastColumn = -1;
+  int windowFirstRow = std::numeric_limits<int>::max();
+  int windowLastRow = -1;
+
+  for (std::size_t row = 0; row < m_stripNumRows; ++row)
+  {
+    transformer->transformRow(m_stripFirstRow + row, tileFirstColumn, tileNumColumns, &vecInputColumns[0], &vecInputRows[0]);
+
+    int* inputColumns = &m_vecInputColumns[row * numColumns + tileFirstColumn];
+    int* inputRows = &m_vecInputRows[row * numColumns + tileFirstColumn];
+
+    for (std::size_t column = 0; column < tileNumColumns; ++column)
+    {
+      int inputColumn = te::rst::Round(vecInputColumns[column]);
+      int inputRow = te::rst::Round(vecInputRows[column]);
+
+      if (inputColumn >= 0 && inputColumn < inputNumColumns && inputRow >= 0 && inputRow < inputNumRows)
+      {
+        inputColumns[column] = inputColumn;
+        inputRows[column] = inputRow;
+
+        windowFirstColumn = std::min(windowFirstColumn, inputColumn);
+        windowLastColumn = std::max(windowLastColumn, inputColumn);
+        windowFirstRow = std::min(windowFirstRow, inputRow);
+        windowLastRow = std::max(windowLastRow, inputRow);
+      }
+      else
+      {
+        inputColumns[column] = -1;
+        inputRows[column] = -1;
+      }
+    }
+  }
+
+  if (windowLastColumn < 0)
+  {
+    return;
+  }
+
+  boost::mutex::scoped_lock lock(m_tileMutex);
+  m_windowFirstColumn = std::min(m_windowFirstColumn, windowFirstColumn);
+  m_windowLastColumn = std::max(m_windowLastColumn, windowLastColumn);
+  m_windowFirstRow = std::min(m_windowFirstRow, windowFirstRow);
+  m_windowLastRow = std::max(m_windowLastRow, windowLastRow);
+}
+
+template<class T> void te::urban::NearestNeighborResampler::fillTiles(PixelPlane<T>* outputStrip, const PixelPlane<T>* inputWindow)
+{
+  std::size_t numColumns = outputStrip->getNumberOfColumns();
+
+  //each tile is filled by a single thread, and the window is only read
+  std::size_t tileFirstColumn = 0;
+  while (takeNextTile(tileFirstColumn))
+  {
+    std::size_t tileNumColumns = std::min(m_tileSize, numColumns - tileFirstColumn);
+
+    for (std::size_t row = 0; row < m_stripNumRows; ++row)
+    {
+      const int* inputColumns = &m_vecInputColumns[row * numColumns + tileFirstColumn];
+      const int* inputRows = &m_vecInputRows[row * numColumns + tileFirstColumn];
+      T* outputRow = outputStrip->getRow(row) + tileFirstColumn;
+
+      for (std::size_t column = 0; column < tileNumColumns; ++column)
+      {
+        if (inputColumns[column] >= 0)
+        {
+          outputRow[column] = (*inputWindow)((std::size_t)(inputRows[column] - m_windowFirstRow), (std::size_t)(inputColumns[column] - m_windowFirstColumn));
+        }
+      }
+    }
+  }
+}
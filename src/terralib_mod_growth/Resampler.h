@@ -0,0 +1,122 @@
+/*  Copyright (C) 2011-2012 National Institute For Space Research (INPE) - Brazil.
+
+This file is part of the TerraLib - a Framework for building GIS enabled applications.
+
+TerraLib is free software: you can redistribute it and/or modify
+it under the terms of the GNU Lesser General Public License as published by
+the Free Software Foundation, either version 3 of the License,
+or (at your option) any later version.
+
+TerraLib is distributed in the hope that it will be useful,
+but WITHOUT ANY WARRANTY; without even the implied warranty of
+MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE. See the
+GNU Lesser General Public License for more details.
+
+You should have received a copy of the GNU Lesser General Public License
+along with TerraLib. See COPYING. If not, write to
+TerraLib Team at <terralib-team@terralib.org>.
+*/
+
+
+/*!
+\file urban_analysis/src/growth/Resampler.h
+
+\brief This file contains the parallel resampling of a raster into the grid of another raster
+*/
+
+#ifndef __URBANANALYSIS_INTERNAL_GROWTH_RESAMPLER_H
+#define __URBANANALYSIS_INTERNAL_GROWTH_RESAMPLER_H
+
+#include "Config.h"
+#include "PixelPlane.h"
+
+//Boost
+#include <boost/function.hpp>
+#include <boost/thread.hpp>
+
+#include <cstddef>
+#include <string>
+#include <vector>
+
+namespace te
+{
+  namespace common
+  {
+    class TaskProgress;
+  }
+
+  namespace rst
+  {
+    class Raster;
+  }
+
+  namespace urban
+  {
+    class GridTransformer;
+
+    /*!
+      \brief Resamples the first band of a raster into the grid of the output raster by the nearest neighbor, tile by tile, in parallel.
+
+      The output is processed in strips of tiles, in the data type of the output band. Each strip is done in two phases whose tiles are shared by the
+      threads: first the positions of the pixels of the tiles are transformed into the input, then the window of the input that contains all the
+      positions of the strip is read once, by the calling thread, and the threads fill the tiles from it. The strip is written into the output raster
+      when all its tiles are done. The input raster is never read by the threads, as the cached rasters cannot be read concurrently.
+    */
+    class TEGROWTHEXPORT NearestNeighborResampler
+    {
+      public:
+
+        //!< The maximum error of the transformation is given in input pixels. If the number of threads is 0, one thread per core is used
+        NearestNeighborResampler(te::rst::Raster* inputRaster, te::rst::Raster* outputRaster, double maxError, double noDataValue,
+                                 std::size_t numberOfThreads = 0, std::size_t tileSize = TEGROWTH_RESAMPLE_TILE_SIZE);
+
+        ~NearestNeighborResampler();
+
+        //!< Resamples all the output raster. If given, the task is pulsed once for each strip of tiles
+        void resample(te::common::TaskProgress* task = 0);
+
+        //!< Returns the number of pixels that were transformed exactly, to measure the gain of the approximation
+        std::size_t getNumberOfExactTransformations() const;
+
+      protected:
+
+        //!< Resamples the output in strips of pixels of the given type
+        template<class T> void resampleStrips(te::common::TaskProgress* task);
+
+        //!< Runs the given loop in the threads, giving a transformer to each one, and throws the first error of the threads
+        void runThreads(const boost::function<void (GridTransformer*)>& threadLoop);
+
+        //!< Takes the next tile of the current strip. Returns false when there are no more tiles or a thread failed
+        bool takeNextTile(std::size_t& tileFirstColumn);
+
+        //!< The loop of the threads in the first phase of a strip, which transform the positions of the pixels of the tiles into the input
+        void transformTiles(GridTransformer* transformer);
+
+        //!< The loop of the threads in the second phase of a strip, which fill the tiles with the pixels of the window of the input
+        template<class T> void fillTiles(PixelPlane<T>* outputStrip, const PixelPlane<T>* inputWindow);
+
+        void transformTile(GridTransformer* transformer, std::size_t tileFirstColumn, std::vector<double>& vecInputColumns, std::vector<double>& vecInputRows);
+
+        te::rst::Raster* m_inputRaster;
+        te::rst::Raster* m_outputRaster;
+        double m_noDataValue;
+        std::size_t m_tileSize;
+        std::vector<GridTransformer*> m_vecTransformers; //!< one for each thread, as the coordinate converters cannot be shared
+
+        std::size_t m_stripFirstRow;         //!< the first row of the strip of tiles being resampled
+        std::size_t m_stripNumRows;
+        std::vector<int> m_vecInputColumns;  //!< the rounded input column of each pixel of the strip, or -1 when the pixel is outside the input
+        std::vector<int> m_vecInputRows;     //!< the rounded input row of each pixel of the strip, or -1 when the pixel is outside the input
+        int m_windowFirstRow;                //!< the window of the input that contains the positions of all the pixels of the strip
+        int m_windowLastRow;
+        int m_windowFirstColumn;
+        int m_windowLastColumn;
+        std::size_t m_nextTile;              //!< the next tile of the strip to be processed
+        std::string m_errorMessage;
+
+        boost::mutex m_tileMutex;
+    };
+  }
+}
+
+#endif //__URBANANALYSIS_INTERNAL_GROWTH_RESAMPLER_H
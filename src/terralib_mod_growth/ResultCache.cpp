@@ -0,0 +1,222 @@
+/*  Copyright (C) 2011-2012 National Institute For Space Research (INPE) - Brazil.
+
+This file is part of the TerraLib - a Framework for building GIS enabled applications.
+
+TerraLib is free software: you can redistribute it and/or modify
+it under the terms of the GNU Lesser General Public License as published by
+the Free Software Foundation, either version 3 of the License,
+or (at your option) any later version.
+
+TerraLib is distributed in the hope that it will be useful,
+but WITHOUT ANY WARRANTY; without even the implied warranty of
+MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE. See the
+GNU Lesser General Public License for more details.
+
+You should have received a copy of the GNU Lesser General Public License
+along with TerraLib. See COPYING. If not, write to
+TerraLib Team at <terralib-team@terralib.org>.
+*/
+
+
+/*!
+\file urban_analysis/src/growth/ResultCache.cpp
+
+\brief This file contains a persistent cache of the prepared rasters, addressed by the hash of everything that defines them
+*/
+
+#include "ResultCache.h"
+#include "NativeRaster.h"
+
+//Terralib
+#include <terralib/common/Exception.h>
+#include <terralib/raster/Raster.h>
+
+//Boost
+#include <boost/filesystem.hpp>
+#include <boost/lexical_cast.hpp>
+
+#include <cstdio>
+#include <fstream>
+#include <iomanip>
+#include <limits>
+#include <vector>
+
+te::urban::Hasher::Hasher()
+  : m_hash(14695981039346656037ULL)
+{
+}
+
+void te::urban::Hasher::add(const void* data, std::size_t size)
+{
+  const unsigned char* bytes = (const unsigned char*)data;
+  for (std::size_t i = 0; i < size; ++i)
+  {
+    m_hash ^= bytes[i];
+    m_hash *= 1099511628211ULL;
+  }
+}
+
+void te::urban::Hasher::add(const std::string& value)
+{
+  //the size is added too, so the concatenation of different strings never gives the same hash
+  add((boost::uint64_t)value.size());
+  add(value.data(), value.size());
+}
+
+void te::urban::Hasher::add(double value)
+{
+  add(&value, sizeof(value));
+}
+
+void te::urban::Hasher::add(boost::uint64_t value)
+{
+  add(&value, sizeof(value));
+}
+
+void te::urban::Hasher::addFileContent(const std::string& fileName)
+{
+  std::ifstream file(fileName.c_str(), std::ios::in | std::ios::binary);
+  if (file.is_open() == false)
+  {
+    throw te::common::Exception("Could not open the file " + fileName + ". Error in function: Hasher::addFileContent");
+  }
+
+  std::vector<char> buffer(1024 * 1024);
+  while (file)
+  {
+    file.read(&buffer[0], (std::streamsize)buffer.size());
+    add(&buffer[0], (std::size_t)file.gcount());
+  }
+}
+
+std::string te::urban::Hasher::getHash() const
+{
+  char hash[17];
+  std::sprintf(hash, "%016llx", (unsigned long long)m_hash);
+  return hash;
+}
+
+te::urban::ResultCache::ResultCache(const std::string& directory)
+  : m_directory(directory)
+  , m_numHits(0)
+  , m_numMisses(0)
+  , m_numStoredEntries(0)
+  , m_loadSeconds(0.)
+  , m_storeSeconds(0.)
+{
+  boost::filesystem::create_directories(m_directory);
+}
+
+te::urban::ResultCache::~ResultCache()
+{
+}
+
+bool te::urban::ResultCache::load(const std::string& key, UrbanRasters& rasters, UrbanIndexes* urbanIndexes)
+{
+  Timer timer;
+
+  boost::filesystem::path entryPath = boost::filesystem::path(m_directory) / key;
+  boost::filesystem::path urbanizedPath = entryPath / ("urbanized" TEGROWTH_NATIVE_RASTER_EXTENSION);
+  boost::filesystem::path footprintPath = entryPath / ("footprint" TEGROWTH_NATIVE_RASTER_EXTENSION);
+  boost::filesystem::path indexesPath = entryPath / "indexes.txt";
+
+  bool found = boost::filesystem::exists(urbanizedPath) && boost::filesystem::exists(footprintPath);
+  if (found && urbanIndexes != 0)
+  {
+    found = boost::filesystem::exists(indexesPath);
+  }
+
+  if (found == false)
+  {
+    boost::mutex::scoped_lock lock(m_mutex);
+    ++m_numMisses;
+    return false;
+  }
+
+  //the entries are mapped into memory, so the pixels are only read when they are accessed and are shared by the processes that use the cache
+  rasters.m_urbanizedAreaRaster.reset(openNativeRaster(urbanizedPath.string()).release());
+  rasters.m_urbanFootprintRaster.reset(openNativeRaster(footprintPath.string()).release());
+
+  if (urbanIndexes != 0)
+  {
+    std::ifstream indexesFile(indexesPath.string().c_str());
+
+    std::string name;
+    double value = 0.;
+    while (indexesFile >> name >> value)
+    {
+      (*urbanIndexes)[name] = value;
+    }
+  }
+
+  boost::mutex::scoped_lock lock(m_mutex);
+  ++m_numHits;
+  m_loadSeconds += timer.getElapsedTimeInSeconds();
+
+  logInfo("ResultCache loaded the entry " + key);
+
+  return true;
+}
+
+void te::urban::ResultCache::store(const std::string& key, const UrbanRasters& rasters, const UrbanIndexes* urbanIndexes)
+{
+  Timer timer;
+
+  boost::filesystem::path entryPath = boost::filesystem::path(m_directory) / key;
+  boost::filesystem::path temporaryPath = boost::filesystem::path(m_directory) / boost::filesystem::unique_path(key + "_%%%%%%%%.tmp");
+
+  //a cache that cannot be written only makes the next executions slower, so the errors are only logged
+  try
+  {
+    boost::filesystem::create_directories(temporaryPath);
+
+    saveNativeRaster((temporaryPath / ("urbanized" TEGROWTH_NATIVE_RASTER_EXTENSION)).string(), rasters.m_urbanizedAreaRaster.get());
+    saveNativeRaster((temporaryPath / ("footprint" TEGROWTH_NATIVE_RASTER_EXTENSION)).string(), rasters.m_urbanFootprintRaster.get());
+
+    if (urbanIndexes != 0)
+    {
+      std::ofstream indexesFile((temporaryPath / "indexes.txt").string().c_str());
+      indexesFile << std::setprecision(std::numeric_limits<double>::digits10 + 2);
+
+      UrbanIndexes::const_iterator it = urbanIndexes->begin();
+      while (it != urbanIndexes->end())
+      {
+        indexesFile << it->first << " " << it->second << "\n";
+        ++it;
+      }
+    }
+
+    //if another thread has already stored the same entry, the rename fails and the temporary entry is removed
+    boost::system::error_code errorCode;
+    boost::filesystem::rename(temporaryPath, entryPath, errorCode);
+    if (errorCode)
+    {
+      boost::filesystem::remove_all(temporaryPath, errorCode);
+      return;
+    }
+  }
+  catch (const std::exception& e)
+  {
+    boost::system::error_code errorCode;
+    boost::filesystem::remove_all(temporaryPath, errorCode);
+
+    logWarning("ResultCache could not store the entry " + key + ": " + e.what());
+    return;
+  }
+
+  boost::mutex::scoped_lock lock(m_mutex);
+  ++m_numStoredEntries;
+  m_storeSeconds += timer.getElapsedTimeInSeconds();
+}
+
+void te::urban::ResultCache::logStatistics()
+{
+  boost::mutex::scoped_lock lock(m_mutex);
+
+  std::string message = "ResultCache " + m_directory + ": " + boost::lexical_cast<std::string>(m_numHits) + " hits";
+  message += " (" + boost::lexical_cast<std::string>(m_loadSeconds) + " seconds loading), ";
+  message += boost::lexical_cast<std::string>(m_numMisses) + " misses, ";
+  message += boost::lexical_cast<std::string>(m_numStoredEntries) + " stored entries (" + boost::lexical_cast<std::string>(m_storeSeconds) + " seconds storing)";
+
+  logInfo(message);
+}
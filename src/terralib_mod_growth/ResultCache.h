@@ -0,0 +1,109 @@
+/*  Copyright (C) 2011-2012 National Institute For Space Research (INPE) - Brazil.
+
+This file is part of the TerraLib - a Framework for building GIS enabled applications.
+
+TerraLib is free software: you can redistribute it and/or modify
+it under the terms of the GNU Lesser General Public License as published by
+the Free Software Foundation, either version 3 of the License,
+or (at your option) any later version.
+
+TerraLib is distributed in the hope that it will be useful,
+but WITHOUT ANY WARRANTY; without even the implied warranty of
+MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE. See the
+GNU Lesser General Public License for more details.
+
+You should have received a copy of the GNU Lesser General Public License
+along with TerraLib. See COPYING. If not, write to
+TerraLib Team at <terralib-team@terralib.org>.
+*/
+
+
+/*!
+\file urban_analysis/src/growth/ResultCache.h
+
+\brief This file contains a persistent cache of the prepared rasters, addressed by the hash of everything that defines them
+*/
+
+#ifndef __URBANANALYSIS_INTERNAL_GROWTH_RESULTCACHE_H
+#define __URBANANALYSIS_INTERNAL_GROWTH_RESULTCACHE_H
+
+#include "Config.h"
+#include "Utils.h"
+
+//Boost
+#include <boost/cstdint.hpp>
+#include <boost/thread.hpp>
+
+#include <cstddef>
+#include <string>
+
+namespace te
+{
+  namespace urban
+  {
+    //!< Incrementally calculates a 64 bits FNV-1a hash of a sequence of values
+    class TEGROWTHEXPORT Hasher
+    {
+      public:
+
+        Hasher();
+
+        void add(const void* data, std::size_t size);
+
+        void add(const std::string& value);
+
+        void add(double value);
+
+        void add(boost::uint64_t value);
+
+        //!< Adds the entire content of the given file
+        void addFileContent(const std::string& fileName);
+
+        //!< Returns the hash as an hexadecimal string
+        std::string getHash() const;
+
+      protected:
+
+        boost::uint64_t m_hash;
+    };
+
+    /*!
+      \brief A directory with the urbanized area and urban footprint rasters of previous executions of prepareRaster, and their urban indexes.
+
+      Each entry is stored in a subdirectory named by its key, which is the hash of everything that defines the result: the content of the input file,
+      its remap, the classes, the radius, the grid and the version of the algorithms. A new entry is first written in a temporary directory, which is then
+      renamed, so an interrupted execution never leaves an incomplete entry. The rasters of an entry are native raster files, which are memory-mapped when
+      the entry is loaded. The cache can be shared by many threads.
+    */
+    class TEGROWTHEXPORT ResultCache
+    {
+      public:
+
+        explicit ResultCache(const std::string& directory);
+
+        ~ResultCache();
+
+        //!< Loads the entry of the given key into the given rasters and, if not null, indexes. Returns false if the cache has no entry for the key
+        bool load(const std::string& key, UrbanRasters& rasters, UrbanIndexes* urbanIndexes);
+
+        //!< Stores the given rasters and, if not null, indexes as the entry of the given key
+        void store(const std::string& key, const UrbanRasters& rasters, const UrbanIndexes* urbanIndexes);
+
+        //!< Logs the number of hits, misses and stored entries
+        void logStatistics();
+
+      protected:
+
+        std::string m_directory;
+
+        boost::mutex m_mutex;
+        std::size_t m_numHits;
+        std::size_t m_numMisses;
+        std::size_t m_numStoredEntries;
+        double m_loadSeconds; //!< the time spent loading the hits
+        double m_storeSeconds; //!< the time spent storing the new entries
+    };
+  }
+}
+
+#endif //__URBANANALYSIS_INTERNAL_GROWTH_RESULTCACHE_H
@@ -0,0 +1,469 @@
+/*  Copyright (C) 2011-2012 National Institute For Space Research (INPE) - Brazil.
+
+This file is part of the TerraLib - a Framework for building GIS enabled applications.
+
+TerraLib is free software: you can redistribute it and/or modify
+it under the terms of the GNU Lesser General Public License as published by
+the Free Software Foundation, either version 3 of the License,
+or (at your option) any later version.
+
+TerraLib is distributed in the hope that it will be useful,
+but WITHOUT ANY WARRANTY; without even the implied warranty of
+MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE. See the
+GNU Lesser General Public License for more details.
+
+You should have received a copy of the GNU Lesser General Public License
+along with TerraLib. See COPYING. If not, write to
+TerraLib Team at <terralib-team@terralib.org>.
+*/
+
+/*!
+\file urban_analysis/src/growth/SpanKernels.cpp
+
+\brief This file contains the scalar and the vectorized loops used to count the pixels of the mask spans
+*/
+
+#include "SpanKernels.h"
+#include "Neighborhood.h"
+
+#include <algorithm>
+
+#ifdef TEGROWTH_X86
+  #include <immintrin.h>
+  #ifdef _MSC_VER
+    #include <intrin.h>
+  #endif
+#endif
+
+//the vectorized functions are compiled for their instruction set even if the rest of the module is not
+#if defined(TEGROWTH_X86) && defined(__GNUC__)
+  #define TEGROWTH_TARGET(instructionSet) __attribute__((target(instructionSet)))
+#else
+  #define TEGROWTH_TARGET(instructionSet)
+#endif
+
+namespace te
+{
+  namespace urban
+  {
+    void accumulateWindowsScalar(const unsigned int* urbanWindowEnd, const unsigned int* urbanWindowStart,
+                                 const unsigned int* validWindowEnd, const unsigned int* validWindowStart,
+                                 std::size_t numColumns, unsigned int* urbanCount, unsigned int* validCount)
+    {
+      for (std::size_t column = 0; column < numColumns; ++column)
+      {
+        urbanCount[column] += urbanWindowEnd[column] - urbanWindowStart[column];
+        validCount[column] += validWindowEnd[column] - validWindowStart[column];
+      }
+    }
+
+    void countFlagsScalar(const unsigned char* flags, std::size_t numColumns, unsigned int& urbanCount, unsigned int& validCount)
+    {
+      for (std::size_t column = 0; column < numColumns; ++column)
+      {
+        urbanCount += (flags[column] & NEIGHBORHOOD_URBAN) ? 1 : 0;
+        validCount += (flags[column] & NEIGHBORHOOD_VALID) ? 1 : 0;
+      }
+    }
+
+    //!< Counts the bits of a word without any special instruction
+    struct PortablePopCount
+    {
+      unsigned int operator()(boost::uint64_t bits) const
+      {
+        bits -= (bits >> 1) & 0x5555555555555555ULL;
+        bits = (bits & 0x3333333333333333ULL) + ((bits >> 2) & 0x3333333333333333ULL);
+        bits = (bits + (bits >> 4)) & 0x0F0F0F0F0F0F0F0FULL;
+        return (unsigned int)((bits * 0x0101010101010101ULL) >> 56);
+      }
+    };
+
+    //!< Returns the number of bits set before the given bit of the row
+    template<class PopCount> inline unsigned int getBitRank(const PackedBitRow& bitRow, std::size_t bit, const PopCount& popCount)
+    {
+      std::size_t word = bit >> 6;
+      boost::uint64_t mask = (((boost::uint64_t)1) << (bit & 63)) - 1;
+
+      return bitRow.m_ranks[word] + popCount(bitRow.m_words[word] & mask);
+    }
+
+    template<class PopCount> inline void accumulateBitWindows(const PackedBitRow& urbanRow, const PackedBitRow& validRow, int numColumns, int columnStart, int columnEnd,
+                                                              unsigned int* urbanCount, unsigned int* validCount, const PopCount& popCount)
+    {
+      //the count of a window is the difference between the ranks of the bit after its end and of its first bit. The windows of the columns in [interiorFirst, interiorLast) are not clipped
+      int interiorFirst = std::min(std::max(-columnStart, 0), numColumns);
+      int interiorLast = std::max(std::min(numColumns - columnEnd, numColumns), interiorFirst);
+
+      for (int column = interiorFirst; column < interiorLast; ++column)
+      {
+        std::size_t first = (std::size_t)(column + columnStart);
+        std::size_t end = (std::size_t)(column + columnEnd + 1);
+
+        urbanCount[column] += getBitRank(urbanRow, end, popCount) - getBitRank(urbanRow, first, popCount);
+        validCount[column] += getBitRank(validRow, end, popCount) - getBitRank(validRow, first, popCount);
+      }
+
+      for (int column = 0; column < numColumns; ++column)
+      {
+        if (column == interiorFirst)
+        {
+          column = interiorLast;
+          if (column >= numColumns)
+          {
+            break;
+          }
+        }
+
+        int first = std::max(column + columnStart, 0);
+        int end = std::min(column + columnEnd + 1, numColumns);
+        if (first >= end)
+        {
+          continue;
+        }
+
+        urbanCount[column] += getBitRank(urbanRow, (std::size_t)end, popCount) - getBitRank(urbanRow, (std::size_t)first, popCount);
+        validCount[column] += getBitRank(validRow, (std::size_t)end, popCount) - getBitRank(validRow, (std::size_t)first, popCount);
+      }
+    }
+
+    void accumulateBitWindowsScalar(const PackedBitRow& urbanRow, const PackedBitRow& validRow, int numColumns, int columnStart, int columnEnd,
+                                    unsigned int* urbanCount, unsigned int* validCount)
+    {
+      accumulateBitWindows(urbanRow, validRow, numColumns, columnStart, columnEnd, urbanCount, validCount, PortablePopCount());
+    }
+
+    //!< Sets the edge bits of the columns [firstColumn, lastColumn) of the row
+    inline void calculateEdgeBitRange(const unsigned char* previousFlags, const unsigned char* flags, const unsigned char* nextFlags, std::size_t numColumns,
+                                      std::size_t firstColumn, std::size_t lastColumn, boost::uint64_t* edgeBits)
+    {
+      for (std::size_t column = firstColumn; column < lastColumn; ++column)
+      {
+        if ((flags[column] & NEIGHBORHOOD_URBAN) == 0)
+        {
+          continue;
+        }
+
+        if ((previousFlags != 0 && (previousFlags[column] & NEIGHBORHOOD_URBAN) == 0) ||
+            (column > 0 && (flags[column - 1] & NEIGHBORHOOD_URBAN) == 0) ||
+            (nextFlags != 0 && (nextFlags[column] & NEIGHBORHOOD_URBAN) == 0) ||
+            (column + 1 < numColumns && (flags[column + 1] & NEIGHBORHOOD_URBAN) == 0))
+        {
+          edgeBits[column >> 6] |= ((boost::uint64_t)1) << (column & 63);
+        }
+      }
+    }
+
+    void calculateEdgeBitsScalar(const unsigned char* previousFlags, const unsigned char* flags, const unsigned char* nextFlags, std::size_t numColumns, boost::uint64_t* edgeBits)
+    {
+      calculateEdgeBitRange(previousFlags, flags, nextFlags, numColumns, 0, numColumns, edgeBits);
+    }
+
+    std::size_t countCommonBitsScalar(const boost::uint64_t* bits, const boost::uint64_t* otherBits, std::size_t numWords)
+    {
+      PortablePopCount popCount;
+
+      std::size_t count = 0;
+      for (std::size_t word = 0; word < numWords; ++word)
+      {
+        count += popCount(bits[word] & otherBits[word]);
+      }
+      return count;
+    }
+
+#ifdef TEGROWTH_X86
+
+    //!< Counts the bits of a word with the popcnt instruction. It is only used by the AVX2 kernels, which also require it
+    struct HardwarePopCount
+    {
+      unsigned int operator()(boost::uint64_t bits) const
+      {
+#if defined(_MSC_VER) && defined(_M_X64)
+        return (unsigned int)__popcnt64(bits);
+#elif defined(_MSC_VER)
+        return (unsigned int)(__popcnt((unsigned int)bits) + __popcnt((unsigned int)(bits >> 32)));
+#else
+        return (unsigned int)__builtin_popcountll(bits);
+#endif
+      }
+    };
+
+    TEGROWTH_TARGET("sse2")
+    void accumulateWindowsSSE2(const unsigned int* urbanWindowEnd, const unsigned int* urbanWindowStart,
+                               const unsigned int* validWindowEnd, const unsigned int* validWindowStart,
+                               std::size_t numColumns, unsigned int* urbanCount, unsigned int* validCount)
+    {
+      //4 columns at a time
+      std::size_t column = 0;
+      for (; column + 4 <= numColumns; column += 4)
+      {
+        __m128i urbanWindow = _mm_sub_epi32(_mm_loadu_si128((const __m128i*)(urbanWindowEnd + column)), _mm_loadu_si128((const __m128i*)(urbanWindowStart + column)));
+        __m128i validWindow = _mm_sub_epi32(_mm_loadu_si128((const __m128i*)(validWindowEnd + column)), _mm_loadu_si128((const __m128i*)(validWindowStart + column)));
+
+        _mm_storeu_si128((__m128i*)(urbanCount + column), _mm_add_epi32(_mm_loadu_si128((const __m128i*)(urbanCount + column)), urbanWindow));
+        _mm_storeu_si128((__m128i*)(validCount + column), _mm_add_epi32(_mm_loadu_si128((const __m128i*)(validCount + column)), validWindow));
+      }
+
+      accumulateWindowsScalar(urbanWindowEnd + column, urbanWindowStart + column, validWindowEnd + column, validWindowStart + column,
+                              numColumns - column, urbanCount + column, validCount + column);
+    }
+
+    TEGROWTH_TARGET("sse2")
+    void countFlagsSSE2(const unsigned char* flags, std::size_t numColumns, unsigned int& urbanCount, unsigned int& validCount)
+    {
+      const __m128i zero = _mm_setzero_si128();
+      const __m128i urbanMask = _mm_set1_epi8((char)NEIGHBORHOOD_URBAN);
+      const __m128i validMask = _mm_set1_epi8((char)NEIGHBORHOOD_VALID);
+
+      //16 flags at a time. The masked flags are summed horizontally by the sum of absolute differences against zero
+      __m128i urbanSum = zero;
+      __m128i validSum = zero;
+
+      std::size_t column = 0;
+      for (; column + 16 <= numColumns; column += 16)
+      {
+        __m128i values = _mm_loadu_si128((const __m128i*)(flags + column));
+
+        urbanSum = _mm_add_epi64(urbanSum, _mm_sad_epu8(_mm_and_si128(values, urbanMask), zero));
+        validSum = _mm_add_epi64(validSum, _mm_sad_epu8(_mm_and_si128(values, validMask), zero));
+      }
+
+      urbanSum = _mm_add_epi64(urbanSum, _mm_unpackhi_epi64(urbanSum, urbanSum));
+      validSum = _mm_add_epi64(validSum, _mm_unpackhi_epi64(validSum, validSum));
+
+      //each masked urban flag adds NEIGHBORHOOD_URBAN to the sum, so the sum is divided by it
+
+      urbanCount += (unsigned int)_mm_cvtsi128_si32(urbanSum) / NEIGHBORHOOD_URBAN;
+      validCount += (unsigned int)_mm_cvtsi128_si32(validSum) / NEIGHBORHOOD_VALID;
+
+      countFlagsScalar(flags + column, numColumns - column, urbanCount, validCount);
+    }
+
+    TEGROWTH_TARGET("sse2")
+    void calculateEdgeBitsSSE2(const unsigned char* previousFlags, const unsigned char* flags, const unsigned char* nextFlags, std::size_t numColumns, boost::uint64_t* edgeBits)
+    {
+      //a missing row is replaced by the row itself, as the urban centers are never edges because of their own column
+      const unsigned char* above = (previousFlags != 0) ? previousFlags : flags;
+      const unsigned char* below = (nextFlags != 0) ? nextFlags : flags;
+
+      const __m128i urbanMask = _mm_set1_epi8((char)NEIGHBORHOOD_URBAN);
+
+      //16 columns at a time, aligned to 16 so the bits of a block never cross a word. The first block and the last columns read outside the row and are done by the scalar code
+      std::size_t column = 16;
+      for (; column + 17 <= numColumns; column += 16)
+      {
+        __m128i center = _mm_and_si128(_mm_loadu_si128((const __m128i*)(flags + column)), urbanMask);
+        __m128i left = _mm_loadu_si128((const __m128i*)(flags + column - 1));
+        __m128i right = _mm_loadu_si128((const __m128i*)(flags + column + 1));
+        __m128i up = _mm_loadu_si128((const __m128i*)(above + column));
+        __m128i down = _mm_loadu_si128((const __m128i*)(below + column));
+
+        //the urban centers whose neighbors are not all urban
+        __m128i neighbors = _mm_and_si128(_mm_and_si128(left, right), _mm_and_si128(up, down));
+        __m128i edges = _mm_andnot_si128(neighbors, center);
+
+        unsigned int bits = (unsigned int)_mm_movemask_epi8(_mm_cmpeq_epi8(edges, urbanMask));
+        edgeBits[column >> 6] |= ((boost::uint64_t)bits) << (column & 63);
+      }
+
+      calculateEdgeBitRange(previousFlags, flags, nextFlags, numColumns, 0, std::min(numColumns, (std::size_t)16), edgeBits);
+      calculateEdgeBitRange(previousFlags, flags, nextFlags, numColumns, std::max(column, (std::size_t)16), numColumns, edgeBits);
+    }
+
+    TEGROWTH_TARGET("avx2")
+    void accumulateWindowsAVX2(const unsigned int* urbanWindowEnd, const unsigned int* urbanWindowStart,
+                               const unsigned int* validWindowEnd, const unsigned int* validWindowStart,
+                               std::size_t numColumns, unsigned int* urbanCount, unsigned int* validCount)
+    {
+      //8 columns at a time
+      std::size_t column = 0;
+      for (; column + 8 <= numColumns; column += 8)
+      {
+        __m256i urbanWindow = _mm256_sub_epi32(_mm256_loadu_si256((const __m256i*)(urbanWindowEnd + column)), _mm256_loadu_si256((const __m256i*)(urbanWindowStart + column)));
+        __m256i validWindow = _mm256_sub_epi32(_mm256_loadu_si256((const __m256i*)(validWindowEnd + column)), _mm256_loadu_si256((const __m256i*)(validWindowStart + column)));
+
+        _mm256_storeu_si256((__m256i*)(urbanCount + column), _mm256_add_epi32(_mm256_loadu_si256((const __m256i*)(urbanCount + column)), urbanWindow));
+        _mm256_storeu_si256((__m256i*)(validCount + column), _mm256_add_epi32(_mm256_loadu_si256((const __m256i*)(validCount + column)), validWindow));
+      }
+
+      accumulateWindowsScalar(urbanWindowEnd + column, urbanWindowStart + column, validWindowEnd + column, validWindowStart + column,
+                              numColumns - column, urbanCount + column, validCount + column);
+    }
+
+    TEGROWTH_TARGET("avx2")
+    void countFlagsAVX2(const unsigned char* flags, std::size_t numColumns, unsigned int& urbanCount, unsigned int& validCount)
+    {
+      const __m256i zero = _mm256_setzero_si256();
+      const __m256i urbanMask = _mm256_set1_epi8((char)NEIGHBORHOOD_URBAN);
+      const __m256i validMask = _mm256_set1_epi8((char)NEIGHBORHOOD_VALID);
+
+      //32 flags at a time
+      __m256i urbanSum = zero;
+      __m256i validSum = zero;
+
+      std::size_t column = 0;
+      for (; column + 32 <= numColumns; column += 32)
+      {
+        __m256i values = _mm256_loadu_si256((const __m256i*)(flags + column));
+
+        urbanSum = _mm256_add_epi64(urbanSum, _mm256_sad_epu8(_mm256_and_si256(values, urbanMask), zero));
+        validSum = _mm256_add_epi64(validSum, _mm256_sad_epu8(_mm256_and_si256(values, validMask), zero));
+      }
+
+      __m128i urbanHalf = _mm_add_epi64(_mm256_castsi256_si128(urbanSum), _mm256_extracti128_si256(urbanSum, 1));
+      __m128i validHalf = _mm_add_epi64(_mm256_castsi256_si128(validSum), _mm256_extracti128_si256(validSum, 1));
+
+      urbanHalf = _mm_add_epi64(urbanHalf, _mm_unpackhi_epi64(urbanHalf, urbanHalf));
+      validHalf = _mm_add_epi64(validHalf, _mm_unpackhi_epi64(validHalf, validHalf));
+
+      urbanCount += (unsigned int)_mm_cvtsi128_si32(urbanHalf) / NEIGHBORHOOD_URBAN;
+      validCount += (unsigned int)_mm_cvtsi128_si32(validHalf) / NEIGHBORHOOD_VALID;
+
+      countFlagsScalar(flags + column, numColumns - column, urbanCount, validCount);
+    }
+
+    TEGROWTH_TARGET("avx2,popcnt")
+    void accumulateBitWindowsAVX2(const PackedBitRow& urbanRow, const PackedBitRow& validRow, int numColumns, int columnStart, int columnEnd,
+                                  unsigned int* urbanCount, unsigned int* validCount)
+    {
+      accumulateBitWindows(urbanRow, validRow, numColumns, columnStart, columnEnd, urbanCount, validCount, HardwarePopCount());
+    }
+
+    TEGROWTH_TARGET("avx2")
+    void calculateEdgeBitsAVX2(const unsigned char* previousFlags, const unsigned char* flags, const unsigned char* nextFlags, std::size_t numColumns, boost::uint64_t* edgeBits)
+    {
+      const unsigned char* above = (previousFlags != 0) ? previousFlags : flags;
+      const unsigned char* below = (nextFlags != 0) ? nextFlags : flags;
+
+      const __m256i urbanMask = _mm256_set1_epi8((char)NEIGHBORHOOD_URBAN);
+
+      //32 columns at a time
+      std::size_t column = 32;
+      for (; column + 33 <= numColumns; column += 32)
+      {
+        __m256i center = _mm256_and_si256(_mm256_loadu_si256((const __m256i*)(flags + column)), urbanMask);
+        __m256i left = _mm256_loadu_si256((const __m256i*)(flags + column - 1));
+        __m256i right = _mm256_loadu_si256((const __m256i*)(flags + column + 1));
+        __m256i up = _mm256_loadu_si256((const __m256i*)(above + column));
+        __m256i down = _mm256_loadu_si256((const __m256i*)(below + column));
+
+        __m256i neighbors = _mm256_and_si256(_mm256_and_si256(left, right), _mm256_and_si256(up, down));
+        __m256i edges = _mm256_andnot_si256(neighbors, center);
+
+        unsigned int bits = (unsigned int)_mm256_movemask_epi8(_mm256_cmpeq_epi8(edges, urbanMask));
+        edgeBits[column >> 6] |= ((boost::uint64_t)bits) << (column & 63);
+      }
+
+      calculateEdgeBitRange(previousFlags, flags, nextFlags, numColumns, 0, std::min(numColumns, (std::size_t)32), edgeBits);
+      calculateEdgeBitRange(previousFlags, flags, nextFlags, numColumns, std::max(column, (std::size_t)32), numColumns, edgeBits);
+    }
+
+    TEGROWTH_TARGET("avx2,popcnt")
+    std::size_t countCommonBitsAVX2(const boost::uint64_t* bits, const boost::uint64_t* otherBits, std::size_t numWords)
+    {
+      HardwarePopCount popCount;
+
+      std::size_t count = 0;
+      for (std::size_t word = 0; word < numWords; ++word)
+      {
+        count += popCount(bits[word] & otherBits[word]);
+      }
+      return count;
+    }
+
+    SpanInstructionSet detectSpanInstructionSet()
+    {
+#ifdef _MSC_VER
+      int info[4];
+      __cpuid(info, 0);
+      int maxLeaf = info[0];
+
+      __cpuid(info, 1);
+      bool sse2 = (info[3] & (1 << 26)) != 0;
+      bool osxsave = (info[2] & (1 << 27)) != 0;
+      bool avx = (info[2] & (1 << 28)) != 0;
+      bool popcnt = (info[2] & (1 << 23)) != 0;
+
+      //the operating system must save the ymm registers
+      bool avxEnabled = osxsave && avx && ((_xgetbv(0) & 6) == 6);
+
+      bool avx2 = false;
+      if (avxEnabled && maxLeaf >= 7)
+      {
+        __cpuidex(info, 7, 0);
+        avx2 = popcnt && (info[1] & (1 << 5)) != 0;
+      }
+#else
+      __builtin_cpu_init();
+      bool sse2 = __builtin_cpu_supports("sse2") != 0;
+      bool avx2 = __builtin_cpu_supports("avx2") != 0 && __builtin_cpu_supports("popcnt") != 0;
+#endif
+
+      if (avx2)
+      {
+        return SPAN_AVX2;
+      }
+      if (sse2)
+      {
+        return SPAN_SSE2;
+      }
+      return SPAN_SCALAR;
+    }
+
+#else
+
+    SpanInstructionSet detectSpanInstructionSet()
+    {
+      return SPAN_SCALAR;
+    }
+
+#endif //TEGROWTH_X86
+  }
+}
+
+te::urban::SpanInstructionSet te::urban::getSupportedSpanInstructionSet()
+{
+  static const SpanInstructionSet supportedInstructionSet = detectSpanInstructionSet();
+
+  return supportedInstructionSet;
+}
+
+const te::urban::SpanKernels& te::urban::getSpanKernels(SpanInstructionSet instructionSet)
+{
+  static const SpanKernels scalarKernels = { SPAN_SCALAR, &accumulateWindowsScalar, &countFlagsScalar, &accumulateBitWindowsScalar, &calculateEdgeBitsScalar, &countCommonBitsScalar };
+#ifdef TEGROWTH_X86
+  static const SpanKernels sse2Kernels = { SPAN_SSE2, &accumulateWindowsSSE2, &countFlagsSSE2, &accumulateBitWindowsScalar, &calculateEdgeBitsSSE2, &countCommonBitsScalar };
+  static const SpanKernels avx2Kernels = { SPAN_AVX2, &accumulateWindowsAVX2, &countFlagsAVX2, &accumulateBitWindowsAVX2, &calculateEdgeBitsAVX2, &countCommonBitsAVX2 };
+#endif
+
+  if (instructionSet > getSupportedSpanInstructionSet())
+  {
+    instructionSet = getSupportedSpanInstructionSet();
+  }
+
+  switch (instructionSet)
+  {
+#ifdef TEGROWTH_X86
+    case SPAN_AVX2:
+      return avx2Kernels;
+    case SPAN_SSE2:
+      return sse2Kernels;
+#endif
+    default:
+      return scalarKernels;
+  }
+}
+
+std::string te::urban::getSpanInstructionSetName(SpanInstructionSet instructionSet)
+{
+  switch (instructionSet)
+  {
+    case SPAN_SCALAR:
+      return "scalar";
+    case SPAN_SSE2:
+      return "sse2";
+    case SPAN_AVX2:
+      return "avx2";
+  }
+
+  return "unknown";
+}
@@ -0,0 +1,93 @@
+/*  Copyright (C) 2011-2012 National Institute For Space Research (INPE) - Brazil.
+
+This file is part of the TerraLib - a Framework for building GIS enabled applications.
+
+TerraLib is free software: you can redistribute it and/or modify
+it under the terms of the GNU Lesser General Public License as published by
+the Free Software Foundation, either version 3 of the License,
+or (at your option) any later version.
+
+TerraLib is distributed in the hope that it will be useful,
+but WITHOUT ANY WARRANTY; without even the implied warranty of
+MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE. See the
+GNU Lesser General Public License for more details.
+
+You should have received a copy of the GNU Lesser General Public License
+along with TerraLib. See COPYING. If not, write to
+TerraLib Team at <terralib-team@terralib.org>.
+*/
+
+/*!
+\file urban_analysis/src/growth/SpanKernels.h
+
+\brief This file contains the scalar and the vectorized loops used to count the pixels of the mask spans
+*/
+
+#ifndef __URBANANALYSIS_INTERNAL_GROWTH_SPANKERNELS_H
+#define __URBANANALYSIS_INTERNAL_GROWTH_SPANKERNELS_H
+
+#include "Config.h"
+
+#include <boost/cstdint.hpp>
+
+#include <cstddef>
+#include <string>
+
+namespace te
+{
+  namespace urban
+  {
+    //!< The instruction sets that can be used by the span kernels. They are ordered from the slowest to the fastest
+    enum SpanInstructionSet
+    {
+      SPAN_SCALAR, SPAN_SSE2, SPAN_AVX2
+    };
+
+    //!< Adds (windowEnd[i] - windowStart[i]) to the urban and to the valid counts of each of the numColumns columns
+    typedef void (*AccumulateWindowsFunction)(const unsigned int* urbanWindowEnd, const unsigned int* urbanWindowStart,
+                                              const unsigned int* validWindowEnd, const unsigned int* validWindowStart,
+                                              std::size_t numColumns, unsigned int* urbanCount, unsigned int* validCount);
+
+    //!< Adds to the given counts the number of urban and valid flags in the numColumns flags
+    typedef void (*CountFlagsFunction)(const unsigned char* flags, std::size_t numColumns, unsigned int& urbanCount, unsigned int& validCount);
+
+    //!< A row of bits, one per pixel, and the number of bits set before each of its words. The row must have one padding word after its last column
+    struct PackedBitRow
+    {
+      const boost::uint64_t* m_words;
+      const unsigned int* m_ranks;
+    };
+
+    //!< Adds to the counts of each of the numColumns columns the number of urban and valid bits in the window [column + columnStart, column + columnEnd], clipped to the row
+    typedef void (*AccumulateBitWindowsFunction)(const PackedBitRow& urbanRow, const PackedBitRow& validRow, int numColumns, int columnStart, int columnEnd,
+                                                 unsigned int* urbanCount, unsigned int* validCount);
+
+    //!< Sets in edgeBits the urban pixels of the row that have a not urban pixel in their 4-neighborhood. The pixels outside the raster are not considered, so the previous or the next row may be null
+    typedef void (*CalculateEdgeBitsFunction)(const unsigned char* previousFlags, const unsigned char* flags, const unsigned char* nextFlags, std::size_t numColumns, boost::uint64_t* edgeBits);
+
+    //!< Returns the number of bits set in both of the given rows of numWords words
+    typedef std::size_t (*CountCommonBitsFunction)(const boost::uint64_t* bits, const boost::uint64_t* otherBits, std::size_t numWords);
+
+    //!< The span kernels of one instruction set
+    struct SpanKernels
+    {
+      SpanInstructionSet m_instructionSet;
+      AccumulateWindowsFunction m_accumulateWindows;
+      CountFlagsFunction m_countFlags;
+      AccumulateBitWindowsFunction m_accumulateBitWindows;
+      CalculateEdgeBitsFunction m_calculateEdgeBits;
+      CountCommonBitsFunction m_countCommonBits;
+    };
+
+    //!< Returns the fastest instruction set supported by the processor and by the operating system. It is detected only once
+    TEGROWTHEXPORT SpanInstructionSet getSupportedSpanInstructionSet();
+
+    //!< Returns the kernels of the given instruction set. If the processor does not support it, the fastest supported one is returned
+    TEGROWTHEXPORT const SpanKernels& getSpanKernels(SpanInstructionSet instructionSet);
+
+    //!< Gets the name of the given instruction set, to be used in the log messages
+    TEGROWTHEXPORT std::string getSpanInstructionSetName(SpanInstructionSet instructionSet);
+  }
+}
+
+#endif //__URBANANALYSIS_INTERNAL_GROWTH_SPANKERNELS_H
@@ -25,6 +25,7 @@ TerraLib Team at <terralib-team@terralib.org>.
 
 #include "SprawlMetrics.h"
 
+#include "PixelPlane.h"
 #include "Utils.h"
 #include "Statistics.h"
 
@@ -91,42 +92,56 @@ te::urban::UrbanIndexes te::urban::calculateProximityIndex(te::rst::Raster* urba
   std::vector<double> urbanAreaDistanceVec;
   std::vector<double> nonUrbanAreaDistanceVec;
 
-  for (std::size_t currentRow = 0; currentRow < numRows; ++currentRow)
-  {
-    for (std::size_t currentColumn = 0; currentColumn < numColumns; ++currentColumn)
-    {
-      te::gm::Coord2D currentCoord = urbanRaster->getGrid()->gridToGeo((double)currentColumn, (double)currentRow);
-      double distanceToCBD = TeDistance(currentCoord, centroidCBD);
-      double distanceToCentroidUrban = TeDistance(currentCoord, centroidUrban);
+  std::size_t stripNumRows = getStripNumberOfRows(urbanRaster);
 
-      double urbanValue = 0.;
-      urbanRaster->getValue((unsigned int)currentColumn, (unsigned int)currentRow, urbanValue);
+  //the rasters hold classes, which fit a byte
+  PixelPlane<unsigned char> urbanStrip;
+  PixelPlane<unsigned char> landCoverStrip;
+  PixelPlane<unsigned char> slopeStrip;
 
-      double landCoverValue = 0.;
-      landCoverRaster->getValue((unsigned int)currentColumn, (unsigned int)currentRow, landCoverValue);
+  for (std::size_t stripFirstRow = 0; stripFirstRow < numRows; stripFirstRow += stripNumRows)
+  {
+    urbanStrip.read(urbanRaster, 0, stripFirstRow, stripNumRows);
+    landCoverStrip.read(landCoverRaster, 0, stripFirstRow, stripNumRows);
+    slopeStrip.read(slopeRaster, 0, stripFirstRow, stripNumRows);
 
-      double slopeValue = 0.;
-      slopeRaster->getValue((unsigned int)currentColumn, (unsigned int)currentRow, landCoverValue);
+    for (std::size_t row = 0; row < urbanStrip.getNumberOfRows(); ++row)
+    {
+      std::size_t currentRow = stripFirstRow + row;
+      const unsigned char* urbanValues = urbanStrip.getRow(row);
+      const unsigned char* landCoverValues = landCoverStrip.getRow(row);
+      const unsigned char* slopeValues = slopeStrip.getRow(row);
 
-      if (urbanValue == OUTPUT_URBAN || urbanValue == OUTPUT_SUB_URBAN, urbanValue == OUTPUT_URBANIZED_OS || urbanValue == OUTPUT_SUBURBAN_ZONE_OPEN_AREA)
+      for (std::size_t currentColumn = 0; currentColumn < numColumns; ++currentColumn)
       {
-        if (slopeValue == 0.)
+        te::gm::Coord2D currentCoord = urbanRaster->getGrid()->gridToGeo((double)currentColumn, (double)currentRow);
+        double distanceToCBD = TeDistance(currentCoord, centroidCBD);
+        double distanceToCentroidUrban = TeDistance(currentCoord, centroidUrban);
+
+        unsigned char urbanValue = urbanValues[currentColumn];
+        unsigned char landCoverValue = landCoverValues[currentColumn];
+        unsigned char slopeValue = slopeValues[currentColumn];
+
+        if (urbanValue == OUTPUT_URBAN || urbanValue == OUTPUT_SUB_URBAN || urbanValue == OUTPUT_URBANIZED_OS || urbanValue == OUTPUT_SUBURBAN_ZONE_OPEN_AREA)
         {
-          urbanAreaDistanceVec.push_back(distanceToCBD);
-        }
+          if (slopeValue == 0)
+          {
+            urbanAreaDistanceVec.push_back(distanceToCBD);
+          }
 
-        sumDistance += distanceToCBD;
-        sumDistanceSquare += (distanceToCentroidUrban * distanceToCentroidUrban);
-        ++count;
+          sumDistance += distanceToCBD;
+          sumDistanceSquare += (distanceToCentroidUrban * distanceToCentroidUrban);
+          ++count;
 
-        if (distanceToCBD <= radius)
-          ++in_EAC;
-      }
-      else if (landCoverValue == INPUT_WATER || landCoverValue == INPUT_OTHER)
-      {
-        if (slopeValue == 0.)
+          if (distanceToCBD <= radius)
+            ++in_EAC;
+        }
+        else if (landCoverValue == INPUT_WATER || landCoverValue == INPUT_OTHER)
         {
-          nonUrbanAreaDistanceVec.push_back(distanceToCBD);
+          if (slopeValue == 0)
+          {
+            nonUrbanAreaDistanceVec.push_back(distanceToCBD);
+          }
         }
       }
     }
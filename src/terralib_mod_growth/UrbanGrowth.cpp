@@ -24,6 +24,11 @@ TerraLib Team at <terralib-team@terralib.org>.
 */
 
 #include "UrbanGrowth.h"
+#include "Dilation.h"
+#include "Neighborhood.h"
+#include "PixelPlane.h"
+#include "RasterWriter.h"
+#include "ResultCache.h"
 #include "Utils.h"
 
 //Terralib
@@ -35,6 +40,10 @@ TerraLib Team at <terralib-team@terralib.org>.
 
 #include <boost/lexical_cast.hpp>
 
+#include <algorithm>
+#include <limits>
+#include <set>
+
 
 void te::urban::classifyUrbanizedArea(ClassifyParams* params)
 {
@@ -45,67 +54,84 @@ void te::urban::classifyUrbanizedArea(ClassifyParams* params)
   te::rst::Raster* inputRaster = params->m_inputRaster;
   InputClassesMap inputClassesMap = params->m_inputClassesMap;
   double radius = params->m_radius;
+  std::size_t numberOfThreads = getNumberOfThreads(params->m_numberOfThreads);
 
   std::auto_ptr<te::rst::Raster> outputRaster = cloneRasterIntoMem(inputRaster, false);
 
   assert(outputRaster.get());
 
-  const short InputWater = inputClassesMap.find(INPUT_WATER)->second;
-  const short InputUrban = inputClassesMap.find(INPUT_URBAN)->second;
-  const short InputOther = inputClassesMap.find(INPUT_OTHER)->second;
-
   unsigned int numRows = inputRaster->getNumberOfRows();
   unsigned int numColumns = inputRaster->getNumberOfColumns();
   double resX = inputRaster->getResolutionX();
-  double resY = inputRaster->getResolutionY();
-
-  int  maskSizeInPixels = te::rst::Round(radius / resX);
 
   boost::numeric::ublas::matrix<bool> mask = createRadiusMask(resX, radius);
+  std::vector<MaskSpan> vecSpans = createMaskSpans(mask);
+  NeighborhoodKernel kernel = selectNeighborhoodKernel(params->m_kernel, vecSpans);
 
-  te::common::TaskProgress task("Classify Urbanized Area");
-  task.setTotalSteps((int)(numRows * numColumns));
-  task.useTimer(true);
+  //the input is read only once. The neighborhood of each pixel is then counted by the selected kernel, one band of rows for each thread
+  NeighborhoodPlane plane;
+  createNeighborhoodPlane(inputRaster, inputClassesMap, plane);
+  prepareNeighborhoodPlane(kernel, plane);
 
-  std::vector<double> vecPixels;
+  PixelPlane<unsigned char> urbanizedPlane(numRows, numColumns, OUTPUT_NO_DATA);
 
-  for (std::size_t currentRow = 0; currentRow < numRows; ++currentRow)
-  {
-    for (std::size_t currentColumn = 0; currentColumn < numColumns; ++currentColumn)
-    {
-      //gets the value of the current center pixel
-      double centerPixel = 0;
-      inputRaster->getValue((unsigned int)currentColumn, (unsigned int)currentRow, centerPixel);
+  UrbanAreasRowClassifier classifier(inputClassesMap, numColumns, urbanizedPlane.getRow(0), 0, 0);
+  SpanInstructionSet instructionSet = classifyNeighborhoodRows(plane, vecSpans, kernel, numberOfThreads, classifier, "Classify Urbanized Area");
 
-      double value = OUTPUT_NO_DATA;
+  urbanizedPlane.write(outputRaster.get());
 
-      //WATER
-      if (centerPixel == InputWater)
-      {
-        value = OUTPUT_WATER;
-      }
-      else if (centerPixel == InputUrban || centerPixel == InputOther)
-      {
-        //gets the pixels surrounding pixels that intersects the given radious
-        vecPixels.clear();
-         getPixelsWithinRadious(inputRaster, currentRow, currentColumn, radius, mask, vecPixels);
+  params->m_outputRaster.reset(outputRaster.release());
 
-        double permUrb = 0.;
-        value = calculateUrbanizedArea((short)centerPixel, inputClassesMap, vecPixels, permUrb);
-      }
+  std::string message = "classifyUrbanizedArea for  " + inputRaster->getInfo()["URI"] + " executed in " + boost::lexical_cast<std::string>(timer.getElapsedTimeMinutes()) + " minutes";
+  message += " (" + getNeighborhoodKernelName(kernel, instructionSet) + ", " + boost::lexical_cast<std::string>(numberOfThreads) + " threads, " + boost::lexical_cast<std::string>((std::size_t)timer.getPixelsPerSecond((std::size_t)numRows * numColumns)) + " pixels/second)";
 
-      outputRaster->setValue((unsigned int)currentColumn, (unsigned int)currentRow, value, 0);
+  logInfo(message);
+}
 
-      task.pulse();
-    }
-  }
+void te::urban::classifyUrbanFootprint(ClassifyParams* params)
+{
+  assert(params);
+
+  Timer timer;
+
+  te::rst::Raster* inputRaster = params->m_inputRaster;
+  InputClassesMap inputClassesMap = params->m_inputClassesMap;
+  double radius = params->m_radius;
+  std::size_t numberOfThreads = getNumberOfThreads(params->m_numberOfThreads);
+
+  std::auto_ptr<te::rst::Raster> outputRaster = cloneRasterIntoMem(inputRaster, false);
+
+  assert(outputRaster.get());
+
+  unsigned int numRows = inputRaster->getNumberOfRows();
+  unsigned int numColumns = inputRaster->getNumberOfColumns();
+  double resX = inputRaster->getResolutionX();
+
+  boost::numeric::ublas::matrix<bool> mask = createRadiusMask(resX, radius);
+  std::vector<MaskSpan> vecSpans = createMaskSpans(mask);
+  NeighborhoodKernel kernel = selectNeighborhoodKernel(params->m_kernel, vecSpans);
+
+  //the input is read only once. The neighborhood of each pixel is then counted by the selected kernel, one band of rows for each thread
+  NeighborhoodPlane plane;
+  createNeighborhoodPlane(inputRaster, inputClassesMap, plane);
+  prepareNeighborhoodPlane(kernel, plane);
+
+  PixelPlane<unsigned char> footprintPlane(numRows, numColumns, OUTPUT_NO_DATA);
+
+  UrbanAreasRowClassifier classifier(inputClassesMap, numColumns, 0, footprintPlane.getRow(0), 0);
+  SpanInstructionSet instructionSet = classifyNeighborhoodRows(plane, vecSpans, kernel, numberOfThreads, classifier, "Classify Urbanized Footprint");
+
+  footprintPlane.write(outputRaster.get());
 
   params->m_outputRaster.reset(outputRaster.release());
 
-  logInfo("classifyUrbanizedArea for  " + inputRaster->getInfo()["URI"] + " executed in " + boost::lexical_cast<std::string>(timer.getElapsedTimeMinutes()) + " minutes");
+  std::string message = "classifyUrbanFootprint for  " + inputRaster->getInfo()["URI"] + " executed in " + boost::lexical_cast<std::string>(timer.getElapsedTimeMinutes()) + " minutes";
+  message += " (" + getNeighborhoodKernelName(kernel, instructionSet) + ", " + boost::lexical_cast<std::string>(numberOfThreads) + " threads, " + boost::lexical_cast<std::string>((std::size_t)timer.getPixelsPerSecond((std::size_t)numRows * numColumns)) + " pixels/second)";
+
+  logInfo(message);
 }
 
-void te::urban::classifyUrbanFootprint(ClassifyParams* params)
+void te::urban::classifyUrbanizedAreaAndFootprint(ClassifyUrbanAreasParams* params)
 {
   assert(params);
 
@@ -114,116 +140,444 @@ void te::urban::classifyUrbanFootprint(ClassifyParams* params)
   te::rst::Raster* inputRaster = params->m_inputRaster;
   InputClassesMap inputClassesMap = params->m_inputClassesMap;
   double radius = params->m_radius;
+  bool calculatePermUrb = params->m_calculatePermUrb;
+  std::size_t numberOfThreads = getNumberOfThreads(params->m_numberOfThreads);
 
-  std::auto_ptr<te::rst::Raster> outputRaster = cloneRasterIntoMem(inputRaster, false);
+  std::auto_ptr<te::rst::Raster> urbanizedRaster = cloneRasterIntoMem(inputRaster, false);
+  std::auto_ptr<te::rst::Raster> footprintRaster = cloneRasterIntoMem(inputRaster, false);
 
-  assert(outputRaster.get());
+  assert(urbanizedRaster.get());
+  assert(footprintRaster.get());
 
-  const short InputWater = inputClassesMap.find(INPUT_WATER)->second;
-  const short InputUrban = inputClassesMap.find(INPUT_URBAN)->second;
-  const short InputOther = inputClassesMap.find(INPUT_OTHER)->second;
+  //the urban percentage is only defined where the neighborhood has valid pixels. In the other pixels we set -1 as no data
+  std::auto_ptr<te::rst::Raster> permUrbRaster;
+  if (calculatePermUrb)
+  {
+    permUrbRaster = cloneRasterIntoMem(inputRaster, false, te::dt::FLOAT_TYPE, -1.);
+  }
 
   unsigned int numRows = inputRaster->getNumberOfRows();
   unsigned int numColumns = inputRaster->getNumberOfColumns();
   double resX = inputRaster->getResolutionX();
-  double resY = inputRaster->getResolutionY();
 
   boost::numeric::ublas::matrix<bool> mask = createRadiusMask(resX, radius);
+  std::vector<MaskSpan> vecSpans = createMaskSpans(mask);
+  NeighborhoodKernel kernel = selectNeighborhoodKernel(params->m_kernel, vecSpans);
+
+  //both classifications use the same neighborhood counts, so the input is read and counted only once
+  NeighborhoodPlane plane;
+  createNeighborhoodPlane(inputRaster, inputClassesMap, plane);
+  prepareNeighborhoodPlane(kernel, plane);
+
+  std::size_t numPixels = (std::size_t)numRows * numColumns;
+
+  PixelPlane<unsigned char> urbanizedPlane(numRows, numColumns, OUTPUT_NO_DATA);
+  PixelPlane<unsigned char> footprintPlane(numRows, numColumns, OUTPUT_NO_DATA);
+  PixelPlane<float> permUrbPlane;
+  if (calculatePermUrb)
+  {
+    permUrbPlane = PixelPlane<float>(numRows, numColumns, -1.f);
+  }
+
+  UrbanAreasRowClassifier classifier(inputClassesMap, numColumns, urbanizedPlane.getRow(0), footprintPlane.getRow(0), calculatePermUrb ? permUrbPlane.getRow(0) : 0);
+
+  //the urban indexes are a reduction of the urban percentages calculated by the classification
+  std::vector<unsigned char> vecStudyArea;
+  std::auto_ptr<UrbanIndexesStatistics> urbanIndexesStatistics;
+  if (params->m_calculateUrbanIndexes)
+  {
+    //like calculateUrbanIndexes, the indexes are not calculated when the limits have no polygon, and the classification goes on
+    if (createStudyAreaMask(inputRaster, params->m_spatialLimits, vecStudyArea) == false)
+    {
+      logWarning("classifyUrbanizedAreaAndFootprint for " + inputRaster->getInfo()["URI"] + ": the spatial limits have no polygon, so the urban indexes are not calculated");
+    }
+    else
+    {
+      urbanIndexesStatistics.reset(new UrbanIndexesStatistics(plane, vecStudyArea.empty() ? 0 : &vecStudyArea[0]));
+      classifier.setUrbanIndexesStatistics(urbanIndexesStatistics.get());
+    }
+  }
+
+  SpanInstructionSet instructionSet = classifyNeighborhoodRows(plane, vecSpans, kernel, numberOfThreads, classifier, "Classify Urbanized Area and Footprint");
+
+  if (urbanIndexesStatistics.get() != 0)
+  {
+    urbanIndexesStatistics->calculateUrbanIndexes(params->m_urbanIndexes);
+    if (params->m_edgeFileName.empty() == false)
+    {
+      saveEdgeBitmap(params->m_edgeFileName, inputRaster, urbanIndexesStatistics->m_numWords, urbanIndexesStatistics->m_vecEdgeBits, params->m_rasterWriter, params->m_rasterCreationOptions);
+    }
+  }
+
+  urbanizedPlane.write(urbanizedRaster.get());
+  footprintPlane.write(footprintRaster.get());
+  if (calculatePermUrb)
+  {
+    permUrbPlane.write(permUrbRaster.get());
+  }
 
-  int  maskSizeInPixels = te::rst::Round(radius / resX);
+  params->m_urbanizedAreaRaster.reset(urbanizedRaster.release());
+  params->m_urbanFootprintRaster.reset(footprintRaster.release());
+  params->m_permUrbRaster.reset(permUrbRaster.release());
 
-  te::common::TaskProgress task("Classify Urbanized Footprint");
-  task.setTotalSteps((int)(numRows * numColumns));
+  std::string message = "classifyUrbanizedAreaAndFootprint for  " + inputRaster->getInfo()["URI"] + " executed in " + boost::lexical_cast<std::string>(timer.getElapsedTimeMinutes()) + " minutes";
+  message += " (" + getNeighborhoodKernelName(kernel, instructionSet) + ", " + boost::lexical_cast<std::string>(numberOfThreads) + " threads, " + boost::lexical_cast<std::string>((std::size_t)timer.getPixelsPerSecond(numPixels)) + " pixels/second)";
+  if (urbanIndexesStatistics.get() != 0)
+  {
+    message += "\nopenness=" + boost::lexical_cast<std::string>(params->m_urbanIndexes["openness"]);
+    message += "\nedgeIndex=" + boost::lexical_cast<std::string>(params->m_urbanIndexes["edgeIndex"]);
+  }
+
+  logInfo(message);
+}
+
+void te::urban::classifyUrbanizedAreaAndFootprintStreaming(te::rst::Raster* inputRaster, const InputClassesMap& inputClassesMap, double radius, NeighborhoodKernel kernel, std::size_t numberOfThreads,
+                                                           te::rst::Raster* urbanizedAreaRaster, te::rst::Raster* urbanFootprintRaster)
+{
+  assert(inputRaster);
+  assert(urbanizedAreaRaster);
+  assert(urbanFootprintRaster);
+
+  Timer timer;
+
+  numberOfThreads = getNumberOfThreads(numberOfThreads);
+
+  std::size_t numRows = inputRaster->getNumberOfRows();
+  std::size_t numColumns = inputRaster->getNumberOfColumns();
+  double resX = inputRaster->getResolutionX();
+
+  boost::numeric::ublas::matrix<bool> mask = createRadiusMask(resX, radius);
+  std::vector<MaskSpan> vecSpans = createMaskSpans(mask);
+  kernel = selectRingPlaneKernel(kernel, vecSpans);
+
+  std::size_t radiusInPixels = mask.size1() / 2;
+
+  //each strip is split in one band for each thread, and each band counts the rows within the radius around it again. The strips are made large enough to keep this small
+  std::size_t stripNumRows = getStripNumberOfRows(urbanizedAreaRaster, 0, std::max((std::size_t)256, 4 * numberOfThreads * ((2 * radiusInPixels) + 1)));
+
+  //the ring keeps the strip and the rows within the radius above and below it
+  NeighborhoodPlane plane;
+  createNeighborhoodRingPlane(numRows, numColumns, stripNumRows + (2 * radiusInPixels), plane);
+
+  SpanInstructionSet instructionSet = getSupportedSpanInstructionSet();
+
+  te::common::TaskProgress task("Classify Urbanized Area and Footprint");
+  task.setTotalSteps((int)((numRows + stripNumRows - 1) / stripNumRows));
   task.useTimer(true);
 
-  std::vector<double> vecPixels;
-  for (std::size_t currentRow = 0; currentRow < numRows; ++currentRow)
+  std::size_t numReadRows = 0;
+  for (std::size_t stripFirstRow = 0; stripFirstRow < numRows; stripFirstRow += stripNumRows)
+  {
+    std::size_t stripLastRow = std::min(stripFirstRow + stripNumRows, numRows);
+
+    //the new rows replace the rows that are no longer within the radius of the strip
+    std::size_t lastNeededRow = std::min(stripLastRow + radiusInPixels, numRows);
+    readNeighborhoodRows(inputRaster, inputClassesMap, numReadRows, lastNeededRow - numReadRows, plane);
+    numReadRows = lastNeededRow;
+
+    PixelPlane<unsigned char> urbanizedStrip(stripLastRow - stripFirstRow, numColumns, OUTPUT_NO_DATA);
+    PixelPlane<unsigned char> footprintStrip(stripLastRow - stripFirstRow, numColumns, OUTPUT_NO_DATA);
+    urbanizedStrip.setFirstRow(stripFirstRow);
+    footprintStrip.setFirstRow(stripFirstRow);
+
+    UrbanAreasRowClassifier classifier(inputClassesMap, numColumns, urbanizedStrip.getRow(0), footprintStrip.getRow(0), 0, stripFirstRow);
+    instructionSet = classifyNeighborhoodRowRange(plane, vecSpans, kernel, numberOfThreads, stripFirstRow, stripLastRow, classifier);
+
+    urbanizedStrip.write(urbanizedAreaRaster);
+    footprintStrip.write(urbanFootprintRaster);
+
+    task.pulse();
+  }
+
+  std::string message = "classifyUrbanizedAreaAndFootprintStreaming for  " + inputRaster->getInfo()["URI"] + " executed in " + boost::lexical_cast<std::string>(timer.getElapsedTimeMinutes()) + " minutes";
+  message += " (" + getNeighborhoodKernelName(kernel, instructionSet) + ", " + boost::lexical_cast<std::string>(numberOfThreads) + " threads, " + boost::lexical_cast<std::string>(plane.m_numBufferRows) + " rows in memory, " + boost::lexical_cast<std::string>((std::size_t)timer.getPixelsPerSecond(numRows * numColumns)) + " pixels/second)";
+
+  logInfo(message);
+}
+
+void te::urban::classifyUrbanAreasRadiusSweep(ClassifyRadiusSweepParams* params)
+{
+  assert(params);
+
+  if (params->m_vecRadius.empty())
   {
-    for (std::size_t currentColumn = 0; currentColumn < numColumns; ++currentColumn)
+    throw te::common::Exception("At least one radius must be given. Error in function: classifyUrbanAreasRadiusSweep");
+  }
+
+  Timer timer;
+
+  te::rst::Raster* inputRaster = params->m_inputRaster;
+  InputClassesMap inputClassesMap = params->m_inputClassesMap;
+  bool calculateUrbanizedArea = params->m_calculateUrbanizedArea;
+  bool calculateUrbanFootprint = params->m_calculateUrbanFootprint;
+  std::size_t numberOfThreads = getNumberOfThreads(params->m_numberOfThreads);
+  std::size_t numberOfRadius = params->m_vecRadius.size();
+
+  unsigned int numRows = inputRaster->getNumberOfRows();
+  unsigned int numColumns = inputRaster->getNumberOfColumns();
+  double resX = inputRaster->getResolutionX();
+
+  //the counter expects the masks sorted from the smallest to the largest radius
+  std::vector<std::pair<double, std::size_t> > vecSortedRadius;
+  for (std::size_t i = 0; i < numberOfRadius; ++i)
+  {
+    vecSortedRadius.push_back(std::make_pair(params->m_vecRadius[i], i));
+  }
+  std::sort(vecSortedRadius.begin(), vecSortedRadius.end());
+
+  std::vector<std::vector<MaskSpan> > vecRadiusSpans;
+  for (std::size_t i = 0; i < numberOfRadius; ++i)
+  {
+    vecRadiusSpans.push_back(createMaskSpans(createRadiusMask(resX, vecSortedRadius[i].first)));
+  }
+
+  //the input is read only once for all the radii
+  NeighborhoodPlane plane;
+  createNeighborhoodPlane(inputRaster, inputClassesMap, plane);
+
+  std::vector<PixelPlane<unsigned char> > vecUrbanizedPlanes(numberOfRadius);
+  std::vector<PixelPlane<unsigned char> > vecFootprintPlanes(numberOfRadius);
+  std::vector<NeighborhoodRowClassifier*> vecClassifiers;
+  for (std::size_t i = 0; i < numberOfRadius; ++i)
+  {
+    unsigned char* urbanizedArea = 0;
+    if (calculateUrbanizedArea)
     {
-      //gets the value of the current center pixel
-      double centerPixel = 0;
-      inputRaster->getValue((unsigned int)currentColumn, (unsigned int)currentRow, centerPixel);
+      vecUrbanizedPlanes[i] = PixelPlane<unsigned char>(numRows, numColumns, OUTPUT_NO_DATA);
+      urbanizedArea = vecUrbanizedPlanes[i].getRow(0);
+    }
 
-      //NO DATA
-      double value = OUTPUT_NO_DATA;
+    unsigned char* urbanFootprint = 0;
+    if (calculateUrbanFootprint)
+    {
+      vecFootprintPlanes[i] = PixelPlane<unsigned char>(numRows, numColumns, OUTPUT_NO_DATA);
+      urbanFootprint = vecFootprintPlanes[i].getRow(0);
+    }
 
-      //WATER
-      if (centerPixel == InputWater)
-      {
-        value = OUTPUT_WATER;
-      }
-      else if (centerPixel == InputOther)
+    vecClassifiers.push_back(new UrbanAreasRowClassifier(inputClassesMap, numColumns, urbanizedArea, urbanFootprint, 0));
+  }
+
+  //the radii counted by the prefix sums share a single scan of the plane. The kernel of each radius is kept for the log
+  std::vector<std::vector<MaskSpan> > vecSweepSpans;
+  std::vector<NeighborhoodRowClassifier*> vecSweepClassifiers;
+  std::vector<std::size_t> vecSweepRadius;
+  std::vector<std::string> vecKernelNames(numberOfRadius);
+  std::vector<NeighborhoodKernel> vecKernels(numberOfRadius);
+  std::set<NeighborhoodKernel> setPreparedKernels;
+  for (std::size_t i = 0; i < numberOfRadius; ++i)
+  {
+    vecKernels[i] = selectNeighborhoodKernel(params->m_kernel, vecRadiusSpans[i]);
+
+    //the plane is prepared once for each kernel, before any radius is counted
+    if (setPreparedKernels.insert(vecKernels[i]).second)
+    {
+      prepareNeighborhoodPlane(vecKernels[i], plane);
+    }
+  }
+
+  for (std::size_t i = 0; i < numberOfRadius; ++i)
+  {
+    NeighborhoodKernel kernel = vecKernels[i];
+    if (kernel == KERNEL_PREFIX_SUM)
+    {
+      vecSweepSpans.push_back(vecRadiusSpans[i]);
+      vecSweepClassifiers.push_back(vecClassifiers[i]);
+      vecSweepRadius.push_back(i);
+      continue;
+    }
+
+    SpanInstructionSet instructionSet = classifyNeighborhoodRows(plane, vecRadiusSpans[i], kernel, numberOfThreads, *vecClassifiers[i], "Classify Urbanized Area and Footprint for " + boost::lexical_cast<std::string>(vecSortedRadius[i].first) + " m");
+    vecKernelNames[i] = getNeighborhoodKernelName(kernel, instructionSet);
+  }
+
+  if (vecSweepSpans.empty() == false)
+  {
+    SpanInstructionSet instructionSet = classifyNeighborhoodRowsForRadii(plane, vecSweepSpans, numberOfThreads, vecSweepClassifiers, "Classify Urbanized Area and Footprint for " + boost::lexical_cast<std::string>(vecSweepSpans.size()) + " radii");
+    for (std::size_t i = 0; i < vecSweepRadius.size(); ++i)
+    {
+      vecKernelNames[vecSweepRadius[i]] = getNeighborhoodKernelName(KERNEL_PREFIX_SUM, instructionSet);
+    }
+  }
+
+  te::common::FreeContents(vecClassifiers);
+
+  params->m_vecUrbanizedAreaRasters.assign(numberOfRadius, std::shared_ptr<te::rst::Raster>());
+  params->m_vecUrbanFootprintRasters.assign(numberOfRadius, std::shared_ptr<te::rst::Raster>());
+
+  //the rasters of each radius are written while the next ones are created
+  RasterWriter rasterWriter;
+
+  for (std::size_t i = 0; i < numberOfRadius; ++i)
+  {
+    double radius = vecSortedRadius[i].first;
+    std::size_t position = vecSortedRadius[i].second;
+
+    std::string radiusSuffix = "_" + boost::lexical_cast<std::string>(radius) + "m.tif";
+
+    if (calculateUrbanizedArea)
+    {
+      std::shared_ptr<te::rst::Raster> urbanizedRaster(cloneRasterIntoMem(inputRaster, false).release());
+      vecUrbanizedPlanes[i].write(urbanizedRaster.get());
+      vecUrbanizedPlanes[i] = PixelPlane<unsigned char>();
+
+      if (!params->m_outputPath.empty())
       {
-        value = OUTPUT_URBANIZED_OS;
+        rasterWriter.write(params->m_outputPath + "/" + params->m_outputPrefix + "_urbanized" + radiusSuffix, urbanizedRaster, params->m_rasterCreationOptions);
       }
-      else if (centerPixel == InputUrban)
-      {
-        //gets the pixels surrounding pixels that intersects the given radious
-        vecPixels.clear();
-        getPixelsWithinRadious(inputRaster, currentRow, currentColumn, radius, mask, vecPixels);
 
-        double permUrb = 0.;
-        value = calculateUrbanFootprint((short)centerPixel, inputClassesMap, vecPixels, permUrb);
-      }
+      params->m_vecUrbanizedAreaRasters[position] = urbanizedRaster;
+    }
 
-      outputRaster->setValue((unsigned int)currentColumn, (unsigned int)currentRow, value, 0);
+    if (calculateUrbanFootprint)
+    {
+      std::shared_ptr<te::rst::Raster> footprintRaster(cloneRasterIntoMem(inputRaster, false).release());
+      vecFootprintPlanes[i].write(footprintRaster.get());
+      vecFootprintPlanes[i] = PixelPlane<unsigned char>();
 
-      task.pulse();
+      if (!params->m_outputPath.empty())
+      {
+        rasterWriter.write(params->m_outputPath + "/" + params->m_outputPrefix + "_footprint" + radiusSuffix, footprintRaster, params->m_rasterCreationOptions);
+      }
+
+      params->m_vecUrbanFootprintRasters[position] = footprintRaster;
     }
   }
 
-  params->m_outputRaster.reset(outputRaster.release());
+  rasterWriter.wait();
 
-  logInfo("classifyUrbanFootprint for  " + inputRaster->getInfo()["URI"] + " executed in " + boost::lexical_cast<std::string>(timer.getElapsedTimeMinutes()) + " minutes");
+  std::string message = "classifyUrbanAreasRadiusSweep for  " + inputRaster->getInfo()["URI"] + " executed in " + boost::lexical_cast<std::string>(timer.getElapsedTimeMinutes()) + " minutes";
+  message += " (" + boost::lexical_cast<std::string>(numberOfRadius) + " radii, " + boost::lexical_cast<std::string>(numberOfThreads) + " threads)";
+  for (std::size_t i = 0; i < numberOfRadius; ++i)
+  {
+    message += "\nradius=" + boost::lexical_cast<std::string>(vecSortedRadius[i].first) + " (" + vecKernelNames[i] + ")";
+  }
+
+  logInfo(message);
 }
 
-void te::urban::classifyUrbanOpenArea(te::rst::Raster* urbanFootprintRaster, double radius)
+void te::urban::classifyUrbanOpenArea(te::rst::Raster* urbanFootprintRaster, double radius, NeighborhoodKernel kernel, std::size_t numberOfThreads)
 {
   Timer timer;
 
   assert(urbanFootprintRaster);
 
+  numberOfThreads = getNumberOfThreads(numberOfThreads);
+
   unsigned int numRows = urbanFootprintRaster->getNumberOfRows();
   unsigned int numColumns = urbanFootprintRaster->getNumberOfColumns();
   double resX = urbanFootprintRaster->getResolutionX();
-  double resY = urbanFootprintRaster->getResolutionY();
 
   boost::numeric::ublas::matrix<bool> mask = createRadiusMask(resX, radius);
 
-  int  maskSizeInPixels = te::rst::Round(radius / resX);
+  std::size_t numPixels = (std::size_t)numRows * numColumns;
+
+  PixelPlane<unsigned char> footprintPlane;
+  footprintPlane.read(urbanFootprintRaster);
+
+  const unsigned char* footprint = footprintPlane.getRow(0);
+
+  //the urban and suburban pixels are counted in the neighborhood of the candidate pixels. They are never changed by this classification, so the result does not depend on the processing order
+  NeighborhoodPlane plane;
+  plane.m_numRows = numRows;
+  plane.m_numColumns = numColumns;
+  plane.m_vecFlags.resize(numPixels);
+  convertFootprintToNeighborhoodFlags(footprint, numPixels, plane.m_vecFlags.empty() ? 0 : &plane.m_vecFlags[0]);
+
+  UrbanOpenAreaRowClassifier classifier(numColumns, footprintPlane.getRow(0));
+
+  //a candidate pixel is urbanized open space if the dilation of the urban pixels by the mask reaches it. When the mask is a distance threshold the dilation is
+  //calculated with a distance transform, whose cost does not depend on the radius. Otherwise the urban pixels are counted in the neighborhood
+  std::string method = "dilation";
+
+  unsigned int squaredRadius = 0;
+  if (getMaskSquaredRadius(mask, squaredRadius))
+  {
+    classifyDilatedRows(plane, squaredRadius, numberOfThreads, classifier, "Classify Urbanized Open Area");
+  }
+  else
+  {
+    std::vector<MaskSpan> vecSpans = createMaskSpans(mask);
+    kernel = selectNeighborhoodKernel(kernel, vecSpans);
+
+    prepareNeighborhoodPlane(kernel, plane);
+
+    SpanInstructionSet instructionSet = classifyNeighborhoodRows(plane, vecSpans, kernel, numberOfThreads, classifier, "Classify Urbanized Open Area");
+
+    method = getNeighborhoodKernelName(kernel, instructionSet);
+  }
+
+  footprintPlane.write(urbanFootprintRaster);
+
+  std::string message = "classifyUrbanOpenArea for  " + urbanFootprintRaster->getInfo()["URI"] + " executed in " + boost::lexical_cast<std::string>(timer.getElapsedTimeMinutes()) + " minutes";
+  message += " (" + method + ", " + boost::lexical_cast<std::string>(numberOfThreads) + " threads, " + boost::lexical_cast<std::string>((std::size_t)timer.getPixelsPerSecond(numPixels)) + " pixels/second)";
+
+  logInfo(message);
+}
+
+void te::urban::classifyUrbanOpenAreaStreaming(te::rst::Raster* urbanFootprintRaster, double radius, NeighborhoodKernel kernel, std::size_t numberOfThreads, te::rst::Raster* outputRaster)
+{
+  assert(urbanFootprintRaster);
+  assert(outputRaster);
+
+  Timer timer;
+
+  numberOfThreads = getNumberOfThreads(numberOfThreads);
+
+  std::size_t numRows = urbanFootprintRaster->getNumberOfRows();
+  std::size_t numColumns = urbanFootprintRaster->getNumberOfColumns();
+  double resX = urbanFootprintRaster->getResolutionX();
+
+  //the dilation needs all the rows, so the urban pixels are counted in the neighborhood of the candidates
+  boost::numeric::ublas::matrix<bool> mask = createRadiusMask(resX, radius);
+  std::vector<MaskSpan> vecSpans = createMaskSpans(mask);
+  kernel = selectRingPlaneKernel(kernel, vecSpans);
+
+  std::size_t radiusInPixels = mask.size1() / 2;
+  std::size_t stripNumRows = getStripNumberOfRows(outputRaster, 0, std::max((std::size_t)256, 4 * numberOfThreads * ((2 * radiusInPixels) + 1)));
+
+  NeighborhoodPlane plane;
+  createNeighborhoodRingPlane(numRows, numColumns, stripNumRows + (2 * radiusInPixels), plane);
+
+  SpanInstructionSet instructionSet = getSupportedSpanInstructionSet();
 
   te::common::TaskProgress task("Classify Urbanized Open Area");
-  task.setTotalSteps((int)(numRows * numColumns));
+  task.setTotalSteps((int)((numRows + stripNumRows - 1) / stripNumRows));
   task.useTimer(true);
 
-  std::vector<double> vecPixels;
+  PixelPlane<unsigned char> readStrip;
 
-  for (std::size_t currentRow = 0; currentRow < numRows; ++currentRow)
+  std::size_t numReadRows = 0;
+  for (std::size_t stripFirstRow = 0; stripFirstRow < numRows; stripFirstRow += stripNumRows)
   {
-    for (std::size_t currentColumn = 0; currentColumn < numColumns; ++currentColumn)
-    {
-      //gets the value of the current center pixel
-      double centerPixel = 0;
-      urbanFootprintRaster->getValue((unsigned int)currentColumn, (unsigned int)currentRow, centerPixel);
+    std::size_t stripLastRow = std::min(stripFirstRow + stripNumRows, numRows);
 
-      double value = centerPixel;
-      if (centerPixel == OUTPUT_URBANIZED_OS)
+    std::size_t lastNeededRow = std::min(stripLastRow + radiusInPixels, numRows);
+    if (lastNeededRow > numReadRows)
+    {
+      readStrip.read(urbanFootprintRaster, 0, numReadRows, lastNeededRow - numReadRows);
+      for (std::size_t row = numReadRows; row < lastNeededRow; ++row)
       {
-        //gets the pixels surrounding pixels that intersects the given radious
-        vecPixels.clear();
-        getPixelsWithinRadious(urbanFootprintRaster, currentRow, currentColumn, radius, mask, vecPixels);
+        convertFootprintToNeighborhoodFlags(readStrip.getRow(row - numReadRows), numColumns, plane.getRow(row));
+      }
+      numReadRows = lastNeededRow;
+    }
 
-        value = calculateUrbanOpenArea((short)centerPixel, vecPixels);
+    //the pixels that are not candidates keep their footprint class
+    PixelPlane<unsigned char> footprintStrip;
+    footprintStrip.read(urbanFootprintRaster, 0, stripFirstRow, stripLastRow - stripFirstRow);
 
-        urbanFootprintRaster->setValue((unsigned int)currentColumn, (unsigned int)currentRow, value, 0);
-      }
+    UrbanOpenAreaRowClassifier classifier(numColumns, footprintStrip.getRow(0), stripFirstRow);
+    instructionSet = classifyNeighborhoodRowRange(plane, vecSpans, kernel, numberOfThreads, stripFirstRow, stripLastRow, classifier);
 
-      task.pulse();
-    }
+    footprintStrip.write(outputRaster);
+
+    task.pulse();
   }
 
-  logInfo("classifyUrbanOpenArea for  " + urbanFootprintRaster->getInfo()["URI"] + " executed in " + boost::lexical_cast<std::string>(timer.getElapsedTimeMinutes()) + " minutes");
+  std::string message = "classifyUrbanOpenAreaStreaming for  " + urbanFootprintRaster->getInfo()["URI"] + " executed in " + boost::lexical_cast<std::string>(timer.getElapsedTimeMinutes()) + " minutes";
+  message += " (" + getNeighborhoodKernelName(kernel, instructionSet) + ", " + boost::lexical_cast<std::string>(numberOfThreads) + " threads, " + boost::lexical_cast<std::string>(plane.m_numBufferRows) + " rows in memory, " + boost::lexical_cast<std::string>((std::size_t)timer.getPixelsPerSecond(numRows * numColumns)) + " pixels/second)";
+
+  logInfo(message);
 }
 
 std::auto_ptr<te::rst::Raster> te::urban::identifyIsolatedOpenPatches(te::rst::Raster* raster, const std::string& outputPath, const std::string& outputPrefix, bool saveIntermediateFiles)
@@ -305,28 +659,44 @@ void te::urban::addIsolatedOpenPatches(te::rst::Raster* urbanRaster, te::rst::Ra
 
   Timer timer;
 
-  for (std::size_t row = 0; row < numRows; ++row)
+  std::size_t stripNumRows = getStripNumberOfRows(urbanRaster);
+
+  PixelPlane<unsigned char> urbanStrip;
+  PixelPlane<unsigned char> isolatedOpenPatchesStrip;
+
+  for (std::size_t stripFirstRow = 0; stripFirstRow < numRows; stripFirstRow += stripNumRows)
   {
-    for (std::size_t column = 0; column < numColumns; ++column)
-    {
-      double urbanRasterValue = 0.;
-      urbanRaster->getValue((unsigned int)column, (unsigned int)row, urbanRasterValue);
+    urbanStrip.read(urbanRaster, 0, stripFirstRow, stripNumRows);
+    isolatedOpenPatchesStrip.read(isolatedOpenPatchesRaster, 0, stripFirstRow, stripNumRows);
 
-      //if it is not  Rural Open Space, we do not chance the raster
-      if (urbanRasterValue != OUTPUT_RURAL_OS)
-      {
-        continue;
-      }
+    bool changed = false;
 
-      double isolatedOpenPatchesRasterValue = 0.;
-      isolatedOpenPatchesRaster->getValue((unsigned int)column, (unsigned int)row, isolatedOpenPatchesRasterValue);
+    for (std::size_t row = 0; row < urbanStrip.getNumberOfRows(); ++row)
+    {
+      unsigned char* urbanValues = urbanStrip.getRow(row);
+      const unsigned char* isolatedOpenPatchesValues = isolatedOpenPatchesStrip.getRow(row);
 
-      //if it is an isolated open patch, we set the raster value to 
-      if (isolatedOpenPatchesRasterValue == 1.)
+      for (std::size_t column = 0; column < numColumns; ++column)
       {
-        urbanRaster->setValue((unsigned int)column, (unsigned int)row, OUTPUT_SUBURBAN_ZONE_OPEN_AREA);
+        //if it is not  Rural Open Space, we do not chance the raster
+        if (urbanValues[column] != OUTPUT_RURAL_OS)
+        {
+          continue;
+        }
+
+        //if it is an isolated open patch, we set the raster value to 
+        if (isolatedOpenPatchesValues[column] == 1)
+        {
+          urbanValues[column] = OUTPUT_SUBURBAN_ZONE_OPEN_AREA;
+          changed = true;
+        }
       }
     }
+
+    if (changed)
+    {
+      urbanStrip.write(urbanRaster);
+    }
   }
 
   logInfo("addIsolatedOpenPatches for  " + urbanRaster->getInfo()["URI"] + " executed in " + boost::lexical_cast<std::string>(timer.getElapsedTimeMinutes()) + " minutes");
@@ -352,101 +722,43 @@ void te::urban::calculateUrbanIndexes(CalculateUrbanIndexesParams* params)
   te::rst::Raster* inputRaster = params->m_inputRaster;
   InputClassesMap inputClassesMap = params->m_inputClassesMap;
   double radius = params->m_radius;
-  te::gm::Geometry* spatialLimits = params->m_spatialLimits;
-
-  const short InputUrban = inputClassesMap.find(INPUT_URBAN)->second;
-  const short InputOther = inputClassesMap.find(INPUT_OTHER)->second;
+  std::size_t numberOfThreads = getNumberOfThreads(params->m_numberOfThreads);
 
   unsigned int numRows = inputRaster->getNumberOfRows();
   unsigned int numColumns = inputRaster->getNumberOfColumns();
   double resX = inputRaster->getResolutionX();
-  double resY = inputRaster->getResolutionY();
-
-  boost::numeric::ublas::matrix<bool> mask = createRadiusMask(resX, radius);
 
-  int numUrbanPixels = 0;
-  int edgeCount = 0; //edge index
-  double sumPerUrb = 0;
-
-  te::common::TaskProgress task("Calculating indexes");
-  task.setTotalSteps((int)(numRows * numColumns));
-  task.useTimer(true);
-
-  const te::gm::Envelope* rasterEnvelope = inputRaster->getExtent();
-  te::gm::Polygon* limitPolygon = 0;
-  if (spatialLimits != 0)
-  {
-    limitPolygon = dynamic_cast<te::gm::Polygon*>(spatialLimits);
-  }
-  else
-  {
-    limitPolygon = (te::gm::Polygon*)te::gm::GetGeomFromEnvelope(rasterEnvelope, inputRaster->getSRID());
-  }
-
-  if (limitPolygon == 0)
+  std::vector<unsigned char> vecStudyArea;
+  if (createStudyAreaMask(inputRaster, params->m_spatialLimits, vecStudyArea) == false)
   {
     return;
   }
 
-  te::rst::PolygonIterator<double> it = te::rst::PolygonIterator<double>::begin(inputRaster, limitPolygon);
-  te::rst::PolygonIterator<double> itend = te::rst::PolygonIterator<double>::end(inputRaster, limitPolygon);
-
-  std::vector<double> vecPixels;
-
-  while (it != itend)
-  {
-    unsigned int currentRow = it.getRow();
-    unsigned int currentColumn = it.getColumn();
-
-    //gets the value of the current center pixel
-    double centerPixel = 0;
-    inputRaster->getValue((unsigned int)currentColumn, (unsigned int)currentRow, centerPixel);
-
-    task.pulse();
-
-    if (centerPixel != InputUrban)
-    {
-      ++it;
-      continue;
-    }
-
-    //gets the pixels surrounding pixels that intersects the given radious
-    vecPixels.clear();
-    getPixelsWithinRadious(inputRaster, currentRow, currentColumn, radius, mask, vecPixels);
-
-    double permUrb = 0.;
-    double value = calculateUrbanizedArea((short)centerPixel, inputClassesMap, vecPixels, permUrb);
-
-    //if the index could not be calculated, we continue to the next iteration
-    if (value == OUTPUT_NO_DATA)
-    {
-      ++it;
-      continue;
-    }
+  boost::numeric::ublas::matrix<bool> mask = createRadiusMask(resX, radius);
+  std::vector<MaskSpan> vecSpans = createMaskSpans(mask);
+  NeighborhoodKernel kernel = selectNeighborhoodKernel(params->m_kernel, vecSpans);
 
-    ++numUrbanPixels;
+  NeighborhoodPlane plane;
+  createNeighborhoodPlane(inputRaster, inputClassesMap, plane);
+  prepareNeighborhoodPlane(kernel, plane);
 
-    sumPerUrb += permUrb;
+  //only the statistics of the indexes are calculated, no output is classified
+  UrbanIndexesStatistics urbanIndexesStatistics(plane, vecStudyArea.empty() ? 0 : &vecStudyArea[0]);
 
-    //then we check if there is at least one pixel that is not also urban in the adjacency
-    bool hasEdge = calculateEdge(inputRaster, inputClassesMap, currentColumn, currentRow);
-    if (hasEdge == true)
-    {
-      ++edgeCount;
-    }
+  UrbanAreasRowClassifier classifier(inputClassesMap, numColumns, 0, 0, 0);
+  classifier.setUrbanIndexesStatistics(&urbanIndexesStatistics);
+  SpanInstructionSet instructionSet = classifyNeighborhoodRows(plane, vecSpans, kernel, numberOfThreads, classifier, "Calculating indexes");
 
-    ++it;
+  urbanIndexesStatistics.calculateUrbanIndexes(params->m_urbanIndexes);
+  if (params->m_edgeFileName.empty() == false)
+  {
+    saveEdgeBitmap(params->m_edgeFileName, inputRaster, urbanIndexesStatistics.m_numWords, urbanIndexesStatistics.m_vecEdgeBits, params->m_rasterWriter, params->m_rasterCreationOptions);
   }
 
-  double openness = 1. - (sumPerUrb / numUrbanPixels);
-  double edgeIndex = double(edgeCount) / numUrbanPixels;
-
-  params->m_urbanIndexes["openness"] = openness;
-  params->m_urbanIndexes["edgeIndex"] = edgeIndex;
-
   std::string message = "Indexes calculated for  " + inputRaster->getInfo()["URI"]  + " executed in " + boost::lexical_cast<std::string>(timer.getElapsedTimeMinutes()) + " minutes";
-  message += "\nopenness=" + boost::lexical_cast<std::string>(openness);
-  message += "\nedgeIndex=" + boost::lexical_cast<std::string>(edgeIndex);
+  message += " (" + getNeighborhoodKernelName(kernel, instructionSet) + ", " + boost::lexical_cast<std::string>(numberOfThreads) + " threads, " + boost::lexical_cast<std::string>((std::size_t)timer.getPixelsPerSecond((std::size_t)numRows * numColumns)) + " pixels/second)";
+  message += "\nopenness=" + boost::lexical_cast<std::string>(params->m_urbanIndexes["openness"]);
+  message += "\nedgeIndex=" + boost::lexical_cast<std::string>(params->m_urbanIndexes["edgeIndex"]);
 
   logInfo(message);
 }
@@ -461,6 +773,7 @@ void te::urban::prepareRaster(PrepareRasterParams* params)
   const std::string& outputPath = params->m_outputPath;
   const std::string& outputPrefix = params->m_outputPrefix;
   bool saveIntermediateFiles = params->m_saveIntermediateFiles;
+  const RasterCreationOptions& rasterCreationOptions = params->m_rasterCreationOptions;
 
   assert(inputRaster);
 
@@ -474,40 +787,74 @@ void te::urban::prepareRaster(PrepareRasterParams* params)
   std::string urbanFootprintsFileName = outputPath + "/" + footprintPrefix + ".tif";
   std::string urbanFootprintsOpenAreaFileName = outputPath + "/" + footprintOpenAreaPrefix + ".tif";
 
+  std::string edgesFileName = outputPath + "/" + outputPrefix + "_edges.tif";
+
   std::string urbanizedIsolatedOpenPatchesFileName = outputPath + "/" + urbanizedPrefix + "_isolated_open_patches.tif";
   std::string urbanFootprintsIsolatedOpenPatchesFileName = outputPath + "/" + footprintPrefix + "_isolated_open_patches.tif";
 
-  //step 1 - classify the urbanized areas
-  ClassifyParams urbanizedParams;
-  urbanizedParams.m_inputRaster = inputRaster;
-  urbanizedParams.m_inputClassesMap = inputClassesMap;
-  urbanizedParams.m_radius = radius;
-  classifyUrbanizedArea(&urbanizedParams);
+  //if the cache has the results of the same input and parameters, they are loaded instead of calculated. The cache only keeps the final results,
+  //so it is not used when the intermediate files are requested, as a hit would not create them
+  std::string cacheKey;
+  if (params->m_resultCache != 0 && params->m_inputKey.empty() == false && saveIntermediateFiles == false)
+  {
+    cacheKey = createPrepareRasterCacheKey(params);
 
-  params->m_result.m_urbanizedAreaRaster.reset (urbanizedParams.m_outputRaster.release());
-  if (saveIntermediateFiles)
+    UrbanIndexes* urbanIndexes = params->m_urbanIndexesParams != 0 ? &params->m_urbanIndexesParams->m_urbanIndexes : 0;
+    if (params->m_resultCache->load(cacheKey, params->m_result, urbanIndexes))
+    {
+      return;
+    }
+  }
+
+  //the intermediate files are written while the next steps are calculated
+  std::auto_ptr<RasterWriter> localRasterWriter;
+  RasterWriter* rasterWriter = params->m_rasterWriter;
+  if (saveIntermediateFiles && rasterWriter == 0)
   {
-    saveRaster(urbanizedAreaFileName, params->m_result.m_urbanizedAreaRaster.get());
+    localRasterWriter.reset(new RasterWriter());
+    rasterWriter = localRasterWriter.get();
   }
 
-  //step 2 - classify the urban footprints
-  ClassifyParams footprintParams;
-  footprintParams.m_inputRaster = inputRaster;
-  footprintParams.m_inputClassesMap = inputClassesMap;
-  footprintParams.m_radius = radius;
-  classifyUrbanFootprint(&footprintParams);
+  //steps 1 and 2 - classify the urbanized areas and the urban footprints
+  ClassifyUrbanAreasParams classifyParams;
+  classifyParams.m_inputRaster = inputRaster;
+  classifyParams.m_inputClassesMap = inputClassesMap;
+  classifyParams.m_radius = radius;
+  classifyParams.m_kernel = params->m_kernel;
+  classifyParams.m_numberOfThreads = params->m_numberOfThreads;
+  if (params->m_urbanIndexesParams != 0)
+  {
+    classifyParams.m_calculateUrbanIndexes = true;
+    classifyParams.m_spatialLimits = params->m_urbanIndexesParams->m_spatialLimits;
+    if (saveIntermediateFiles)
+    {
+      classifyParams.m_edgeFileName = edgesFileName;
+      classifyParams.m_rasterCreationOptions = rasterCreationOptions;
+      classifyParams.m_rasterWriter = rasterWriter;
+    }
+  }
+  classifyUrbanizedAreaAndFootprint(&classifyParams);
+
+  if (params->m_urbanIndexesParams != 0)
+  {
+    params->m_urbanIndexesParams->m_urbanIndexes = classifyParams.m_urbanIndexes;
+  }
+
+  params->m_result.m_urbanizedAreaRaster.reset(classifyParams.m_urbanizedAreaRaster.release());
+  params->m_result.m_urbanFootprintRaster.reset(classifyParams.m_urbanFootprintRaster.release());
 
-  params->m_result.m_urbanFootprintRaster.reset(footprintParams.m_outputRaster.release());
+  //the next steps change the rasters, so copies are written
   if (saveIntermediateFiles)
   {
-    saveRaster(urbanFootprintsFileName, params->m_result.m_urbanFootprintRaster.get());
+    rasterWriter->writeCopy(urbanizedAreaFileName, params->m_result.m_urbanizedAreaRaster.get(), rasterCreationOptions);
+    rasterWriter->writeCopy(urbanFootprintsFileName, params->m_result.m_urbanFootprintRaster.get(), rasterCreationOptions);
   }
   
   //step 3 - classify fringe open areas
-  classifyUrbanOpenArea(params->m_result.m_urbanFootprintRaster.get(), 100);
+  classifyUrbanOpenArea(params->m_result.m_urbanFootprintRaster.get(), 100, params->m_kernel, params->m_numberOfThreads);
   if (saveIntermediateFiles)
   {
-    saveRaster(urbanFootprintsOpenAreaFileName, params->m_result.m_urbanFootprintRaster.get());
+    rasterWriter->writeCopy(urbanFootprintsOpenAreaFileName, params->m_result.m_urbanFootprintRaster.get(), rasterCreationOptions);
   }
 
   //step 4 and 5- identify isolated patches and classify them into the given raster
@@ -517,13 +864,66 @@ void te::urban::prepareRaster(PrepareRasterParams* params)
   isolatedThread1.join();
   isolatedThread2.join();
 
+  //the results are finished, so they are shared with the writer
   if (saveIntermediateFiles)
   {
-    saveRaster(urbanizedIsolatedOpenPatchesFileName, params->m_result.m_urbanizedAreaRaster.get());
-    saveRaster(urbanFootprintsIsolatedOpenPatchesFileName, params->m_result.m_urbanFootprintRaster.get());
+    rasterWriter->write(urbanizedIsolatedOpenPatchesFileName, params->m_result.m_urbanizedAreaRaster, rasterCreationOptions);
+    rasterWriter->write(urbanFootprintsIsolatedOpenPatchesFileName, params->m_result.m_urbanFootprintRaster, rasterCreationOptions);
+  }
+
+  if (cacheKey.empty() == false)
+  {
+    params->m_resultCache->store(cacheKey, params->m_result, params->m_urbanIndexesParams != 0 ? &params->m_urbanIndexesParams->m_urbanIndexes : 0);
+  }
+
+  if (localRasterWriter.get() != 0)
+  {
+    localRasterWriter->wait();
   }
 }
 
+std::string te::urban::createPrepareRasterCacheKey(PrepareRasterParams* params)
+{
+  assert(params);
+  assert(params->m_inputRaster);
+
+  te::rst::Raster* inputRaster = params->m_inputRaster;
+
+  Hasher hasher;
+  hasher.add(std::string(TEGROWTH_RESULT_CACHE_VERSION));
+  hasher.add(params->m_inputKey);
+
+  InputClassesMap::const_iterator itClasses = params->m_inputClassesMap.begin();
+  while (itClasses != params->m_inputClassesMap.end())
+  {
+    hasher.add((boost::uint64_t)itClasses->first);
+    hasher.add((boost::uint64_t)itClasses->second);
+    ++itClasses;
+  }
+
+  hasher.add(params->m_radius);
+
+  //the same file gives a different input if it is normalized or read in a window
+  const te::gm::Envelope* extent = inputRaster->getExtent();
+  hasher.add((boost::uint64_t)inputRaster->getNumberOfRows());
+  hasher.add((boost::uint64_t)inputRaster->getNumberOfColumns());
+  hasher.add((boost::uint64_t)inputRaster->getSRID());
+  hasher.add(extent->m_llx);
+  hasher.add(extent->m_lly);
+  hasher.add(extent->m_urx);
+  hasher.add(extent->m_ury);
+
+  //the indexes only depend on the study area
+  if (params->m_urbanIndexesParams != 0)
+  {
+    te::gm::Geometry* spatialLimits = params->m_urbanIndexesParams->m_spatialLimits;
+    hasher.add(std::string("indexes"));
+    hasher.add(spatialLimits != 0 ? spatialLimits->asText() : std::string());
+  }
+
+  return hasher.getHash();
+}
+
 void te::urban::compareRasterPeriods(CompareTimePeriodsParams* params)
 {
   assert(params);
@@ -547,15 +947,34 @@ void te::urban::compareRasterPeriods(CompareTimePeriodsParams* params)
   std::string otherNewDevRasterFileName = outputPath + "/" + otherNewDevPrefix + ".tif";
   std::string otherNewDevGroupedRasterFileName = outputPath + "/" + otherNewDevGroupedPrefix + ".tif";
 
+  //the intermediate files are written in background, and the next steps use the rasters kept in memory
+  std::auto_ptr<RasterWriter> localRasterWriter;
+  RasterWriter* rasterWriter = params->m_rasterWriter;
+  if (params->m_saveIntermediateFiles && rasterWriter == 0)
+  {
+    localRasterWriter.reset(new RasterWriter());
+    rasterWriter = localRasterWriter.get();
+  }
+
   //1 - we first generate the infill raster and the other dev raster
-  generateInfillOtherDevRasters(t1.m_urbanizedAreaRaster.get(), t2.m_urbanizedAreaRaster.get(), infillRasterFileName, otherNewDevRasterFileName);
+  std::auto_ptr<te::rst::Raster> generatedInfillRaster;
+  std::auto_ptr<te::rst::Raster> generatedOtherDevRaster;
+  generateInfillOtherDevRasters(t1.m_urbanizedAreaRaster.get(), t2.m_urbanizedAreaRaster.get(), generatedInfillRaster, generatedOtherDevRaster);
 
-  std::auto_ptr<te::rst::Raster> infillRaster = openRaster(infillRasterFileName);
-  std::auto_ptr<te::rst::Raster> otherDevRaster = openRaster(otherNewDevRasterFileName);
+  std::shared_ptr<te::rst::Raster> infillRaster(generatedInfillRaster.release());
+  std::shared_ptr<te::rst::Raster> otherDevRaster(generatedOtherDevRaster.release());
+  if (params->m_saveIntermediateFiles)
+  {
+    rasterWriter->write(infillRasterFileName, infillRaster, params->m_rasterCreationOptions);
+    rasterWriter->write(otherNewDevRasterFileName, otherDevRaster, params->m_rasterCreationOptions);
+  }
 
   //2 - then we create distinct groups for each region of the other dev raster
-  std::auto_ptr<te::rst::Raster> otherDevGroupedRaster = createDistinctGroups(otherDevRaster.get(), outputPath, outputPrefix);
-  saveRaster(otherNewDevGroupedRasterFileName, otherDevGroupedRaster.get());
+  std::shared_ptr<te::rst::Raster> otherDevGroupedRaster(createDistinctGroups(otherDevRaster.get(), outputPath, outputPrefix, params->m_exportVectorizedGroups, params->m_streamGroupTiles).release());
+  if (params->m_saveIntermediateFiles)
+  {
+    rasterWriter->write(otherNewDevGroupedRasterFileName, otherDevGroupedRaster, params->m_rasterCreationOptions);
+  }
 
   //3 - determine edge area groups
   std::set<double> setEdgeOpenAreaGroups = detectEdgeOpenAreaGroups(otherDevRaster.get(), otherDevGroupedRaster.get(), t1.m_urbanFootprintRaster.get());
@@ -563,5 +982,10 @@ void te::urban::compareRasterPeriods(CompareTimePeriodsParams* params)
   //4 - then we calculate the new development classification
   params->m_outputRaster = classifyNewDevelopment(infillRaster.get(), otherDevGroupedRaster.get(), setEdgeOpenAreaGroups);
 
+  if (localRasterWriter.get() != 0)
+  {
+    localRasterWriter->wait();
+  }
+
   logInfo("compareRasterPeriods for  " + params->m_outputRaster.get()->getInfo()["URI"] + " executed in " + boost::lexical_cast<std::string>(timer.getElapsedTimeMinutes()) + " minutes");
 }
\ No newline at end of file
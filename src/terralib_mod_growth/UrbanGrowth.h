@@ -28,6 +28,7 @@ TerraLib Team at <terralib-team@terralib.org>.
 
 #include "Config.h"
 
+#include "Neighborhood.h"
 #include "Utils.h"
 
 #include <map>
@@ -47,31 +48,118 @@ namespace te
 
   namespace urban
   {
+    class RasterWriter;
+    class ResultCache;
+
     struct CalculateUrbanIndexesParams
     {
+      CalculateUrbanIndexesParams()
+        : m_inputRaster(0)
+        , m_radius(0)
+        , m_spatialLimits(0)
+        , m_kernel(KERNEL_AUTOMATIC)
+        , m_numberOfThreads(0)
+        , m_rasterWriter(0)
+      {}
+
       std::string m_inputFileName;
       te::rst::Raster* m_inputRaster;
       InputClassesMap m_inputClassesMap;
       double m_radius;
       te::gm::Geometry* m_spatialLimits;
+      NeighborhoodKernel m_kernel;
+      std::size_t m_numberOfThreads; //!< 0 means all the available cores
+      std::string m_edgeFileName; //!< if not empty, the edge bitmap used by the edge index is saved in this file
+      RasterCreationOptions m_rasterCreationOptions; //!< the options of the edge file
+      RasterWriter* m_rasterWriter; //!< if not null, the edge file is queued in this writer and may still be written when the function returns
       UrbanIndexes m_urbanIndexes;
     };
 
     struct ClassifyParams
     {
+      ClassifyParams()
+        : m_inputRaster(0)
+        , m_radius(0)
+        , m_kernel(KERNEL_AUTOMATIC)
+        , m_numberOfThreads(0)
+      {}
+
       te::rst::Raster* m_inputRaster;
       InputClassesMap m_inputClassesMap;
       double m_radius;
+      NeighborhoodKernel m_kernel;
+      std::size_t m_numberOfThreads; //!< 0 means all the available cores
 
       std::auto_ptr<te::rst::Raster> m_outputRaster;
     };
 
+    struct ClassifyUrbanAreasParams
+    {
+      ClassifyUrbanAreasParams()
+        : m_inputRaster(0)
+        , m_radius(0)
+        , m_kernel(KERNEL_AUTOMATIC)
+        , m_calculatePermUrb(false)
+        , m_numberOfThreads(0)
+        , m_calculateUrbanIndexes(false)
+        , m_spatialLimits(0)
+        , m_rasterWriter(0)
+      {}
+
+      te::rst::Raster* m_inputRaster;
+      InputClassesMap m_inputClassesMap;
+      double m_radius;
+      NeighborhoodKernel m_kernel;
+      bool m_calculatePermUrb;
+      std::size_t m_numberOfThreads; //!< 0 means all the available cores
+      bool m_calculateUrbanIndexes; //!< if true, the urban indexes are calculated from the same neighborhood counts of the classification
+      te::gm::Geometry* m_spatialLimits; //!< the study area of the urban indexes. If null, the entire raster is considered
+      std::string m_edgeFileName; //!< if not empty, the edge bitmap used by the edge index is saved in this file
+      RasterCreationOptions m_rasterCreationOptions; //!< the options of the edge file
+      RasterWriter* m_rasterWriter; //!< if not null, the edge file is queued in this writer and may still be written when the function returns
+
+      std::auto_ptr<te::rst::Raster> m_urbanizedAreaRaster;
+      std::auto_ptr<te::rst::Raster> m_urbanFootprintRaster;
+      std::auto_ptr<te::rst::Raster> m_permUrbRaster; //!< only created if m_calculatePermUrb is true. Contains the urban percentage of the neighborhood of each pixel
+      UrbanIndexes m_urbanIndexes; //!< only calculated if m_calculateUrbanIndexes is true
+    };
+
+    struct ClassifyRadiusSweepParams
+    {
+      ClassifyRadiusSweepParams()
+        : m_inputRaster(0)
+        , m_calculateUrbanizedArea(true)
+        , m_calculateUrbanFootprint(true)
+        , m_kernel(KERNEL_AUTOMATIC)
+        , m_numberOfThreads(0)
+      {}
+
+      te::rst::Raster* m_inputRaster;
+      InputClassesMap m_inputClassesMap;
+      std::vector<double> m_vecRadius;
+      bool m_calculateUrbanizedArea;
+      bool m_calculateUrbanFootprint;
+      NeighborhoodKernel m_kernel; //!< selected for each radius. The radii counted by the prefix sums share a single scan, and the other radii are counted with their own kernel
+      std::size_t m_numberOfThreads; //!< 0 means all the available cores
+      std::string m_outputPath; //!< if not empty, the output rasters are also saved in this path
+      std::string m_outputPrefix;
+      RasterCreationOptions m_rasterCreationOptions; //!< the options of the saved output rasters
+
+      std::vector<std::shared_ptr<te::rst::Raster> > m_vecUrbanizedAreaRasters; //!< one raster for each radius, in the same order of m_vecRadius
+      std::vector<std::shared_ptr<te::rst::Raster> > m_vecUrbanFootprintRasters; //!< one raster for each radius, in the same order of m_vecRadius
+    };
+
     struct PrepareRasterParams
     {
       PrepareRasterParams()
         : m_inputRaster(0)
         , m_radius(0)
         , m_saveIntermediateFiles(true)
+        , m_kernel(KERNEL_AUTOMATIC)
+        , m_numberOfThreads(0)
+        , m_urbanIndexesParams(0)
+        , m_rasterWriter(0)
+        , m_resultCache(0)
       {}
 
       te::rst::Raster* m_inputRaster;
@@ -81,15 +169,33 @@ namespace te
       std::string m_outputPrefix;
       UrbanRasters m_result;
       bool m_saveIntermediateFiles;
+      NeighborhoodKernel m_kernel;
+      std::size_t m_numberOfThreads; //!< 0 means all the available cores
+      CalculateUrbanIndexesParams* m_urbanIndexesParams; //!< if not null, the urban indexes of the input are calculated during steps 1 and 2 and stored in it. Its input, classes and radius are taken from these params
+      RasterCreationOptions m_rasterCreationOptions; //!< the options of the saved intermediate files
+      RasterWriter* m_rasterWriter; //!< if not null, the intermediate files are queued in this writer and may still be written when the step returns. Otherwise the step saves them in background and waits for them before returning
+      ResultCache* m_resultCache; //!< if not null and no intermediate file is saved, the results and indexes are loaded from this cache when it has them, and stored in it otherwise
+      std::string m_inputKey; //!< identifies the content of the input raster, like the hash of its file and of its remap. The cache is only used if it is not empty
     };
 
     struct CompareTimePeriodsParams
     {
-      CompareTimePeriodsParams() {}
+      CompareTimePeriodsParams()
+        : m_saveIntermediateFiles(true)
+        , m_exportVectorizedGroups(false)
+        , m_streamGroupTiles(false)
+        , m_rasterWriter(0)
+      {}
+
       UrbanRasters m_t1;
       UrbanRasters m_t2;
       std::string m_outputPath;
       std::string m_outputPrefix;
+      bool m_saveIntermediateFiles; //!< if true, the infill, other development and grouped other development rasters are saved. They are never read back from the files
+      bool m_exportVectorizedGroups; //!< if true, the regions of the other development raster are also vectorized and saved in a shapefile. It is slow and only needed for visual analysis
+      bool m_streamGroupTiles; //!< if true, the tiles of the other development raster are labeled again in the second pass of the grouping instead of being kept in memory. It uses less memory for very large rasters
+      RasterCreationOptions m_rasterCreationOptions; //!< the options of the saved intermediate files
+      RasterWriter* m_rasterWriter; //!< if not null, the intermediate files are queued in this writer and may still be written when the step returns. Otherwise the step saves them in background and waits for them before returning
 
       std::auto_ptr<te::rst::Raster> m_outputRaster;
     };
@@ -100,8 +206,21 @@ namespace te
     //step 2 - this reclassification analyses the entire raster. Classify the urban footprint
     TEGROWTHEXPORT void classifyUrbanFootprint(ClassifyParams* params);
 
-    //step 3 - this reclassification analyses the entire raster. Classify the urban open area
-    TEGROWTHEXPORT void classifyUrbanOpenArea(te::rst::Raster* urbanFootprintRaster, double radius);
+    //steps 1 and 2 - classify the urbanized area and the urban footprint in a single pass, counting the neighborhood of each pixel only once
+    TEGROWTHEXPORT void classifyUrbanizedAreaAndFootprint(ClassifyUrbanAreasParams* params);
+
+    //steps 1 and 2 in streaming mode - the input is read strip by strip into a ring of rows, and the classified strips are written directly into the output rasters
+    TEGROWTHEXPORT void classifyUrbanizedAreaAndFootprintStreaming(te::rst::Raster* inputRaster, const InputClassesMap& inputClassesMap, double radius, NeighborhoodKernel kernel, std::size_t numberOfThreads,
+                                                                   te::rst::Raster* urbanizedAreaRaster, te::rst::Raster* urbanFootprintRaster);
+
+    //steps 1 and 2 for many radii - classify the urbanized area and the urban footprint for each of the given radii, reading the input raster once. The radii counted by the prefix sums are counted in a single scan
+    TEGROWTHEXPORT void classifyUrbanAreasRadiusSweep(ClassifyRadiusSweepParams* params);
+
+    //step 3 - this reclassification analyses the entire raster. Classify the urban open area. The kernel is only used if the mask cannot be replaced by a distance threshold
+    TEGROWTHEXPORT void classifyUrbanOpenArea(te::rst::Raster* urbanFootprintRaster, double radius, NeighborhoodKernel kernel = KERNEL_AUTOMATIC, std::size_t numberOfThreads = 0);
+
+    //step 3 in streaming mode - the footprint is read strip by strip into a ring of rows, and the classified strips are written into the output raster
+    TEGROWTHEXPORT void classifyUrbanOpenAreaStreaming(te::rst::Raster* urbanFootprintRaster, double radius, NeighborhoodKernel kernel, std::size_t numberOfThreads, te::rst::Raster* outputRaster);
 
     //step 4 - this reclassification analyses the entire raster and returns a binary image containing the areas lower than 100 hectares that are completely sorrounded by urban areas
     TEGROWTHEXPORT std::auto_ptr<te::rst::Raster> identifyIsolatedOpenPatches(te::rst::Raster* raster, const std::string& outputPath, const std::string& outputPrefix, bool saveIntermediateFiles);
@@ -112,11 +231,14 @@ namespace te
     //steps 4 and 5
     TEGROWTHEXPORT void classifyIsolatedOpenPatches(te::rst::Raster* raster, const std::string& outputPath, const std::string& outputPrefix, bool saveIntermediateFiles);
 
-    //the indexes calculation only considers the study area
+    //the indexes calculation only considers the study area. To avoid counting the neighborhoods twice, prefer calculating the indexes during the classification, with PrepareRasterParams::m_urbanIndexesParams
     TEGROWTHEXPORT void calculateUrbanIndexes(CalculateUrbanIndexesParams* parms);
 
     TEGROWTHEXPORT void prepareRaster(PrepareRasterParams* params);
 
+    //!< Returns the key of the results of prepareRaster in the result cache. It is the hash of the input key, the classes, the radius, the grid of the input, the study area of the indexes and the version of the algorithms
+    TEGROWTHEXPORT std::string createPrepareRasterCacheKey(PrepareRasterParams* params);
+
     //step 9 - analyze new development
     TEGROWTHEXPORT void compareRasterPeriods(CompareTimePeriodsParams* params);
   }
@@ -24,6 +24,11 @@ TerraLib Team at <terralib-team@terralib.org>.
 */
 
 #include "Utils.h"
+#include "BlockCachedRaster.h"
+#include "ConnectedComponents.h"
+#include "Resampler.h"
+#include "NativeRaster.h"
+#include "PixelPlane.h"
 
 #include <terralib/common.h>
 #include <terralib/common/TerraLib.h>
@@ -33,6 +38,7 @@ TerraLib Team at <terralib-team@terralib.org>.
 #include <terralib/dataaccess/datasource/DataSourceFactory.h>
 #include <terralib/dataaccess/utils/Utils.h>
 #include <terralib/geometry/Coord2D.h>
+#include <terralib/geometry/Envelope.h>
 #include <terralib/geometry/Geometry.h>
 #include <terralib/geometry/GeometryCollection.h>
 #include <terralib/geometry/GeometryProperty.h>
@@ -42,6 +48,7 @@ TerraLib Team at <terralib-team@terralib.org>.
 #include <terralib/memory/DataSet.h>
 #include <terralib/memory/DataSetItem.h>
 #include <terralib/plugin.h>
+#include <terralib/raster/Grid.h>
 #include <terralib/raster/PositionIterator.h>
 #include <terralib/raster/Raster.h>
 #include <terralib/raster/RasterFactory.h>
@@ -49,14 +56,224 @@ TerraLib Team at <terralib-team@terralib.org>.
 #include <terralib/raster/RasterSummaryManager.h>
 #include <terralib/raster/Utils.h>
 #include <terralib/sam/kdtree.h>
-#include <terralib/srs/Converter.h>
 #include <terralib/srs/Datum.h>
 #include <terralib/srs/Ellipsoid.h>
 #include <terralib/srs/GeographicCoordinateSystem.h>
 #include <terralib/srs/SpatialReferenceSystemManager.h>
 #include <terralib/vp/Utils.h>
 
+#include <boost/lexical_cast.hpp>
+
+#include <cmath>
 #include <cstdlib>
+#include <cstring>
+
+namespace te
+{
+  namespace urban
+  {
+    //!< Copies the aligned pixels in strips of the data type of the output band
+    template<class T> void copyAlignedRows(te::rst::Raster* inputRaster, te::rst::Raster* outputRaster, int columnOffset, int rowOffset, double noDataValue)
+    {
+      int numRows = (int)outputRaster->getNumberOfRows();
+      int numColumns = (int)outputRaster->getNumberOfColumns();
+      int inputNumRows = (int)inputRaster->getNumberOfRows();
+      int inputNumColumns = (int)inputRaster->getNumberOfColumns();
+
+      //the output columns that are inside the input, which are the same for all the rows
+      int firstColumn = std::max(0, -columnOffset);
+      int lastColumn = std::min(numColumns, inputNumColumns - columnOffset);
+
+      std::size_t stripNumRows = getStripNumberOfRows(outputRaster);
+
+      PixelPlane<T> inputStrip;
+      for (int stripFirstRow = 0; stripFirstRow < numRows; stripFirstRow += (int)stripNumRows)
+      {
+        int stripLastRow = std::min(stripFirstRow + (int)stripNumRows, numRows);
+
+        PixelPlane<T> outputStrip((std::size_t)(stripLastRow - stripFirstRow), (std::size_t)numColumns, (T)noDataValue);
+        outputStrip.setFirstRow((std::size_t)stripFirstRow);
+
+        //only the input rows of the strip are read
+        int inputFirstRow = std::max(stripFirstRow + rowOffset, 0);
+        int inputLastRow = std::min(stripLastRow + rowOffset, inputNumRows);
+
+        if (inputFirstRow < inputLastRow && firstColumn < lastColumn)
+        {
+          inputStrip.read(inputRaster, 0, (std::size_t)inputFirstRow, (std::size_t)(inputLastRow - inputFirstRow));
+
+          for (int inputRow = inputFirstRow; inputRow < inputLastRow; ++inputRow)
+          {
+            const T* source = inputStrip.getRow((std::size_t)(inputRow - inputFirstRow)) + firstColumn + columnOffset;
+            T* target = outputStrip.getRow((std::size_t)(inputRow - rowOffset - stripFirstRow)) + firstColumn;
+
+            std::memcpy(target, source, (std::size_t)(lastColumn - firstColumn) * sizeof(T));
+          }
+        }
+
+        outputStrip.write(outputRaster);
+      }
+    }
+
+    //!< Copies the window of the given band into the same band of the window raster, in strips of the data type of the band
+    template<class T> void copyWindowRows(te::rst::Raster* raster, te::rst::Raster* windowRaster, std::size_t band, const RasterWindow& window)
+    {
+      std::size_t stripNumRows = getStripNumberOfRows(raster, band);
+
+      PixelPlane<T> strip;
+      for (std::size_t stripFirstRow = 0; stripFirstRow < window.m_numRows; stripFirstRow += stripNumRows)
+      {
+        std::size_t numRows = std::min(stripNumRows, window.m_numRows - stripFirstRow);
+
+        //only the blocks of the window are read, and the strip is written at its position in the window
+        strip.read(raster, band, window.m_firstRow + stripFirstRow, numRows, window.m_firstColumn, window.m_numColumns);
+        strip.setFirstRow(stripFirstRow);
+        strip.setFirstColumn(0);
+
+        strip.write(windowRaster, band);
+      }
+    }
+
+    //!< Remaps the pixels of the input into the output in strips of the given pixel type
+    template<class T> void reclassifyRows(te::rst::Raster* inputRaster, te::rst::Raster* outputRaster, const std::vector<ReclassifyInfo>& vecMap, ReclassifyMissingValuesPolicy missingValuesPolicy, double sourceNoDataValue, double outputNoDataValue)
+    {
+      std::size_t numRows = inputRaster->getNumberOfRows();
+      std::size_t numColumns = inputRaster->getNumberOfColumns();
+
+      //the remapped values replace the input values in the strip, which is then written to the output
+      std::size_t stripNumRows = getStripNumberOfRows(inputRaster);
+
+      PixelPlane<T> strip;
+      for (std::size_t stripFirstRow = 0; stripFirstRow < numRows; stripFirstRow += stripNumRows)
+      {
+        strip.read(inputRaster, 0, stripFirstRow, stripNumRows);
+
+        for (std::size_t currentRow = 0; currentRow < strip.getNumberOfRows(); ++currentRow)
+        {
+          T* values = strip.getRow(currentRow);
+
+          for (std::size_t currentColumn = 0; currentColumn < numColumns; ++currentColumn)
+          {
+            //gets the value of the current center pixel
+            double oldValue = values[currentColumn];
+            double newValue = sourceNoDataValue;
+
+            //if the value is no data, we do not need to remap
+
+            bool isValueMissing = true;
+            //here we do the remap. 
+            //we try to find if the pixel from source is equal or inside an interval in any given remap info.
+            for (std::size_t v = 0; v < vecMap.size(); ++v)
+            {
+              const ReclassifyInfo& info = vecMap[v];
+            
+              if (info.m_singleValueRemap == true)
+              {
+                if (info.m_sourceInitialValue == oldValue)
+                {
+                  newValue = info.m_outputValue;
+                  isValueMissing = false;
+                  break;
+                }
+              }
+              else
+              {
+                if (oldValue >= info.m_sourceInitialValue && oldValue <= info.m_sourceFinalValue)
+                {
+                  newValue = info.m_outputValue;
+                  isValueMissing = false;
+                  break;
+                }
+              }
+            }
+
+            //if we were no able to remap the current value, we decide what to do based on the missing values policy
+            if (isValueMissing)
+            {
+              if (missingValuesPolicy == SET_SOURCE_DATA)
+              {
+                newValue = oldValue;
+              }
+              else if (missingValuesPolicy == SET_SOURCE_NODATA)
+              {
+                newValue = sourceNoDataValue;
+              }
+              else if (missingValuesPolicy == SET_NEW_DATA || missingValuesPolicy == SET_NEW_NODATA)
+              {
+                newValue = outputNoDataValue;
+              }
+            }
+
+            values[currentColumn] = (T)newValue;
+          }
+        }
+
+        strip.write(outputRaster);
+      }
+    }
+
+    //!< Calculates the slope of the input into the output in strips of the given pixel type
+    template<class T> void calculateSlopeRows(te::rst::Raster const* inputRst, te::rst::Raster* outRaster, double rasterDummy, double rx, double ry, double radianToDegrees, te::common::TaskProgress& task)
+    {
+      unsigned int nlines = outRaster->getNumberOfRows();
+      unsigned int ncolumns = outRaster->getNumberOfColumns();
+
+      //the input is read in strips with one extra row above and below, so the window of every pixel of the strip is available
+      std::size_t stripNumRows = getStripNumberOfRows(inputRst);
+
+      PixelPlane<T> inputStrip;
+      PixelPlane<unsigned char> outputStrip;
+
+      for (std::size_t stripFirstLine = 1; stripFirstLine + 1 < nlines; stripFirstLine += stripNumRows)
+      {
+        std::size_t stripLastLine = std::min(stripFirstLine + stripNumRows, (std::size_t)nlines - 1);
+
+        inputStrip.read(inputRst, 0, stripFirstLine - 1, (stripLastLine - stripFirstLine) + 2);
+        outputStrip.read(outRaster, 0, stripFirstLine, stripLastLine - stripFirstLine);
+
+        for (std::size_t line = stripFirstLine; line < stripLastLine; ++line)
+        {
+          //the rows of the window of the current line
+          const T* previousRow = inputStrip.getRow(line - stripFirstLine);
+          const T* currentRow = inputStrip.getRow(line - stripFirstLine + 1);
+          const T* nextRow = inputStrip.getRow(line - stripFirstLine + 2);
+
+          unsigned char* outputRow = outputStrip.getRow(line - stripFirstLine);
+
+          for (unsigned int column = 1; column < ncolumns - 1; ++column)
+          {
+            double centerPixelValue = currentRow[column];
+
+            if (centerPixelValue != rasterDummy)
+            {
+              //the dummy neighbors assume the value of the center pixel
+              double z1 = (previousRow[column - 1] != rasterDummy) ? previousRow[column - 1] : centerPixelValue;
+              double z2 = (previousRow[column] != rasterDummy) ? previousRow[column] : centerPixelValue;
+              double z3 = (previousRow[column + 1] != rasterDummy) ? previousRow[column + 1] : centerPixelValue;
+              double z4 = (currentRow[column - 1] != rasterDummy) ? currentRow[column - 1] : centerPixelValue;
+              double z6 = (currentRow[column + 1] != rasterDummy) ? currentRow[column + 1] : centerPixelValue;
+              double z7 = (nextRow[column - 1] != rasterDummy) ? nextRow[column - 1] : centerPixelValue;
+              double z8 = (nextRow[column] != rasterDummy) ? nextRow[column] : centerPixelValue;
+              double z9 = (nextRow[column + 1] != rasterDummy) ? nextRow[column + 1] : centerPixelValue;
+
+              double d = (z3 + (2*z6) + z9 - z1 - (2*z4) - z7) / (8 * rx);
+              double e = (z7 + (2 * z8) + z9 - z1 - (2 * z2) - z3) / (8 * ry);
+
+              double riseRun = std::sqrt(d*d + e*e);
+              double slopeAngle = std::atan(riseRun) * radianToDegrees;
+
+              outputRow[column] = (unsigned char)te::rst::Round(slopeAngle);
+            }
+          }
+
+          task.pulse();
+        }
+
+        outputStrip.write(outRaster);
+      }
+    }
+  }
+}
 
 void te::urban::init()
 {
@@ -166,8 +383,14 @@ std::auto_ptr<te::rst::Raster> te::urban::cloneRasterIntoMem(te::rst::Raster* ra
   return rOut;
 }
 
-std::auto_ptr<te::rst::Raster> te::urban::openRaster(const std::string& fileName)
+std::auto_ptr<te::rst::Raster> te::urban::openRaster(const std::string& fileName, RasterAccess access, std::size_t cacheSize)
 {
+  //the native rasters are mapped into memory, so their pages are already read only when they are accessed
+  if (isNativeRasterFile(fileName))
+  {
+    return openNativeRaster(fileName);
+  }
+
   std::map<std::string, std::string> rasterInfo;
   rasterInfo["URI"] = fileName;
 
@@ -178,10 +401,138 @@ std::auto_ptr<te::rst::Raster> te::urban::openRaster(const std::string& fileName
     throw te::common::Exception("The SRID of the openned raster is invalid. Error in function: openRaster");
   }
 
+  if (access == RASTER_FILE)
+  {
+    return rasterPointer;
+  }
+
+  if (access == RASTER_BLOCK_CACHE)
+  {
+    std::auto_ptr<te::rst::Raster> cachedRaster(new BlockCachedRaster(rasterPointer.release(), cacheSize, TEGROWTH_RASTER_PREFETCH_THRESHOLD));
+    return cachedRaster;
+  }
+
   std::auto_ptr<te::rst::Raster> memRaster = cloneRasterIntoMem(rasterPointer.get(), true, rasterPointer->getBand(0)->getProperty()->getType());
   return memRaster;
 }
 
+bool te::urban::calculateRasterWindow(te::rst::Raster* raster, const te::gm::Envelope& envelope, std::size_t haloPixels, RasterWindow& window)
+{
+  assert(raster);
+
+  const te::gm::Envelope* extent = raster->getExtent();
+  double resX = raster->getResolutionX();
+  double resY = raster->getResolutionY();
+  double halo = (double)haloPixels;
+
+  //the grid coordinates of the pixels that contain the corners of the envelope, expanded by the halo
+  double firstColumn = std::floor((envelope.m_llx - extent->m_llx) / resX) - halo;
+  double lastColumn = std::ceil((envelope.m_urx - extent->m_llx) / resX) - 1. + halo;
+  double firstRow = std::floor((extent->m_ury - envelope.m_ury) / resY) - halo;
+  double lastRow = std::ceil((extent->m_ury - envelope.m_lly) / resY) - 1. + halo;
+
+  //then we limit the window to the raster
+  firstColumn = std::max(firstColumn, 0.);
+  firstRow = std::max(firstRow, 0.);
+  lastColumn = std::min(lastColumn, (double)raster->getNumberOfColumns() - 1.);
+  lastRow = std::min(lastRow, (double)raster->getNumberOfRows() - 1.);
+
+  if (lastColumn < firstColumn || lastRow < firstRow)
+  {
+    return false;
+  }
+
+  window.m_firstColumn = (std::size_t)firstColumn;
+  window.m_firstRow = (std::size_t)firstRow;
+  window.m_numColumns = (std::size_t)(lastColumn - firstColumn) + 1;
+  window.m_numRows = (std::size_t)(lastRow - firstRow) + 1;
+
+  return true;
+}
+
+std::auto_ptr<te::rst::Raster> te::urban::readRasterWindow(te::rst::Raster* raster, const RasterWindow& window)
+{
+  assert(raster);
+  assert(window.m_firstColumn + window.m_numColumns <= raster->getNumberOfColumns());
+  assert(window.m_firstRow + window.m_numRows <= raster->getNumberOfRows());
+
+  std::vector<te::rst::BandProperty*> bprops;
+  for (std::size_t t = 0; t < raster->getNumberOfBands(); ++t)
+  {
+    te::rst::Band* band = raster->getBand(t);
+
+    te::rst::BandProperty* bp = new te::rst::BandProperty(t, band->getProperty()->getType());
+    bp->m_noDataValue = band->getProperty()->m_noDataValue;
+
+    bprops.push_back(bp);
+  }
+
+  //the extent of the window, given by the outer borders of its pixels
+  const te::gm::Envelope* extent = raster->getExtent();
+  double resX = raster->getResolutionX();
+  double resY = raster->getResolutionY();
+
+  double llx = extent->m_llx + window.m_firstColumn * resX;
+  double ury = extent->m_ury - window.m_firstRow * resY;
+  te::gm::Envelope* windowExtent = new te::gm::Envelope(llx, ury - window.m_numRows * resY, llx + window.m_numColumns * resX, ury);
+
+  te::rst::Grid* windowGrid = new te::rst::Grid((unsigned int)window.m_numColumns, (unsigned int)window.m_numRows, windowExtent, raster->getSRID());
+
+  std::map< std::string, std::string > dummyRInfo;
+
+  std::auto_ptr<te::rst::Raster> windowRaster(te::rst::RasterFactory::make("MEM", windowGrid, bprops, dummyRInfo, 0, 0));
+
+  //each band is copied in its own data type
+  for (std::size_t t = 0; t < raster->getNumberOfBands(); ++t)
+  {
+    switch (raster->getBand(t)->getProperty()->getType())
+    {
+      case te::dt::CHAR_TYPE: copyWindowRows<char>(raster, windowRaster.get(), t, window); break;
+      case te::dt::UCHAR_TYPE: copyWindowRows<unsigned char>(raster, windowRaster.get(), t, window); break;
+      case te::dt::INT16_TYPE: copyWindowRows<short>(raster, windowRaster.get(), t, window); break;
+      case te::dt::UINT16_TYPE: copyWindowRows<unsigned short>(raster, windowRaster.get(), t, window); break;
+      case te::dt::INT32_TYPE: copyWindowRows<int>(raster, windowRaster.get(), t, window); break;
+      case te::dt::UINT32_TYPE: copyWindowRows<unsigned int>(raster, windowRaster.get(), t, window); break;
+      case te::dt::FLOAT_TYPE: copyWindowRows<float>(raster, windowRaster.get(), t, window); break;
+      default: copyWindowRows<double>(raster, windowRaster.get(), t, window); break;
+    }
+  }
+
+  return windowRaster;
+}
+
+std::auto_ptr<te::rst::Raster> te::urban::openRasterWindow(const std::string& fileName, const te::gm::Envelope& envelope, int envelopeSRID, double haloDistance)
+{
+  //the blocks are only read when they are accessed, so the blocks outside the window are never read
+  std::auto_ptr<te::rst::Raster> fileRaster = openRaster(fileName, RASTER_BLOCK_CACHE);
+
+  te::gm::Envelope rasterEnvelope(envelope);
+  if (envelopeSRID != fileRaster->getSRID())
+  {
+    rasterEnvelope.transform(envelopeSRID, fileRaster->getSRID());
+  }
+
+  std::size_t haloPixels = 0;
+  if (haloDistance > 0.)
+  {
+    haloPixels = (std::size_t)std::ceil(haloDistance / fileRaster->getResolutionX());
+  }
+
+  RasterWindow window;
+  if (calculateRasterWindow(fileRaster.get(), rasterEnvelope, haloPixels, window) == false)
+  {
+    throw te::common::Exception("The region of interest does not intersect the raster " + fileName + ". Error in function: openRasterWindow");
+  }
+
+  std::auto_ptr<te::rst::Raster> windowRaster = readRasterWindow(fileRaster.get(), window);
+
+  std::size_t numPixels = (std::size_t)fileRaster->getNumberOfRows() * fileRaster->getNumberOfColumns();
+  std::size_t numWindowPixels = window.m_numRows * window.m_numColumns;
+  logInfo("openRasterWindow read " + boost::lexical_cast<std::string>(numWindowPixels) + " of the " + boost::lexical_cast<std::string>(numPixels) + " pixels of " + fileName);
+
+  return windowRaster;
+}
+
 std::auto_ptr<te::da::DataSet> te::urban::openVector(const std::string& fileName)
 {
   std::map<std::string, std::string> srcInfo;
@@ -259,9 +610,43 @@ std::auto_ptr<te::gm::Geometry> te::urban::dissolveDataSet(te::da::DataSet* data
   return result;
 }
 
-std::auto_ptr<te::rst::Raster> te::urban::createRaster(const std::string& fileName, te::rst::Raster* raster)
+void te::urban::addRasterCreationOptions(const RasterCreationOptions& options, std::map<std::string, std::string>& rasterInfo)
+{
+  rasterInfo["TILED"] = options.m_tiled ? "YES" : "NO";
+  if (options.m_tiled)
+  {
+    rasterInfo["BLOCKXSIZE"] = boost::lexical_cast<std::string>(options.m_blockSize);
+    rasterInfo["BLOCKYSIZE"] = boost::lexical_cast<std::string>(options.m_blockSize);
+  }
+
+  switch (options.m_compression)
+  {
+    case RASTER_COMPRESSION_NONE: rasterInfo["COMPRESS"] = "NONE"; break;
+    case RASTER_COMPRESSION_DEFLATE: rasterInfo["COMPRESS"] = "DEFLATE"; break;
+    case RASTER_COMPRESSION_LZW: rasterInfo["COMPRESS"] = "LZW"; break;
+    case RASTER_COMPRESSION_ZSTD: rasterInfo["COMPRESS"] = "ZSTD"; break;
+  }
+
+  //the class rasters have long runs of the same value, so the differences between neighbor pixels compress better than the values
+  if (options.m_compression != RASTER_COMPRESSION_NONE && options.m_predictor)
+  {
+    rasterInfo["PREDICTOR"] = "2";
+  }
+
+  rasterInfo["BIGTIFF"] = options.m_bigTiff ? "IF_SAFER" : "NO";
+
+  //the tiles are compressed in parallel by GDAL
+  if (options.m_compression != RASTER_COMPRESSION_NONE)
+  {
+    rasterInfo["NUM_THREADS"] = options.m_numberOfThreads == 0 ? "ALL_CPUS" : boost::lexical_cast<std::string>(options.m_numberOfThreads);
+  }
+}
+
+std::auto_ptr<te::rst::Raster> te::urban::createRaster(const std::string& fileName, te::rst::Raster* raster, const RasterCreationOptions& options)
 {
+  //the entries of the raster info other than the URI are given to GDAL as creation options
   std::map<std::string, std::string> rasterInfo;
+  addRasterCreationOptions(options, rasterInfo);
   rasterInfo["URI"] = fileName;
 
   std::vector<te::rst::BandProperty*> bandsProperties;
@@ -271,12 +656,20 @@ std::auto_ptr<te::rst::Raster> te::urban::createRaster(const std::string& fileNa
 
     bp->m_noDataValue = 0.;
 
+    if (options.m_tiled)
+    {
+      bp->m_blkw = (int)options.m_blockSize;
+      bp->m_blkh = (int)options.m_blockSize;
+      bp->m_nblocksx = (int)((raster->getNumberOfColumns() + options.m_blockSize - 1) / options.m_blockSize);
+      bp->m_nblocksy = (int)((raster->getNumberOfRows() + options.m_blockSize - 1) / options.m_blockSize);
+    }
+
     bandsProperties.push_back(bp);
   }
   
   te::rst::Raster* createdRaster = te::rst::RasterFactory::make("GDAL", new te::rst::Grid(*(raster->getGrid())), bandsProperties, rasterInfo, 0, 0);
 
-  te::rst::FillRaster(createdRaster, 0.);
+  //GDAL reads the blocks that were never written as 0, so the raster is not filled. Filling it would write each tile twice, and a rewritten compressed tile is appended to the file
 
   std::auto_ptr<te::rst::Raster> createdRasterPtr(createdRaster);
   return createdRasterPtr;
@@ -294,14 +687,26 @@ std::auto_ptr<te::da::DataSource> te::urban::createDataSourceOGR(const std::stri
   return dsOGR;
 }
 
-void te::urban::saveRaster(const std::string& fileName, te::rst::Raster* raster)
+void te::urban::saveRaster(const std::string& fileName, te::rst::Raster* raster, const RasterCreationOptions& options)
 {
   if (raster->getSRID() <= 0)
   {
     throw te::common::Exception("The SRID of the raster data is invalid. Error in function: saveRaster");
   }
 
-  std::auto_ptr<te::rst::Raster> outputRaster = createRaster(fileName, raster);
+  if (isNativeRasterFile(fileName))
+  {
+    NativeRasterCompression compression = NATIVE_RASTER_COMPRESSION_NONE;
+    if (options.m_compression != RASTER_COMPRESSION_NONE && isNativeRasterCompressionSupported(NATIVE_RASTER_COMPRESSION_LZ4))
+    {
+      compression = NATIVE_RASTER_COMPRESSION_LZ4;
+    }
+
+    saveNativeRaster(fileName, raster, compression);
+    return;
+  }
+
+  std::auto_ptr<te::rst::Raster> outputRaster = createRaster(fileName, raster, options);
   te::rst::Copy(*raster, *outputRaster);
 }
 
@@ -409,66 +814,103 @@ bool te::urban::needNormalization(te::rst::Raster* inputRaster, te::rst::Raster*
   return normalize;
 }
 
-std::auto_ptr<te::rst::Raster> te::urban::normalizeRaster(te::rst::Raster* inputRaster, te::rst::Raster* referenceRaster)
+bool te::urban::calculateAlignedGridOffset(const te::rst::Grid* targetGrid, const te::rst::Grid* sourceGrid, int& columnOffset, int& rowOffset)
+{
+  assert(targetGrid);
+  assert(sourceGrid);
+
+  if (targetGrid->getSRID() != sourceGrid->getSRID())
+  {
+    return false;
+  }
+
+  double resX = sourceGrid->getResolutionX();
+  double resY = sourceGrid->getResolutionY();
+
+  //the difference of the resolutions accumulates along the grid, so it must be within the tolerance at its last pixel
+  std::size_t numColumns = std::max(targetGrid->getNumberOfColumns(), sourceGrid->getNumberOfColumns());
+  std::size_t numRows = std::max(targetGrid->getNumberOfRows(), sourceGrid->getNumberOfRows());
+
+  if (std::fabs(targetGrid->getResolutionX() - resX) * numColumns > TEGROWTH_ALIGNED_GRID_TOLERANCE * resX ||
+      std::fabs(targetGrid->getResolutionY() - resY) * numRows > TEGROWTH_ALIGNED_GRID_TOLERANCE * resY)
+  {
+    return false;
+  }
+
+  double column = (targetGrid->getExtent()->m_llx - sourceGrid->getExtent()->m_llx) / resX;
+  double row = (sourceGrid->getExtent()->m_ury - targetGrid->getExtent()->m_ury) / resY;
+
+  if (std::fabs(column - te::rst::Round(column)) > TEGROWTH_ALIGNED_GRID_TOLERANCE || std::fabs(row - te::rst::Round(row)) > TEGROWTH_ALIGNED_GRID_TOLERANCE)
+  {
+    return false;
+  }
+
+  columnOffset = te::rst::Round(column);
+  rowOffset = te::rst::Round(row);
+
+  return true;
+}
+
+void te::urban::copyAlignedRaster(te::rst::Raster* inputRaster, te::rst::Raster* outputRaster, int columnOffset, int rowOffset, double noDataValue)
+{
+  assert(inputRaster);
+  assert(outputRaster);
+
+  //the pixels are only copied, so they are held in the data type of the output
+  switch (outputRaster->getBand(0)->getProperty()->getType())
+  {
+    case te::dt::CHAR_TYPE: copyAlignedRows<char>(inputRaster, outputRaster, columnOffset, rowOffset, noDataValue); break;
+    case te::dt::UCHAR_TYPE: copyAlignedRows<unsigned char>(inputRaster, outputRaster, columnOffset, rowOffset, noDataValue); break;
+    case te::dt::INT16_TYPE: copyAlignedRows<short>(inputRaster, outputRaster, columnOffset, rowOffset, noDataValue); break;
+    case te::dt::UINT16_TYPE: copyAlignedRows<unsigned short>(inputRaster, outputRaster, columnOffset, rowOffset, noDataValue); break;
+    case te::dt::INT32_TYPE: copyAlignedRows<int>(inputRaster, outputRaster, columnOffset, rowOffset, noDataValue); break;
+    case te::dt::UINT32_TYPE: copyAlignedRows<unsigned int>(inputRaster, outputRaster, columnOffset, rowOffset, noDataValue); break;
+    case te::dt::FLOAT_TYPE: copyAlignedRows<float>(inputRaster, outputRaster, columnOffset, rowOffset, noDataValue); break;
+    default: copyAlignedRows<double>(inputRaster, outputRaster, columnOffset, rowOffset, noDataValue); break;
+  }
+}
+
+std::auto_ptr<te::rst::Raster> te::urban::normalizeRaster(te::rst::Raster* inputRaster, te::rst::Raster* referenceRaster, double maxError)
 {
   assert(inputRaster);
   assert(referenceRaster);
 
   double m_inputNoData = inputRaster->getBand(0)->getProperty()->m_noDataValue;
-  bool changeSRID = inputRaster->getSRID() != referenceRaster->getSRID();
 
   //we first clone the reference raster metadata. this raster will receive the values from the input raster
   std::auto_ptr<te::rst::Raster> normalizedRaster = cloneRasterIntoMem(referenceRaster, false);
   
-  unsigned int numRows = normalizedRaster->getNumberOfRows();
-  unsigned int numColumns = normalizedRaster->getNumberOfColumns();
+  std::size_t numRows = normalizedRaster->getNumberOfRows();
+  std::size_t numColumns = normalizedRaster->getNumberOfColumns();
 
-  unsigned int inputNumRows = inputRaster->getNumberOfRows();
-  unsigned int inputNumColumns = inputRaster->getNumberOfColumns();
+  Timer timer;
 
-  te::common::TaskProgress task("Normalizing Raster");
-  task.setTotalSteps((int)(numRows * numColumns));
-  task.useTimer(true);
-
-  //for performance purposes
-  std::auto_ptr<te::srs::Converter> converter(new te::srs::Converter());
-
-  converter->setSourceSRID(normalizedRaster->getSRID());
-  converter->setTargetSRID(inputRaster->getSRID());
-
-  //then we normalize the input raster by copying its values to the normalized raster
-  for (unsigned int currentRow = 0; currentRow < numRows; ++currentRow)
+  //the grids of the rasters of the same mosaic usually differ only by whole pixels, so the pixels are just copied
+  int columnOffset = 0;
+  int rowOffset = 0;
+  if (calculateAlignedGridOffset(normalizedRaster->getGrid(), inputRaster->getGrid(), columnOffset, rowOffset))
   {
-    for (unsigned int currentColumn = 0; currentColumn < numColumns; ++currentColumn)
-    {
-      //we first the the spatial location of the current pixel (reference rater)
-      te::gm::Coord2D refCoordGeo = normalizedRaster->getGrid()->gridToGeo((double)currentColumn, (double)currentRow);
+    copyAlignedRaster(inputRaster, normalizedRaster.get(), columnOffset, rowOffset, m_inputNoData);
 
-      //if the SRIDs are different, we must transform the CS
-      if (changeSRID)
-      {
-        converter->convert(refCoordGeo.x, refCoordGeo.y);
-      }
+    logInfo("normalizeRaster copied the aligned pixels in " + boost::lexical_cast<std::string>(timer.getElapsedTimeInSeconds()) + " seconds");
 
-      //then we find out its position in the inputRaster (source raster)
-      te::gm::Coord2D inputCoordGrid = inputRaster->getGrid()->geoToGrid(refCoordGeo.getX(), refCoordGeo.getY());
+    return normalizedRaster;
+  }
 
-      int inputColumn = te::rst::Round(inputCoordGrid.getX());
-      int inputRow = te::rst::Round(inputCoordGrid.getY());
+  //the output is resampled in tiles, by one thread per core
+  NearestNeighborResampler resampler(inputRaster, normalizedRaster.get(), maxError, m_inputNoData);
 
-      //then we get the value from the input
-      double value = m_inputNoData;
-      if (inputColumn >= 0 && inputColumn < (int)inputNumColumns && inputRow >= 0 && inputRow < (int)inputNumRows)
-      {
-        inputRaster->getValue((unsigned int)inputColumn, (unsigned int)inputRow, value);
-      }
+  std::size_t stripNumRows = getStripNumberOfRows(normalizedRaster.get(), 0, TEGROWTH_RESAMPLE_TILE_SIZE);
 
-      //finally we set value in the normalized raster
-      normalizedRaster->setValue(currentColumn, currentRow, value);
+  te::common::TaskProgress task("Normalizing Raster");
+  task.setTotalSteps((int)((numRows + stripNumRows - 1) / stripNumRows));
+  task.useTimer(true);
 
-      task.pulse();
-    }
-  }
+  resampler.resample(&task);
+
+  std::string message = "normalizeRaster transformed exactly " + boost::lexical_cast<std::string>(resampler.getNumberOfExactTransformations());
+  message += " of the " + boost::lexical_cast<std::string>(numRows * numColumns) + " pixels in " + boost::lexical_cast<std::string>(timer.getElapsedTimeInSeconds()) + " seconds";
+  logInfo(message);
 
   return normalizedRaster;
 }
@@ -607,6 +1049,16 @@ double te::urban::calculateUrbanizedArea(short centerPixelValue, const InputClas
     }
   }
 
+  return calculateUrbanizedArea(centerPixelValue, inputClassesMap, urbanPixelsCount, allPixelsCount, permUrb);
+}
+
+double te::urban::calculateUrbanizedArea(short centerPixelValue, const InputClassesMap& inputClassesMap, std::size_t urbanPixelsCount, std::size_t allPixelsCount, double& permUrb)
+{
+  permUrb = 0.;
+
+  const short InputUrban = inputClassesMap.find(INPUT_URBAN)->second;
+  const short InputOther = inputClassesMap.find(INPUT_OTHER)->second;
+
   //all adjacent pixels are NOT_DATA
   if (allPixelsCount == 0)
   {
@@ -685,6 +1137,14 @@ double te::urban::calculateUrbanFootprint(short centerPixelValue, const InputCla
       ++urbanPixelsCount;
     }
   }
+
+  return calculateUrbanFootprint(centerPixelValue, inputClassesMap, urbanPixelsCount, allPixelsCount, permUrb);
+}
+
+double te::urban::calculateUrbanFootprint(short centerPixelValue, const InputClassesMap& inputClassesMap, std::size_t urbanPixelsCount, std::size_t allPixelsCount, double& permUrb)
+{
+  const short InputUrban = inputClassesMap.find(INPUT_URBAN)->second;
+
   //all adjacent pixels are NOT_DATA
   if (allPixelsCount == 0)
   {
@@ -775,7 +1235,7 @@ bool te::urban::calculateEdge(te::rst::Raster* raster, const InputClassesMap& in
     }
   }
 
-  if (line < numRows)
+  if (line + 1 < numRows)
   {
     raster->getValue((unsigned int)column, (unsigned int)(line + 1), value, 0);
     if (value != InputUrban)
@@ -784,7 +1244,7 @@ bool te::urban::calculateEdge(te::rst::Raster* raster, const InputClassesMap& in
     }
   }
 
-  if (column < numColumns)
+  if (column + 1 < numColumns)
   {
     raster->getValue((unsigned int)(column + 1), (unsigned int)line, value, 0);
     if (value != InputUrban)
@@ -824,149 +1284,34 @@ std::vector<te::gm::Geometry*> te::urban::getGaps(const std::vector<te::gm::Geom
   return vecOutput;
 }
 
-std::auto_ptr<te::rst::Raster> te::urban::createDistinctGroups(te::rst::Raster* inputRaster, const std::string& outputPath, const std::string& outputPrefix)
+std::auto_ptr<te::rst::Raster> te::urban::createDistinctGroups(te::rst::Raster* inputRaster, const std::string& outputPath, const std::string& outputPrefix, bool exportVectorizedGroups, bool streamTiles)
 {
   assert(inputRaster);
 
-  //we first vectorize the raster
-  std::vector<te::gm::Geometry*> vecGeometries;
-  inputRaster->vectorize(vecGeometries, 0);
-
-  if (vecGeometries.empty())
-  {
-    std::auto_ptr<te::rst::Raster> outputRaster = cloneRasterIntoMem(inputRaster, false);
-    return outputRaster;
-  }
-
-  std::vector<te::gm::Geometry*> vecFixedGeometries = te::urban::fixGeometries(vecGeometries);
-
-  if (vecFixedGeometries.empty())
-  {
-    std::auto_ptr<te::rst::Raster> outputRaster = cloneRasterIntoMem(inputRaster, false);
-    return outputRaster;
-  }
-
-  //here we defined the dataType of the raster. We must not consider the dummy value
-  int dataType = te::dt::UCHAR_TYPE;
-  if (vecFixedGeometries.size() >= 255)
-  {
-    dataType = te::dt::INT16_TYPE;
-    if (vecFixedGeometries.size() >= 65536)
-    {
-      dataType = te::dt::INT32_TYPE;
-    }
-  }
+  //the regions that touch each other, even by a corner, are the same group. So the groups are the 8-connected components of the raster, labeled tile by tile in parallel
+  std::size_t numGroups = 0;
+  ConnectedComponentsLabeler labeler(inputRaster, 0, TEGROWTH_LABEL_TILE_SIZE, streamTiles);
+  std::auto_ptr<te::rst::Raster> outputRaster = labeler.label(numGroups);
 
-  std::auto_ptr<te::rst::Raster> outputRaster = cloneRasterIntoMem(inputRaster, false, dataType);
-
-  std::string vectorizedCandidatesFileName = outputPrefix + "_vectorized_distinct_groups";
-  std::string vectorizedCandidatesFilePath = outputPath + "/" + outputPrefix + "_vectorized_distinct_groups.shp";
-  saveVector(vectorizedCandidatesFileName, vectorizedCandidatesFilePath, vecFixedGeometries, inputRaster->getSRID());
-
-  //now, for each polygon, we one different color in the output raster. We use the index of the FOR as the color
-  //all the regions that touch another region must be given the same value
-
-  //we first index all the geometries
-  std::vector<bool> vecProcessed(vecFixedGeometries.size(), false);
-  std::set<std::size_t> setNextToBeProcessed;
-
-  te::sam::rtree::Index<size_t, 8> spatialIndex;
-  for (std::size_t i = 0; i < vecFixedGeometries.size(); ++i)
+  //the vectorized regions are only an export for the visual analysis of the groups, as they are not needed to create them
+  if (exportVectorizedGroups == true && numGroups > 0)
   {
-    te::gm::Geometry* geometry = vecFixedGeometries[i];
+    std::vector<te::gm::Geometry*> vecGeometries;
+    inputRaster->vectorize(vecGeometries, 0);
 
-    if (geometry->isValid() == false)
-    {
-      throw te::common::Exception("Invalid geometry detected after vectorization and fix. Error in function: createDistinctGroups");
-    }
+    std::vector<te::gm::Geometry*> vecFixedGeometries = te::urban::fixGeometries(vecGeometries);
 
-    if (geometry->getGeomTypeId() != te::gm::PolygonType)
+    if (vecFixedGeometries.empty() == false)
     {
-      throw te::common::Exception("Vectorization generated at least on geometry that is not a polygon. Error in function: createDistinctGroups");
+      std::string vectorizedCandidatesFileName = outputPrefix + "_vectorized_distinct_groups";
+      std::string vectorizedCandidatesFilePath = outputPath + "/" + outputPrefix + "_vectorized_distinct_groups.shp";
+      saveVector(vectorizedCandidatesFileName, vectorizedCandidatesFilePath, vecFixedGeometries, inputRaster->getSRID());
     }
 
-    spatialIndex.insert(*geometry->getMBR(), i);
-    setNextToBeProcessed.insert(i);
+    te::common::FreeContents(vecGeometries);
+    te::common::FreeContents(vecFixedGeometries);
   }
 
-  //then we start the process
-  size_t nextClassValue = 1;
-  while (setNextToBeProcessed.empty() == false)
-  {
-    std::size_t nextToBeProcessed = *setNextToBeProcessed.begin();
-    setNextToBeProcessed.erase(nextToBeProcessed);
-
-    if (vecProcessed[nextToBeProcessed] == true)
-    {
-      continue;
-    }
-
-    std::vector < te::gm::Geometry*> queueGometriesToProcess;
-
-    //if the geometry has not been processed yet, we add it to the processing queue
-    vecProcessed[nextToBeProcessed] = true;
-    queueGometriesToProcess.push_back(vecFixedGeometries[nextToBeProcessed]);
-
-    std::size_t currentClasseValue = nextClassValue;
-    ++nextClassValue;
-
-    //here we simulate recursivity
-    //in this loop, all the polygons MUST have the same class
-    while (queueGometriesToProcess.empty() == false)
-    {
-      te::gm::Geometry* currentGeometry = *queueGometriesToProcess.begin();
-      queueGometriesToProcess.erase(queueGometriesToProcess.begin());
-
-      //all the polygons that intercept the current one must have the same class
-      //we queue the analyse of all the candidates that intercept the current polygon in order to make a "recursive" analysis
-      std::vector<std::size_t> vecCandidates;
-      spatialIndex.search(*currentGeometry->getMBR(), vecCandidates);
-
-      for (std::size_t j = 0; j < vecCandidates.size(); ++j)
-      {
-        std::size_t indexCandidate = vecCandidates[j];
-
-        //we do the analysis of the candidate IF it has not been processed yet
-        if (vecProcessed[indexCandidate] == true)
-        {
-          continue;
-        }
-
-        te::gm::Geometry* candidateGeometry = vecFixedGeometries[indexCandidate];
-        if (currentGeometry->intersects(candidateGeometry))
-        {
-          //if the candidate intercept the current polygon, we added it the the queue so it will be rasterized using the same class value of the current polygon
-          vecProcessed[indexCandidate] = true;
-          queueGometriesToProcess.push_back(candidateGeometry);
-        }
-      }
-
-      //now we rasterize the polygon using the current class value
-      te::gm::Polygon* polygon = (te::gm::Polygon*) currentGeometry;
-
-      te::rst::PolygonIterator<double> it = te::rst::PolygonIterator<double>::begin(inputRaster, polygon);
-      te::rst::PolygonIterator<double> itend = te::rst::PolygonIterator<double>::end(inputRaster, polygon);
-
-      while (it != itend)
-      {
-        unsigned int currentRow = it.getRow();
-        unsigned int currentColumn = it.getColumn();
-
-        te::gm::Coord2D coord = outputRaster->getGrid()->gridToGeo(currentColumn, currentRow);
-        te::gm::Point point(coord.getX(), coord.getY(), polygon->getSRID());
-
-        if (point.intersects(polygon))
-        {
-          outputRaster->setValue(currentColumn, currentRow, (double)currentClasseValue);
-        }
-        ++it;
-      }
-    }
-  }
-
-  te::common::FreeContents(vecGeometries);
-  te::common::FreeContents(vecFixedGeometries);
-
   return outputRaster;
 }
 
@@ -981,39 +1326,53 @@ std::set<double> te::urban::detectEdgeOpenAreaGroups(te::rst::Raster* otherNewDe
   unsigned int numRows = otherNewDevRaster->getNumberOfRows();
   unsigned int numColumns = otherNewDevRaster->getNumberOfColumns();
 
-  for (unsigned int row = 0; row < numRows; ++row)
+  std::size_t stripNumRows = getStripNumberOfRows(otherNewDevRaster);
+
+  PixelPlane<unsigned char> otherNewDevStrip;
+  PixelPlane<unsigned int> otherNewDevGroupedStrip;
+  PixelPlane<unsigned char> footprintStrip;
+
+  for (std::size_t stripFirstRow = 0; stripFirstRow < numRows; stripFirstRow += stripNumRows)
   {
-    for (unsigned int column = 0; column < numColumns; ++column)
+    otherNewDevStrip.read(otherNewDevRaster, 0, stripFirstRow, stripNumRows);
+    otherNewDevGroupedStrip.read(otherNewDevGroupedRaster, 0, stripFirstRow, stripNumRows);
+    footprintStrip.read(footprintRaster, 0, stripFirstRow, stripNumRows);
+
+    for (std::size_t stripRow = 0; stripRow < otherNewDevStrip.getNumberOfRows(); ++stripRow)
     {
-      //we first read the pixel from newDev raster. If its value is not 1, we continue
-      double newDevValue = 0.;
-      otherNewDevRaster->getValue(column, row, newDevValue);
-      if (newDevValue != 1)
-      {
-        continue;
-      }
+      const unsigned char* newDevValues = otherNewDevStrip.getRow(stripRow);
+      const unsigned int* otherDevGroupedValues = otherNewDevGroupedStrip.getRow(stripRow);
+      const unsigned char* footprintValues = footprintStrip.getRow(stripRow);
+      std::size_t row = stripFirstRow + stripRow;
 
-      double otherDevGroupedValue = 0.;
-      otherNewDevGroupedRaster->getValue(column, row, otherDevGroupedValue);
+      for (std::size_t column = 0; column < numColumns; ++column)
+      {
+        //we first read the pixel from newDev raster. If its value is not 1, we continue
+        if (newDevValues[column] != 1)
+        {
+          continue;
+        }
 
-      //then we check the value of the footprint image. If 4 or 5, we register the current group in the SET
-      double footprintValue = 0.;
-      footprintRaster->getValue(column, row, footprintValue);
+        double otherDevGroupedValue = otherDevGroupedValues[column];
 
-      if (footprintValue == 4 || footprintValue == 5)
-      {
-        setGroupsWithEdges.insert(otherDevGroupedValue);
-        continue;
-      }
+        //then we check the value of the footprint image. If 4 or 5, we register the current group in the SET
+        unsigned char footprintValue = footprintValues[column];
 
-      //if we got here, we must analyse the adjacent pixels in the footprint raster looking for any urban pixel (1, 2 and 3)
-      std::vector<short> vecPixels = getAdjacentPixels(footprintRaster, row, column);
-      for (std::size_t i = 0; i < vecPixels.size(); ++i)
-      {
-        if (vecPixels[i] >= 1 && vecPixels[i] <= 3)
+        if (footprintValue == 4 || footprintValue == 5)
         {
           setGroupsWithEdges.insert(otherDevGroupedValue);
-          break;
+          continue;
+        }
+
+        //if we got here, we must analyse the adjacent pixels in the footprint raster looking for any urban pixel (1, 2 and 3)
+        std::vector<short> vecPixels = getAdjacentPixels(footprintRaster, row, column);
+        for (std::size_t i = 0; i < vecPixels.size(); ++i)
+        {
+          if (vecPixels[i] >= 1 && vecPixels[i] <= 3)
+          {
+            setGroupsWithEdges.insert(otherDevGroupedValue);
+            break;
+          }
         }
       }
     }
@@ -1022,13 +1381,13 @@ std::set<double> te::urban::detectEdgeOpenAreaGroups(te::rst::Raster* otherNewDe
   return setGroupsWithEdges;
 }
 
-void te::urban::generateInfillOtherDevRasters(te::rst::Raster* rasterT1, te::rst::Raster* rasterT2, const std::string& infillRasterFileName, const std::string& otherDevRasterFileName)
+void te::urban::generateInfillOtherDevRasters(te::rst::Raster* rasterT1, te::rst::Raster* rasterT2, std::auto_ptr<te::rst::Raster>& infillRaster, std::auto_ptr<te::rst::Raster>& otherDevRaster)
 {
   assert(rasterT1);
   assert(rasterT2);
 
-  std::auto_ptr<te::rst::Raster> infillRaster = cloneRasterIntoMem(rasterT1, false);
-  std::auto_ptr<te::rst::Raster> otherDevRaster = cloneRasterIntoMem(rasterT1, false);
+  infillRaster = cloneRasterIntoMem(rasterT1, false);
+  otherDevRaster = cloneRasterIntoMem(rasterT1, false);
 
   assert(infillRaster.get());
   assert(otherDevRaster.get());
@@ -1045,41 +1404,61 @@ void te::urban::generateInfillOtherDevRasters(te::rst::Raster* rasterT1, te::rst
     throw te::common::Exception("Raster t1 differs from raster t2 in the number of columns. Error in function: generateInfillOtherDevRasters");
   }
 
-  for (std::size_t row = 0; row < numRows; ++row)
+  std::size_t stripNumRows = getStripNumberOfRows(rasterT1);
+
+  PixelPlane<unsigned char> stripT1;
+  PixelPlane<unsigned char> stripT2;
+  PixelPlane<unsigned char> infillStrip;
+  PixelPlane<unsigned char> otherDevStrip;
+
+  for (std::size_t stripFirstRow = 0; stripFirstRow < numRows; stripFirstRow += stripNumRows)
   {
-    for (std::size_t column = 0; column < numColumns; ++column)
-    {
-      double valueT1 = 0.;
-      rasterT1->getValue((unsigned int)column, (unsigned int)row, valueT1);
+    stripT1.read(rasterT1, 0, stripFirstRow, stripNumRows);
+    stripT2.read(rasterT2, 0, stripFirstRow, stripNumRows);
 
-      double valueT2 = 0.;
-      rasterT2->getValue((unsigned int)column, (unsigned int)row, valueT2);
+    infillStrip = PixelPlane<unsigned char>(stripT1.getNumberOfRows(), numColumns, 0);
+    otherDevStrip = PixelPlane<unsigned char>(stripT1.getNumberOfRows(), numColumns, 0);
+    infillStrip.setFirstRow(stripFirstRow);
+    otherDevStrip.setFirstRow(stripFirstRow);
 
-      double valueInFill = 0;
-      double valueOtherDev = 0;
+    for (std::size_t row = 0; row < stripT1.getNumberOfRows(); ++row)
+    {
+      const unsigned char* valuesT1 = stripT1.getRow(row);
+      const unsigned char* valuesT2 = stripT2.getRow(row);
+      unsigned char* valuesInFill = infillStrip.getRow(row);
+      unsigned char* valuesOtherDev = otherDevStrip.getRow(row);
 
-      //if urban in T2
-      if (valueT2 == OUTPUT_URBAN || valueT2 == OUTPUT_SUB_URBAN || valueT2 == OUTPUT_RURAL)
+      for (std::size_t column = 0; column < numColumns; ++column)
       {
-        //if urbanized open space in T1
-        if (valueT1 == OUTPUT_URBANIZED_OS || valueT1 == OUTPUT_SUBURBAN_ZONE_OPEN_AREA)
-        {
-          valueInFill = 1;
-        }
-        else if (valueT1 == OUTPUT_RURAL_OS || valueT1 == OUTPUT_WATER)
+        unsigned char valueT1 = valuesT1[column];
+        unsigned char valueT2 = valuesT2[column];
+
+        unsigned char valueInFill = 0;
+        unsigned char valueOtherDev = 0;
+
+        //if urban in T2
+        if (valueT2 == OUTPUT_URBAN || valueT2 == OUTPUT_SUB_URBAN || valueT2 == OUTPUT_RURAL)
         {
-          valueInFill = 2;
-          valueOtherDev = 1;
+          //if urbanized open space in T1
+          if (valueT1 == OUTPUT_URBANIZED_OS || valueT1 == OUTPUT_SUBURBAN_ZONE_OPEN_AREA)
+          {
+            valueInFill = 1;
+          }
+          else if (valueT1 == OUTPUT_RURAL_OS || valueT1 == OUTPUT_WATER)
+          {
+            valueInFill = 2;
+            valueOtherDev = 1;
+          }
         }
-      }
 
-      infillRaster->setValue((unsigned int)column, (unsigned int)row, valueInFill);
-      otherDevRaster->setValue((unsigned int)column, (unsigned int)row, valueOtherDev);
+        valuesInFill[column] = valueInFill;
+        valuesOtherDev[column] = valueOtherDev;
+      }
     }
-  }
 
-  saveRaster(infillRasterFileName, infillRaster.get());
-  saveRaster(otherDevRasterFileName, otherDevRaster.get());
+    infillStrip.write(infillRaster.get());
+    otherDevStrip.write(otherDevRaster.get());
+  }
 }
 
 std::auto_ptr<te::rst::Raster> te::urban::classifyNewDevelopment(te::rst::Raster* infillRaster, te::rst::Raster* otherDevGroupedRaster, const std::set<double>& setEdgesOpenAreaGroups)
@@ -1100,40 +1479,54 @@ std::auto_ptr<te::rst::Raster> te::urban::classifyNewDevelopment(te::rst::Raster
   }
 
   std::auto_ptr<te::rst::Raster> outputRaster = cloneRasterIntoMem(infillRaster, false);
-  for (unsigned int row = 0; row < numRows; ++row)
+
+  std::size_t stripNumRows = getStripNumberOfRows(infillRaster);
+
+  PixelPlane<unsigned char> infillStrip;
+  PixelPlane<unsigned int> otherDevGroupedStrip;
+  PixelPlane<unsigned char> outputStrip;
+
+  for (std::size_t stripFirstRow = 0; stripFirstRow < numRows; stripFirstRow += stripNumRows)
   {
-    for (unsigned int column = 0; column < numColumns; ++column)
-    {
-      double infillValue = 0.;
-      infillRaster->getValue(column, row, infillValue);
+    infillStrip.read(infillRaster, 0, stripFirstRow, stripNumRows);
+    otherDevGroupedStrip.read(otherDevGroupedRaster, 0, stripFirstRow, stripNumRows);
 
-      double outputValue = NEWDEV_NO_DATA;
+    outputStrip = PixelPlane<unsigned char>(infillStrip.getNumberOfRows(), numColumns, NEWDEV_NO_DATA);
+    outputStrip.setFirstRow(stripFirstRow);
 
-      if (infillValue == 1)
-      {
-        //infill
-        outputValue = NEWDEV_INFILL;
-      }
-      else if (infillValue == 2)
+    for (std::size_t row = 0; row < infillStrip.getNumberOfRows(); ++row)
+    {
+      const unsigned char* infillValues = infillStrip.getRow(row);
+      const unsigned int* otherDevValues = otherDevGroupedStrip.getRow(row);
+      unsigned char* outputValues = outputStrip.getRow(row);
+
+      for (std::size_t column = 0; column < numColumns; ++column)
       {
-        double otherDevValue = 0.;
-        otherDevGroupedRaster->getValue(column, row, otherDevValue);
+        unsigned char infillValue = infillValues[column];
 
-        std::set<double>::iterator it = setEdgesOpenAreaGroups.find(otherDevValue);
-        if (it != setEdgesOpenAreaGroups.end())
+        if (infillValue == 1)
         {
-          //extension
-          outputValue = NEWDEV_EXTENSION;
+          //infill
+          outputValues[column] = NEWDEV_INFILL;
         }
-        else
+        else if (infillValue == 2)
         {
-          //leapfrog
-          outputValue = NEWDEV_LEAPFROG;
+          std::set<double>::const_iterator it = setEdgesOpenAreaGroups.find((double)otherDevValues[column]);
+          if (it != setEdgesOpenAreaGroups.end())
+          {
+            //extension
+            outputValues[column] = NEWDEV_EXTENSION;
+          }
+          else
+          {
+            //leapfrog
+            outputValues[column] = NEWDEV_LEAPFROG;
+          }
         }
       }
-
-      outputRaster->setValue(column, row, outputValue);
     }
+
+    outputStrip.write(outputRaster.get());
   }
 
   return outputRaster;
@@ -1156,18 +1549,29 @@ void te::urban::getUrbanCoordinates(te::rst::Raster* raster, std::vector<te::gm:
   //empiric value to avoid unnecessary resize (copy) of the vector. it supposes that 1/4 of the pixels are urban
   vecUrbanCoords.reserve(numRows * numColumns / 4);
 
-  for (std::size_t currentRow = 0; currentRow < numRows; ++currentRow)
+  //the raster is read in strips of its classes, which fit a byte
+  std::size_t stripNumRows = getStripNumberOfRows(raster);
+
+  PixelPlane<unsigned char> strip;
+  for (std::size_t stripFirstRow = 0; stripFirstRow < numRows; stripFirstRow += stripNumRows)
   {
-    for (std::size_t currentColumn = 0; currentColumn < numColumns; ++currentColumn)
+    strip.read(raster, 0, stripFirstRow, stripNumRows);
+
+    for (std::size_t stripRow = 0; stripRow < strip.getNumberOfRows(); ++stripRow)
     {
-      //gets the value of the current center pixel
-      double centerPixel = 0;
-      raster->getValue((unsigned int)currentColumn, (unsigned int)currentRow, centerPixel);
+      const unsigned char* values = strip.getRow(stripRow);
+      std::size_t currentRow = stripFirstRow + stripRow;
 
-      if (centerPixel == OUTPUT_URBAN || centerPixel == OUTPUT_SUB_URBAN || centerPixel == OUTPUT_URBANIZED_OS || centerPixel == OUTPUT_SUBURBAN_ZONE_OPEN_AREA)
+      for (std::size_t currentColumn = 0; currentColumn < numColumns; ++currentColumn)
       {
-        te::gm::Coord2D coord = raster->getGrid()->gridToGeo((double)currentColumn, (double)currentRow);
-        vecUrbanCoords.push_back(coord);
+        //gets the value of the current center pixel
+        unsigned char centerPixel = values[currentColumn];
+
+        if (centerPixel == OUTPUT_URBAN || centerPixel == OUTPUT_SUB_URBAN || centerPixel == OUTPUT_URBANIZED_OS || centerPixel == OUTPUT_SUBURBAN_ZONE_OPEN_AREA)
+        {
+          te::gm::Coord2D coord = raster->getGrid()->gridToGeo((double)currentColumn, (double)currentRow);
+          vecUrbanCoords.push_back(coord);
+        }
       }
     }
   }
@@ -1231,8 +1635,6 @@ std::auto_ptr<te::rst::Raster> te::urban::reclassify(te::rst::Raster* inputRaste
 
 std::auto_ptr<te::rst::Raster> te::urban::reclassify(te::rst::Raster* inputRaster, const std::vector<ReclassifyInfo>& vecMap, ReclassifyMissingValuesPolicy missingValuesPolicy, double newValue)
 {
-  unsigned int numRows = inputRaster->getNumberOfRows();
-  unsigned int numColumns = inputRaster->getNumberOfColumns();
   double sourceNoDataValue = inputRaster->getBand(0)->getProperty()->m_noDataValue;
 
   double outputNoDataValue = sourceNoDataValue;
@@ -1243,63 +1645,17 @@ std::auto_ptr<te::rst::Raster> te::urban::reclassify(te::rst::Raster* inputRaste
 
   std::auto_ptr<te::rst::Raster> outputRaster = cloneRasterIntoMem(inputRaster, false, inputRaster->getBandDataType(0), outputNoDataValue);
 
-  for (std::size_t currentRow = 0; currentRow < numRows; ++currentRow)
+  //the pixels are remapped in strips of the data type of the input, which is also the data type of the output
+  switch (inputRaster->getBandDataType(0))
   {
-    for (std::size_t currentColumn = 0; currentColumn < numColumns; ++currentColumn)
-    {
-      //gets the value of the current center pixel
-      double oldValue = 0;
-      double newValue = sourceNoDataValue;
-      inputRaster->getValue((unsigned int)currentColumn, (unsigned int)currentRow, oldValue);
-
-      //if the value is no data, we do not need to remap
-
-      bool isValueMissing = true;
-      //here we do the remap. 
-      //we try to find if the pixel from source is equal or inside an interval in any given remap info.
-      for (std::size_t v = 0; v < vecMap.size(); ++v)
-      {
-        const ReclassifyInfo& info = vecMap[v];
-        
-        if (info.m_singleValueRemap == true)
-        {
-          if (info.m_sourceInitialValue == oldValue)
-          {
-            newValue = info.m_outputValue;
-            isValueMissing = false;
-            break;
-          }
-        }
-        else
-        {
-          if (oldValue >= info.m_sourceInitialValue && oldValue <= info.m_sourceFinalValue)
-          {
-            newValue = info.m_outputValue;
-            isValueMissing = false;
-            break;
-          }
-        }
-      }
-
-      //if we were no able to remap the current value, we decide what to do based on the missing values policy
-      if (isValueMissing)
-      {
-        if (missingValuesPolicy == SET_SOURCE_DATA)
-        {
-          newValue = oldValue;
-        }
-        else if (missingValuesPolicy == SET_SOURCE_NODATA)
-        {
-          newValue = sourceNoDataValue;
-        }
-        else if (missingValuesPolicy == SET_NEW_DATA || missingValuesPolicy == SET_NEW_NODATA)
-        {
-          newValue = outputNoDataValue;
-        }
-      }
-
-      outputRaster->setValue((unsigned int)currentColumn, (unsigned int)currentRow, newValue);
-    }
+    case te::dt::CHAR_TYPE: reclassifyRows<char>(inputRaster, outputRaster.get(), vecMap, missingValuesPolicy, sourceNoDataValue, outputNoDataValue); break;
+    case te::dt::UCHAR_TYPE: reclassifyRows<unsigned char>(inputRaster, outputRaster.get(), vecMap, missingValuesPolicy, sourceNoDataValue, outputNoDataValue); break;
+    case te::dt::INT16_TYPE: reclassifyRows<short>(inputRaster, outputRaster.get(), vecMap, missingValuesPolicy, sourceNoDataValue, outputNoDataValue); break;
+    case te::dt::UINT16_TYPE: reclassifyRows<unsigned short>(inputRaster, outputRaster.get(), vecMap, missingValuesPolicy, sourceNoDataValue, outputNoDataValue); break;
+    case te::dt::INT32_TYPE: reclassifyRows<int>(inputRaster, outputRaster.get(), vecMap, missingValuesPolicy, sourceNoDataValue, outputNoDataValue); break;
+    case te::dt::UINT32_TYPE: reclassifyRows<unsigned int>(inputRaster, outputRaster.get(), vecMap, missingValuesPolicy, sourceNoDataValue, outputNoDataValue); break;
+    case te::dt::FLOAT_TYPE: reclassifyRows<float>(inputRaster, outputRaster.get(), vecMap, missingValuesPolicy, sourceNoDataValue, outputNoDataValue); break;
+    default: reclassifyRows<double>(inputRaster, outputRaster.get(), vecMap, missingValuesPolicy, sourceNoDataValue, outputNoDataValue); break;
   }
 
   return outputRaster;
@@ -1332,6 +1688,50 @@ std::auto_ptr<te::rst::Raster> te::urban::clipRaster(te::rst::Raster* inputRaste
   return outputRaster;
 }
 
+bool te::urban::createStudyAreaMask(te::rst::Raster* raster, te::gm::Geometry* spatialLimits, std::vector<unsigned char>& vecStudyArea)
+{
+  assert(raster);
+
+  vecStudyArea.clear();
+  if (spatialLimits == 0)
+  {
+    return true;
+  }
+
+  //the limits may be a multi polygon or a collection, whose polygons are all part of the study area
+  std::vector<te::gm::Geometry*> vecSingleGeometries;
+  te::gm::Multi2Single(spatialLimits, vecSingleGeometries);
+
+  std::size_t numColumns = raster->getNumberOfColumns();
+
+  bool hasPolygon = false;
+  for (std::size_t g = 0; g < vecSingleGeometries.size(); ++g)
+  {
+    te::gm::Polygon* limitPolygon = dynamic_cast<te::gm::Polygon*>(vecSingleGeometries[g]);
+    if (limitPolygon == 0)
+    {
+      continue;
+    }
+
+    if (hasPolygon == false)
+    {
+      vecStudyArea.assign(raster->getNumberOfRows() * numColumns, 0);
+      hasPolygon = true;
+    }
+
+    te::rst::PolygonIterator<double> it = te::rst::PolygonIterator<double>::begin(raster, limitPolygon);
+    te::rst::PolygonIterator<double> itend = te::rst::PolygonIterator<double>::end(raster, limitPolygon);
+
+    while (it != itend)
+    {
+      vecStudyArea[(std::size_t)it.getRow() * numColumns + it.getColumn()] = 1;
+      ++it;
+    }
+  }
+
+  return hasPolygon;
+}
+
 std::auto_ptr<te::da::DataSetType> te::urban::createDataSetType(std::string dataSetName, int srid)
 {
   std::auto_ptr<te::da::DataSetType> dsType(new te::da::DataSetType(dataSetName));
@@ -1476,111 +1876,17 @@ std::vector<te::gm::Geometry*> te::urban::fixGeometries(const std::vector<te::gm
 
   double radianToDegrees = 180. / GetConstantPI();
 
-  //calculate slope
-  for (unsigned int line = 1; line < nlines - 1; ++line)
+  //calculate slope. The input is read in strips of its data type
+  switch (inputRst->getBandDataType(0))
   {
-    for (unsigned int column = 1; column < ncolumns - 1; ++column)
-    {
-      double centerPixelValue = rasterDummy;
-
-      inputRst->getValue(column, line, centerPixelValue, 0);
-
-      if (centerPixelValue != rasterDummy)
-      {
-        double value = centerPixelValue;
-        double z1 = 0, z2 = 0, z3 = 0, z4 = 0, z6 = 0, z7 = 0, z8 = 0, z9 = 0;
-
-        inputRst->getValue(column - 1, line - 1, value, 0);
-        if (value != rasterDummy)
-        {
-          z1 = value;
-        }
-        else
-        {
-          z1 = centerPixelValue;
-        }
-
-        inputRst->getValue(column, line - 1, value, 0);
-        if (value != rasterDummy)
-        {
-          z2 = value;
-        }
-        else
-        {
-          z2 = centerPixelValue;
-        }
-
-        inputRst->getValue(column + 1, line - 1, value, 0);
-        if (value != rasterDummy)
-        {
-          z3 = value;
-        }
-        else
-        {
-          z3 = centerPixelValue;
-        }
-
-        inputRst->getValue(column - 1, line, value, 0);
-        if (value != rasterDummy)
-        {
-          z4 = value;
-        }
-        else
-        {
-          z4 = centerPixelValue;
-        }
-
-        inputRst->getValue(column + 1, line, value, 0);
-        if (value != rasterDummy)
-        {
-          z6 = value;
-        }
-        else
-        {
-          z6 = centerPixelValue;
-        }
-
-        inputRst->getValue(column - 1, line + 1, value, 0);
-        if (value != rasterDummy)
-        {
-          z7 = value;
-        }
-        else
-        {
-          z7 = centerPixelValue;
-        }
-
-        inputRst->getValue(column, line + 1, value, 0);
-        if (value != rasterDummy)
-        {
-          z8 = value;
-        }
-        else
-        {
-          z8 = centerPixelValue;
-        }
-
-        inputRst->getValue(column + 1, line + 1, value, 0);
-        if (value != rasterDummy)
-        {
-          z9 = value;
-        }
-        else
-        {
-          z9 = centerPixelValue;
-        }
-
-        double d = (z3 + (2*z6) + z9 - z1 - (2*z4) - z7) / (8 * rx);
-        double e = (z7 + (2 * z8) + z9 - z1 - (2 * z2) - z3) / (8 * ry);
-
-        double riseRun = std::sqrt(d*d + e*e);
-        double slopeAngle = std::atan(riseRun) * radianToDegrees;
-
-        outRaster->setValue(column, line, te::rst::Round(slopeAngle), 0);
-      }
-    }
-
-    task.pulse();
+    case te::dt::CHAR_TYPE: calculateSlopeRows<char>(inputRst, outRaster, rasterDummy, rx, ry, radianToDegrees, task); break;
+    case te::dt::UCHAR_TYPE: calculateSlopeRows<unsigned char>(inputRst, outRaster, rasterDummy, rx, ry, radianToDegrees, task); break;
+    case te::dt::INT16_TYPE: calculateSlopeRows<short>(inputRst, outRaster, rasterDummy, rx, ry, radianToDegrees, task); break;
+    case te::dt::UINT16_TYPE: calculateSlopeRows<unsigned short>(inputRst, outRaster, rasterDummy, rx, ry, radianToDegrees, task); break;
+    case te::dt::INT32_TYPE: calculateSlopeRows<int>(inputRst, outRaster, rasterDummy, rx, ry, radianToDegrees, task); break;
+    case te::dt::UINT32_TYPE: calculateSlopeRows<unsigned int>(inputRst, outRaster, rasterDummy, rx, ry, radianToDegrees, task); break;
+    case te::dt::FLOAT_TYPE: calculateSlopeRows<float>(inputRst, outRaster, rasterDummy, rx, ry, radianToDegrees, task); break;
+    default: calculateSlopeRows<double>(inputRst, outRaster, rasterDummy, rx, ry, radianToDegrees, task); break;
   }
 
   //set output raster into auto_ptr
@@ -1595,8 +1901,6 @@ std::auto_ptr<te::rst::Raster> te::urban::calculateEuclideanDistance(te::rst::Ra
 
   unsigned int numRows = inputRaster->getNumberOfRows();
   unsigned int numColumns = inputRaster->getNumberOfColumns();
-  double inputNoDataValue = inputRaster->getBand(0)->getProperty()->m_noDataValue;
-
   std::auto_ptr<te::rst::Raster> outputRaster = cloneRasterIntoMem(inputRaster, false, te::dt::DOUBLE_TYPE, std::numeric_limits<double>::max());
 
   //we will first populate an adaptative kdtree index with the valid values from the input raster. 
@@ -1608,22 +1912,31 @@ std::auto_ptr<te::rst::Raster> te::urban::calculateEuclideanDistance(te::rst::Ra
   //typedef te::sam::kdtree::AdaptativeNode<te::gm::Coord2D, std::vector<te::gm::Point>, te::gm::Point> KD_ADAPTATIVE_NODE;
   //typedef te::sam::kdtree::AdaptativeIndex<KD_ADAPTATIVE_NODE> KD_ADAPTATIVE_TREE;
 
+  //only the valid pixels of the input matter, so it is read as a mask of them
+  std::size_t stripNumRows = getStripNumberOfRows(inputRaster);
+
+  std::vector<unsigned char> vecInputMask;
+
   std::vector<std::pair<te::gm::Coord2D, te::gm::Coord2D> > dataset;
-  for (std::size_t currentRow = 0; currentRow < numRows; ++currentRow)
+  for (std::size_t stripFirstRow = 0; stripFirstRow < numRows; stripFirstRow += stripNumRows)
   {
-    for (std::size_t currentColumn = 0; currentColumn < numColumns; ++currentColumn)
+    readDataMask(inputRaster, 0, stripFirstRow, stripNumRows, vecInputMask);
+
+    for (std::size_t row = 0; row < vecInputMask.size() / numColumns; ++row)
     {
-      //gets the value of the current center pixel
-      double value = 0.;
-      inputRaster->getValue((unsigned int)currentColumn, (unsigned int)currentRow, value);
+      std::size_t currentRow = stripFirstRow + row;
+      const unsigned char* validValues = &vecInputMask[row * numColumns];
 
-      //if the value is valid, we set the Euclidean Distance to 0
-      if (value != inputNoDataValue)
+      for (std::size_t currentColumn = 0; currentColumn < numColumns; ++currentColumn)
       {
-        te::gm::Coord2D coordKey = inputRaster->getGrid()->gridToGeo((unsigned int)currentColumn, (unsigned int)currentRow);
-        te::gm::Coord2D coordValue(coordKey);
+        //if the value is valid, we set the Euclidean Distance to 0
+        if (validValues[currentColumn] != 0)
+        {
+          te::gm::Coord2D coordKey = inputRaster->getGrid()->gridToGeo((unsigned int)currentColumn, (unsigned int)currentRow);
+          te::gm::Coord2D coordValue(coordKey);
 
-        dataset.push_back(std::pair<te::gm::Coord2D, te::gm::Coord2D>(coordKey, coordValue));
+          dataset.push_back(std::pair<te::gm::Coord2D, te::gm::Coord2D>(coordKey, coordValue));
+        }
       }
     }
   }
@@ -1635,35 +1948,49 @@ std::auto_ptr<te::rst::Raster> te::urban::calculateEuclideanDistance(te::rst::Ra
   KD_ADAPTATIVE_TREE adaptativeTree(*inputRaster->getExtent());
   adaptativeTree.build(dataset);
 
-  for (std::size_t currentRow = 0; currentRow < numRows; ++currentRow)
+  //every pixel of the output strip is assigned, so it does not need to be read from the output raster
+  PixelPlane<double> outputStrip;
+
+  for (std::size_t stripFirstRow = 0; stripFirstRow < numRows; stripFirstRow += stripNumRows)
   {
-    for (std::size_t currentColumn = 0; currentColumn < numColumns; ++currentColumn)
+    readDataMask(inputRaster, 0, stripFirstRow, stripNumRows, vecInputMask);
+
+    outputStrip = PixelPlane<double>(vecInputMask.size() / numColumns, numColumns, 0.);
+    outputStrip.setFirstRow(stripFirstRow);
+
+    for (std::size_t row = 0; row < outputStrip.getNumberOfRows(); ++row)
     {
-      task.pulse();
+      std::size_t currentRow = stripFirstRow + row;
+      const unsigned char* validValues = &vecInputMask[row * numColumns];
+      double* outputValues = outputStrip.getRow(row);
 
-      //if the source is 1, the distance is 0.0. So we can continue
-      double sourceValue = 0.;
-      inputRaster->getValue((unsigned int)currentColumn, (unsigned int)currentRow, sourceValue);
-      if (sourceValue != inputNoDataValue)
+      for (std::size_t currentColumn = 0; currentColumn < numColumns; ++currentColumn)
       {
-        outputRaster->setValue((unsigned int)currentColumn, (unsigned int)currentRow, 0.0);
-        continue;
-      }
+        task.pulse();
 
-      te::gm::Coord2D currentCoord = outputRaster->getGrid()->gridToGeo((unsigned int)currentColumn, (unsigned int)currentRow);
+        //if the source is 1, the distance is 0.0. So we can continue
+        if (validValues[currentColumn] != 0)
+        {
+          outputValues[currentColumn] = 0.0;
+          continue;
+        }
 
-      std::vector<te::gm::Coord2D> points;
-      points.push_back(te::gm::Coord2D(std::numeric_limits<double>::max(), std::numeric_limits<double>::max()));
+        te::gm::Coord2D currentCoord = outputRaster->getGrid()->gridToGeo((unsigned int)currentColumn, (unsigned int)currentRow);
 
-      std::vector<double> sqrDists;
+        std::vector<te::gm::Coord2D> points;
+        points.push_back(te::gm::Coord2D(std::numeric_limits<double>::max(), std::numeric_limits<double>::max()));
 
-      //we search for the nearest source pixel from the current coord
-      adaptativeTree.nearestNeighborSearch(currentCoord, points, sqrDists, 1);
-      te::gm::Coord2D foundCoord(points[0]);
+        std::vector<double> sqrDists;
 
-      double outputValue = TeDistance(currentCoord, foundCoord);
-      outputRaster->setValue((unsigned int)currentColumn, (unsigned int)currentRow, outputValue);
+        //we search for the nearest source pixel from the current coord
+        adaptativeTree.nearestNeighborSearch(currentCoord, points, sqrDists, 1);
+        te::gm::Coord2D foundCoord(points[0]);
+
+        outputValues[currentColumn] = TeDistance(currentCoord, foundCoord);
+      }
     }
+
+    outputStrip.write(outputRaster.get());
   }
 
   return outputRaster;
@@ -35,8 +35,9 @@ TerraLib Team at <terralib-team@terralib.org>.
 
 #include <boost/numeric/ublas/matrix.hpp>
 
-#include <ctime>
+#include <chrono>
 
+#include <map>
 #include <memory>
 #include <set>
 #include <string>
@@ -52,6 +53,7 @@ namespace te
   namespace gm
   {
     struct Coord2D;
+    class Envelope;
   }
 
   namespace mem
@@ -76,6 +78,43 @@ namespace te
       NEWDEV_NO_DATA = 0, NEWDEV_INFILL = 1, NEWDEV_EXTENSION = 2, NEWDEV_LEAPFROG = 3
     };
 
+    //!< How the pixels of an opened raster file are accessed
+    enum RasterAccess
+    {
+      RASTER_COPY_INTO_MEMORY, //!< the entire raster is read into memory when it is opened
+      RASTER_BLOCK_CACHE,      //!< the blocks are read when they are accessed and the most recently used ones are cached. The raster must only be read
+      RASTER_FILE              //!< the pixels are read from the file every time they are accessed
+    };
+
+    //!< The compression of the created GeoTIFF files
+    enum RasterCompression
+    {
+      RASTER_COMPRESSION_NONE,
+      RASTER_COMPRESSION_DEFLATE,
+      RASTER_COMPRESSION_LZW,
+      RASTER_COMPRESSION_ZSTD
+    };
+
+    //!< The creation options of the GeoTIFF files written by createRaster and saveRaster
+    struct RasterCreationOptions
+    {
+      RasterCreationOptions()
+        : m_tiled(true)
+        , m_blockSize(TEGROWTH_RASTER_BLOCK_SIZE)
+        , m_compression(RASTER_COMPRESSION_DEFLATE)
+        , m_predictor(true)
+        , m_bigTiff(true)
+        , m_numberOfThreads(0)
+      {}
+
+      bool m_tiled; //!< if false, the file is written in strips
+      std::size_t m_blockSize; //!< the width and height of the tiles, in pixels. Must be a multiple of 16
+      RasterCompression m_compression;
+      bool m_predictor; //!< if true, the horizontal differencing predictor is used by the compression
+      bool m_bigTiff; //!< if true, a BigTIFF file is created when the file may exceed 4 GB
+      std::size_t m_numberOfThreads; //!< the threads that compress the tiles. 0 means all the available cores
+    };
+
     typedef std::map<InputUrbanClasses, short> InputClassesMap;
 
     typedef std::map<std::string, double> UrbanIndexes; //index name, index value
@@ -94,17 +133,34 @@ namespace te
       std::shared_ptr<te::rst::Raster> m_urbanFootprintRaster;
     };
 
+    //!< A window of a raster, given in grid coordinates
+    struct RasterWindow
+    {
+      RasterWindow()
+        : m_firstRow(0)
+        , m_firstColumn(0)
+        , m_numRows(0)
+        , m_numColumns(0)
+      {}
+
+      std::size_t m_firstRow;
+      std::size_t m_firstColumn;
+      std::size_t m_numRows;
+      std::size_t m_numColumns;
+    };
+
+    //!< Measures the elapsed wall time. The processor time of clock() would add the time of all the threads of the process
     struct Timer
     {
       Timer()
-        : m_startTime(clock())
+        : m_startTime(std::chrono::steady_clock::now())
       {
       }
 
       double getElapsedTimeInSeconds()
       {
-        clock_t endTime = clock();
-        double elapsedTime = double(endTime - m_startTime) / CLOCKS_PER_SEC;
+        std::chrono::steady_clock::time_point endTime = std::chrono::steady_clock::now();
+        double elapsedTime = std::chrono::duration<double>(endTime - m_startTime).count();
 
         return elapsedTime;
       }
@@ -116,7 +172,18 @@ namespace te
         return timeInMinutes;
       }
 
-      clock_t m_startTime;
+      //!< Returns how many pixels were processed per second, given the total number of processed pixels
+      double getPixelsPerSecond(std::size_t numPixels)
+      {
+        double timeInSeconds = getElapsedTimeInSeconds();
+        if (timeInSeconds <= 0.)
+        {
+          return 0.;
+        }
+        return double(numPixels) / timeInSeconds;
+      }
+
+      std::chrono::steady_clock::time_point m_startTime;
     };
 
     enum ReclassifyMissingValuesPolicy
@@ -162,7 +229,17 @@ namespace te
 
     TEGROWTHEXPORT void removeAllLoggers();
 
-    TEGROWTHEXPORT std::auto_ptr<te::rst::Raster> openRaster(const std::string& fileName);
+    //!< Opens the given raster file. By default the raster is copied into memory. Otherwise it is read from the file when it is accessed, so it can be larger than the memory. The cache size is given in megabytes. A native raster file is always opened with openNativeRaster
+    TEGROWTHEXPORT std::auto_ptr<te::rst::Raster> openRaster(const std::string& fileName, RasterAccess access = RASTER_COPY_INTO_MEMORY, std::size_t cacheSize = TEGROWTH_RASTER_CACHE_SIZE);
+
+    //!< Calculates the window of the raster that contains the given envelope expanded by the halo, in pixels, in each direction. The window is limited to the raster. Returns false if the envelope does not intersect the raster
+    TEGROWTHEXPORT bool calculateRasterWindow(te::rst::Raster* raster, const te::gm::Envelope& envelope, std::size_t haloPixels, RasterWindow& window);
+
+    //!< Copies the given window of the raster into memory. The grid of the copy is georeferenced to the window
+    TEGROWTHEXPORT std::auto_ptr<te::rst::Raster> readRasterWindow(te::rst::Raster* raster, const RasterWindow& window);
+
+    //!< Opens only the region of interest of the given raster file: the window that contains the envelope expanded by the halo distance, given in the units of the raster. Only the blocks of the file that intersect the window are read
+    TEGROWTHEXPORT std::auto_ptr<te::rst::Raster> openRasterWindow(const std::string& fileName, const te::gm::Envelope& envelope, int envelopeSRID, double haloDistance);
 
     TEGROWTHEXPORT std::auto_ptr<te::da::DataSet> openVector(const std::string& fileName);
 
@@ -170,11 +247,16 @@ namespace te
 
     TEGROWTHEXPORT std::auto_ptr<te::rst::Raster> cloneRasterIntoMem(te::rst::Raster* raster, bool copyData, int dataType = te::dt::UCHAR_TYPE, double noDataValue = 0.);
 
-    TEGROWTHEXPORT std::auto_ptr<te::rst::Raster> createRaster(const std::string& fileName, te::rst::Raster* raster);
+    //!< Adds the GDAL creation options of the given options to the raster info
+    TEGROWTHEXPORT void addRasterCreationOptions(const RasterCreationOptions& options, std::map<std::string, std::string>& rasterInfo);
+
+    //!< Creates a GeoTIFF file with the grid and the bands of the given raster. All the pixels are read as 0 until they are written
+    TEGROWTHEXPORT std::auto_ptr<te::rst::Raster> createRaster(const std::string& fileName, te::rst::Raster* raster, const RasterCreationOptions& options = RasterCreationOptions());
     
     TEGROWTHEXPORT std::auto_ptr<te::da::DataSource> createDataSourceOGR(const std::string& fileName);
 
-    TEGROWTHEXPORT void saveRaster(const std::string& fileName, te::rst::Raster* raster);
+    //!< Saves the raster as a GeoTIFF file or, if the file has the native extension, as a native raster, compressed with LZ4 if the options have any compression
+    TEGROWTHEXPORT void saveRaster(const std::string& fileName, te::rst::Raster* raster, const RasterCreationOptions& options = RasterCreationOptions());
 
     TEGROWTHEXPORT void saveVector(const std::string& fileName, const std::string& filePath, const std::vector<te::gm::Geometry*>& vecGeometries, const int& srid);
 
@@ -184,7 +266,14 @@ namespace te
 
     TEGROWTHEXPORT bool needNormalization(te::rst::Raster* inputRaster, te::rst::Raster* referenceRaster);
 
-    TEGROWTHEXPORT std::auto_ptr<te::rst::Raster> normalizeRaster(te::rst::Raster* inputRaster, te::rst::Raster* referenceRaster);
+    //!< Returns true if the grids have the same SRID and resolution and their pixels are aligned. The offsets are the column and row of the source grid that contain the first pixel of the target grid
+    TEGROWTHEXPORT bool calculateAlignedGridOffset(const te::rst::Grid* targetGrid, const te::rst::Grid* sourceGrid, int& columnOffset, int& rowOffset);
+
+    //!< Copies the pixels of the input raster into the aligned output raster, row by row. The offsets are given by calculateAlignedGridOffset and the output pixels outside the input are set to the no data value
+    TEGROWTHEXPORT void copyAlignedRaster(te::rst::Raster* inputRaster, te::rst::Raster* outputRaster, int columnOffset, int rowOffset, double noDataValue);
+
+    //!< Resamples the input raster into the grid of the reference raster, by the nearest neighbor. If the grids are aligned, the pixels are just copied. Otherwise the output is resampled in tiles, in parallel, and the positions are transformed row by row and, if the maximum error, in input pixels, is greater than 0, approximately
+    TEGROWTHEXPORT std::auto_ptr<te::rst::Raster> normalizeRaster(te::rst::Raster* inputRaster, te::rst::Raster* referenceRaster, double maxError = TEGROWTH_TRANSFORM_MAX_ERROR);
 
     //!< Returns all the pixels within the given radius
     TEGROWTHEXPORT void getPixelsWithinRadious(te::rst::Raster* raster, std::size_t referenceRow, std::size_t referenceColumn, double radius, const boost::numeric::ublas::matrix<bool>& mask, std::vector<double>& vecPixels);
@@ -198,6 +287,12 @@ namespace te
     //Calculate the urban footprint value based in the value of center pixel and in the value of the adjacent pixels
     TEGROWTHEXPORT double calculateUrbanFootprint(short centerPixelValue, const InputClassesMap& inputClassesMap, const std::vector<double>& vecPixels, double& permUrb);
 
+    //Calculate the urbanized area value based in the value of center pixel and in the number of urban and valid adjacent pixels
+    TEGROWTHEXPORT double calculateUrbanizedArea(short centerPixelValue, const InputClassesMap& inputClassesMap, std::size_t urbanPixelsCount, std::size_t allPixelsCount, double& permUrb);
+
+    //Calculate the urban footprint value based in the value of center pixel and in the number of urban and valid adjacent pixels
+    TEGROWTHEXPORT double calculateUrbanFootprint(short centerPixelValue, const InputClassesMap& inputClassesMap, std::size_t urbanPixelsCount, std::size_t allPixelsCount, double& permUrb);
+
     //Calculate the urban open area value based in the value of center pixel and in the value of the adjacent pixels
     TEGROWTHEXPORT double calculateUrbanOpenArea(short centerPixelValue, const std::vector<double>& vecPixels);
 
@@ -206,14 +301,14 @@ namespace te
     //!< Search for all the gaps (holes) that [optionally] have area smaller then the given reference area
     TEGROWTHEXPORT std::vector<te::gm::Geometry*> getGaps(const std::vector<te::gm::Geometry*>& vecCandidateGaps, double area = 0.);
 
-    //!< For each region, creates a new group using sequential values
-    TEGROWTHEXPORT std::auto_ptr<te::rst::Raster> createDistinctGroups(te::rst::Raster* inputRaster, const std::string& outputPath, const std::string& outputPrefix);
+    //!< For each region, creates a new group using sequential values. The regions that touch each other are labeled as a single group. Optionally the regions are also vectorized and exported to a shapefile, and the tiles are streamed by the labeler instead of kept in memory
+    TEGROWTHEXPORT std::auto_ptr<te::rst::Raster> createDistinctGroups(te::rst::Raster* inputRaster, const std::string& outputPath, const std::string& outputPrefix, bool exportVectorizedGroups = false, bool streamTiles = false);
 
     //!< DETERMINE EDGE OPEN AREA (100 meter buffer around built-up)
     TEGROWTHEXPORT std::set<double> detectEdgeOpenAreaGroups(te::rst::Raster* otherNewDevRaster, te::rst::Raster* otherNewDevGroupedRaster, te::rst::Raster* footprintRaster);
 
-    //compare the images in two diferrent times, creating two new classified images
-    TEGROWTHEXPORT void generateInfillOtherDevRasters(te::rst::Raster* rasterT1, te::rst::Raster* rasterT2, const std::string& infillRasterFileName, const std::string& otherDevRasterFileName);
+    //compare the images in two diferrent times, creating in memory two new classified images: the infill and the other development
+    TEGROWTHEXPORT void generateInfillOtherDevRasters(te::rst::Raster* rasterT1, te::rst::Raster* rasterT2, std::auto_ptr<te::rst::Raster>& infillRaster, std::auto_ptr<te::rst::Raster>& otherDevRaster);
 
     TEGROWTHEXPORT std::auto_ptr<te::rst::Raster> classifyNewDevelopment(te::rst::Raster* infillRaster, te::rst::Raster* otherDevGroupedRaster, const std::set<double>& setEdgesOpenAreaGroups);
 
@@ -235,6 +330,14 @@ namespace te
 
     TEGROWTHEXPORT std::auto_ptr<te::rst::Raster> clipRaster(te::rst::Raster* inputRaster, te::gm::Geometry* clipArea);
 
+    /*!
+      \brief Creates a row major mask with one byte for each pixel of the raster, set to 1 in the pixels visited by the polygon iterator of any polygon of the given limits and to 0 in the others.
+
+      The limits may be a polygon, a multi polygon or a collection of geometries, whose other geometries are ignored. If the limits are null, the mask is left empty,
+      meaning that the study area is the entire raster. Returns false if the limits have no polygon.
+    */
+    TEGROWTHEXPORT bool createStudyAreaMask(te::rst::Raster* raster, te::gm::Geometry* spatialLimits, std::vector<unsigned char>& vecStudyArea);
+
     /*! Function used to create the output dataset type */
     TEGROWTHEXPORT std::auto_ptr<te::da::DataSetType> createDataSetType(std::string dataSetName, int srid);
 
@@ -27,6 +27,8 @@ TerraLib Team at <terralib-team@terralib.org>.
 #include "Utils.h"
 #include "ui_ReclassifyWidgetForm.h"
 
+#include "../terralib_mod_growth/RasterWriter.h"
+#include "../terralib_mod_growth/ResultCache.h"
 #include "../terralib_mod_growth/UrbanGrowth.h"
 
 //Terralib
@@ -59,6 +61,17 @@ te::urban::qt::ReclassifyWidget::ReclassifyWidget(bool startAsPlugin, QWidget* p
 
   m_ui->m_reclassRadiusLineEdit->setValidator(new QDoubleValidator(this));
 
+  m_ui->m_kernelComboBox->addItem(tr("Automatic"), KERNEL_AUTOMATIC);
+  m_ui->m_kernelComboBox->addItem(tr("Prefix sum"), KERNEL_PREFIX_SUM);
+  m_ui->m_kernelComboBox->addItem(tr("Sliding window"), KERNEL_SLIDING_WINDOW);
+  m_ui->m_kernelComboBox->addItem(tr("Bit-packed popcount"), KERNEL_POPCOUNT);
+  m_ui->m_kernelComboBox->addItem(tr("FFT"), KERNEL_FFT);
+
+  m_ui->m_compressionComboBox->addItem(tr("DEFLATE"), RASTER_COMPRESSION_DEFLATE);
+  m_ui->m_compressionComboBox->addItem(tr("LZW"), RASTER_COMPRESSION_LZW);
+  m_ui->m_compressionComboBox->addItem(tr("ZSTD"), RASTER_COMPRESSION_ZSTD);
+  m_ui->m_compressionComboBox->addItem(tr("None"), RASTER_COMPRESSION_NONE);
+
   if (m_startAsPlugin)
   {
     m_ui->m_reclassAddImageToolButton->setIcon(QIcon::fromTheme("list-add"));
@@ -153,7 +166,8 @@ void te::urban::qt::ReclassifyWidget::onRemapCheckBoxClicked(bool flag)
   
   try
   {
-    std::auto_ptr<te::rst::Raster> inputRaster = openRaster(inputFileName);
+    //the histogram reads each block only once, so the raster is not copied into memory
+    std::auto_ptr<te::rst::Raster> inputRaster = openRaster(inputFileName, RASTER_BLOCK_CACHE);
 
     values = inputRaster->getBand(0)->getHistogramR();
   }
@@ -300,6 +314,15 @@ void te::urban::qt::ReclassifyWidget::execute()
 
   bool calculateIndexes = m_ui->m_indexCheckBox->isChecked();
 
+  NeighborhoodKernel kernel = (NeighborhoodKernel)m_ui->m_kernelComboBox->currentData().toInt();
+
+  //0 means all the available cores
+  std::size_t numberOfThreads = (std::size_t)m_ui->m_threadsSpinBox->value();
+
+  //the output files are tiled GeoTIFFs with the chosen compression
+  RasterCreationOptions rasterCreationOptions;
+  rasterCreationOptions.m_compression = (RasterCompression)m_ui->m_compressionComboBox->currentData().toInt();
+
   QString qOutputIntermediatePath = m_ui->m_reclassOutputRepoLineEdit->text() + "/intermediate";
   QDir qDir(qOutputIntermediatePath);
   if (qDir.exists() == false)
@@ -360,6 +383,9 @@ void te::urban::qt::ReclassifyWidget::execute()
     }
   }
 
+  //in the region of interest mode, all the steps are executed in the window of the spatial limits and the outputs are georeferenced to it
+  bool readLimitsWindow = m_ui->m_limitsWindowCheckBox->isChecked() && geometryLimit.get() != 0;
+
   //execute operation
   std::vector<te::rst::Raster*> vecInputRasters;
   std::vector<PrepareRasterParams*> vecPreparedRasters;
@@ -372,6 +398,16 @@ void te::urban::qt::ReclassifyWidget::execute()
 
   boost::thread_group threadGroup;
 
+  //the intermediate files of all the images are written in background by the same writer, which limits the rasters waiting in memory
+  RasterWriter rasterWriter;
+
+  //the prepared rasters of previous executions in the same repository are reused when their input and parameters did not change
+  std::auto_ptr<ResultCache> resultCache;
+  if (m_ui->m_cacheCheckBox->isChecked())
+  {
+    resultCache.reset(new ResultCache(outputPath + "/cache"));
+  }
+
   Timer timer;
 
   //just a reference to be used in the raster normalization optional step
@@ -385,7 +421,25 @@ void te::urban::qt::ReclassifyWidget::execute()
       std::string inputFileName = m_ui->m_imgFilesListWidget->item(i)->text().toStdString();
       std::string currentOutputPrefix = outputPrefix + "_t" + boost::lexical_cast<std::string>(i);
 
-      std::auto_ptr<te::rst::Raster> inputRaster = openRaster(inputFileName);
+      std::auto_ptr<te::rst::Raster> inputRaster;
+      if (readLimitsWindow)
+      {
+        //only the window of the spatial limits is read, expanded by the halo needed by the urban and the urban open area neighborhoods. The other images are read in the window of the first one
+        if (i == 0)
+        {
+          inputRaster = openRasterWindow(inputFileName, *geometryLimit->getMBR(), geometryLimit->getSRID(), radius + 100.);
+        }
+        else
+        {
+          inputRaster = openRasterWindow(inputFileName, *referenceRaster->getExtent(), referenceRaster->getSRID(), 0.);
+        }
+      }
+      else
+      {
+        //the reclassification already creates a copy in memory, so the file is only read through the block cache
+        RasterAccess inputAccess = m_ui->m_remapCheckBox->isChecked() ? RASTER_BLOCK_CACHE : RASTER_COPY_INTO_MEMORY;
+        inputRaster = openRaster(inputFileName, inputAccess);
+      }
 
       //we reclassify the raster if necessary
       if (m_ui->m_remapCheckBox->isChecked())
@@ -419,39 +473,58 @@ void te::urban::qt::ReclassifyWidget::execute()
 
           std::string normalizedPrefix = currentOutputPrefix + "_normalized";
           std::string normalizedRasterFileName = outputIntermediatePath + "/" + normalizedPrefix + ".tif";
-          saveRaster(normalizedRasterFileName, inputRaster.get());
+          saveRaster(normalizedRasterFileName, inputRaster.get(), rasterCreationOptions);
         }
       }
 
+      //the indexes are calculated by the prepare raster step, from the same neighborhood counts of the classification
+      CalculateUrbanIndexesParams* urbanIndexesParams = 0;
+      if (calculateIndexes)
+      {
+        urbanIndexesParams = new CalculateUrbanIndexesParams();
+        urbanIndexesParams->m_inputFileName = inputFileName;
+        urbanIndexesParams->m_spatialLimits = geometryLimit.get();
+
+        vecCalculatedIndexes.push_back(urbanIndexesParams);
+      }
+
       //we create a thread to process the prepare raster step
       PrepareRasterParams* prepareRasterParams = new PrepareRasterParams();
       prepareRasterParams->m_inputRaster = inputRaster.get();
       prepareRasterParams->m_inputClassesMap = inputClassesMap;
       prepareRasterParams->m_radius = radius;
+      prepareRasterParams->m_kernel = kernel;
+      prepareRasterParams->m_numberOfThreads = numberOfThreads;
       prepareRasterParams->m_outputPath = outputIntermediatePath;
       prepareRasterParams->m_outputPrefix = currentOutputPrefix;
+      prepareRasterParams->m_urbanIndexesParams = urbanIndexesParams;
+      prepareRasterParams->m_rasterCreationOptions = rasterCreationOptions;
+      prepareRasterParams->m_rasterWriter = &rasterWriter;
+
+      if (resultCache.get() != 0)
+      {
+        //the input is identified by the content of its file and by its remap
+        Hasher inputHasher;
+        inputHasher.addFileContent(inputFileName);
+        for (std::size_t j = 0; j < vecReclassifyInfo.size(); ++j)
+        {
+          inputHasher.add(vecReclassifyInfo[j].m_sourceInitialValue);
+          inputHasher.add(vecReclassifyInfo[j].m_sourceFinalValue);
+          inputHasher.add(vecReclassifyInfo[j].m_outputValue);
+          inputHasher.add((boost::uint64_t)vecReclassifyInfo[j].m_singleValueRemap);
+        }
+
+        //the cache only keeps the final results, so the intermediate files of the prepare raster step are not saved, and a hit gives the same outputs of a miss
+        prepareRasterParams->m_saveIntermediateFiles = false;
+        prepareRasterParams->m_resultCache = resultCache.get();
+        prepareRasterParams->m_inputKey = inputHasher.getHash();
+      }
 
       boost::thread* prepareRasterThread = new boost::thread(&prepareRaster, prepareRasterParams);
       threadGroup.add_thread(prepareRasterThread);
 
       vecPreparedRasters.push_back(prepareRasterParams);
 
-      //then we create a thread to calculate the indexes
-      std::auto_ptr<CalculateUrbanIndexesParams> urbanIndexesParams;
-      if (calculateIndexes)
-      {
-        CalculateUrbanIndexesParams* urbanIndexesParams = new CalculateUrbanIndexesParams();
-        urbanIndexesParams->m_inputFileName = inputFileName;
-        urbanIndexesParams->m_inputRaster = inputRaster.get();
-        urbanIndexesParams->m_inputClassesMap = inputClassesMap;
-        urbanIndexesParams->m_radius = radius;
-        urbanIndexesParams->m_spatialLimits = geometryLimit.get();
-
-        threadGroup.add_thread(new boost::thread(&calculateUrbanIndexes, urbanIndexesParams));
-
-        vecCalculatedIndexes.push_back(urbanIndexesParams);
-      }
-
       vecInputRasters.push_back(inputRaster.release());
     }
   }
@@ -477,6 +550,11 @@ void te::urban::qt::ReclassifyWidget::execute()
 
   threadGroup.join_all();
 
+  if (resultCache.get() != 0)
+  {
+    resultCache->logStatistics();
+  }
+
   UrbanSummary urbanSummary;
   for (std::size_t i = 0; i < vecCalculatedIndexes.size(); ++i)
   {
@@ -502,6 +580,10 @@ void te::urban::qt::ReclassifyWidget::execute()
       params->m_t2 = vecPreparedRasters[i]->m_result;
       params->m_outputPath = outputIntermediatePath;
       params->m_outputPrefix = currentOutputPrefix;
+      params->m_rasterCreationOptions = rasterCreationOptions;
+      params->m_rasterWriter = &rasterWriter;
+      params->m_exportVectorizedGroups = m_ui->m_vectorizeGroupsCheckBox->isChecked();
+      params->m_streamGroupTiles = m_ui->m_streamGroupsCheckBox->isChecked();
 
       compareItmePeriodsThreadGroup.add_thread(new boost::thread(&compareRasterPeriods, params));
 
@@ -510,6 +592,7 @@ void te::urban::qt::ReclassifyWidget::execute()
 
     compareItmePeriodsThreadGroup.join_all();
 
+    std::vector<std::string> vecNewDevelopmentFileNames;
     for (std::size_t i = 0; i < vecCompareTimePeriodsParams.size(); ++i)
     {
       CompareTimePeriodsParams* params = vecCompareTimePeriodsParams[i];
@@ -518,11 +601,19 @@ void te::urban::qt::ReclassifyWidget::execute()
 
       std::string newDevelopmentPrefix = currentOutputPrefix + "_newDevelopment";
       std::string newDevelopmentRasterFileName = outputPath + "/" + newDevelopmentPrefix + ".tif";
-      saveRaster(newDevelopmentRasterFileName, params->m_outputRaster.get());
+      rasterWriter.write(newDevelopmentRasterFileName, params->m_outputRaster, rasterCreationOptions);
+
+      vecNewDevelopmentFileNames.push_back(newDevelopmentRasterFileName);
+    }
+
+    //the layers can only be created after their files are written
+    rasterWriter.wait();
 
+    for (std::size_t i = 0; i < vecNewDevelopmentFileNames.size(); ++i)
+    {
       if (m_startAsPlugin)
       {
-        te::map::AbstractLayerPtr layer = te::urban::qt::CreateLayer(newDevelopmentRasterFileName, "GDAL");
+        te::map::AbstractLayerPtr layer = te::urban::qt::CreateLayer(vecNewDevelopmentFileNames[i], "GDAL");
 
         emit layerCreated(layer);
       }
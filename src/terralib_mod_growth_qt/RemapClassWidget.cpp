@@ -181,7 +181,8 @@ void te::urban::qt::RemapClassWidget::execute()
       std::string outputFileName = file.baseName().toStdString() + "_" + outputSufix + ".tif";
       std::string outputFilePath = outputPath + "/" + outputFileName;
 
-      std::auto_ptr<te::rst::Raster> inputRaster = openRaster(m_ui->m_imgFilesListWidget->item(i)->text().toStdString());
+      //the reclassification creates its own copy in memory, so the file is only read through the block cache
+      std::auto_ptr<te::rst::Raster> inputRaster = openRaster(m_ui->m_imgFilesListWidget->item(i)->text().toStdString(), RASTER_BLOCK_CACHE);
 
       inputRaster = reclassify(inputRaster.get(), vecRemapInfo, SET_NEW_NODATA, 0);
 
@@ -219,7 +220,7 @@ void te::urban::qt::RemapClassWidget::remap()
   if (m_ui->m_imgFilesListWidget->count() != 0)
   {
     std::string inputFileName = m_ui->m_imgFilesListWidget->item(0)->text().toStdString();
-    std::auto_ptr<te::rst::Raster> inputRaster = openRaster(inputFileName);
+    std::auto_ptr<te::rst::Raster> inputRaster = openRaster(inputFileName, RASTER_BLOCK_CACHE);
 
     values = inputRaster->getBand(0)->getHistogramR();
   }
@@ -296,7 +296,9 @@ void te::urban::qt::SprawlMetricsWidget::execute()
 
     QString qSlopeFileName = m_ui->m_slopeLineEdit->text();
     std::string slopeFileName = qSlopeFileName.toStdString();
-    slopeRaster = openRaster(slopeFileName);
+    //in the region of interest mode, the slope is only read in the window of the land cover when it is normalized
+    RasterAccess slopeAccess = m_ui->m_studyAreaWindowCheckBox->isChecked() ? RASTER_BLOCK_CACHE : RASTER_COPY_INTO_MEMORY;
+    slopeRaster = openRaster(slopeFileName, slopeAccess);
 
     QString qCbdFileName = m_ui->m_cbdVecLineEdit->text();
     std::string cbdFileName = qCbdFileName.toStdString();
@@ -339,6 +341,9 @@ void te::urban::qt::SprawlMetricsWidget::execute()
   inputClassesMap[INPUT_URBAN] = INPUT_URBAN;
   inputClassesMap[INPUT_OTHER] = INPUT_OTHER;
 
+  //in the region of interest mode, all the steps are executed in the window of the study area
+  bool readStudyAreaWindow = m_ui->m_studyAreaWindowCheckBox->isChecked() && studyArea.get() != 0;
+
   //add task viewer
   te::qt::widgets::ProgressViewerDialog* dlgViewer = new te::qt::widgets::ProgressViewerDialog(this);
   int dlgViewerId = te::common::ProgressManager::getInstance().addViewer(dlgViewer);
@@ -354,7 +359,16 @@ void te::urban::qt::SprawlMetricsWidget::execute()
 
       std::string landCoverFileName = qLandCoverFileName.toStdString();
       std::string baseName = qBaseName.toStdString();
-      std::auto_ptr<te::rst::Raster> landCoverRaster = openRaster(landCoverFileName);
+      std::auto_ptr<te::rst::Raster> landCoverRaster;
+      if (readStudyAreaWindow)
+      {
+        //only the window of the study area is read, expanded by the halo needed by the urban and the urban open area neighborhoods
+        landCoverRaster = openRasterWindow(landCoverFileName, *studyArea->getMBR(), studyArea->getSRID(), radius + 100.);
+      }
+      else
+      {
+        landCoverRaster = openRaster(landCoverFileName);
+      }
 
       if (i == 0)
       {
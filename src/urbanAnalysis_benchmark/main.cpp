@@ -0,0 +1,587 @@
+/*  Copyright (C) 2011-2012 National Institute For Space Research (INPE) - Brazil.
+
+This file is part of the TerraLib - a Framework for building GIS enabled applications.
+
+TerraLib is free software: you can redistribute it and/or modify
+it under the terms of the GNU Lesser General Public License as published by
+the Free Software Foundation, either version 3 of the License,
+or (at your option) any later version.
+
+TerraLib is distributed in the hope that it will be useful,
+but WITHOUT ANY WARRANTY; without even the implied warranty of
+MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE. See the
+GNU Lesser General Public License for more details.
+
+You should have received a copy of the GNU Lesser General Public License
+along with TerraLib. See COPYING. If not, write to
+TerraLib Team at <terralib-team@terralib.org>.
+*/
+
+/*!
+\file urbanAnalysis_benchmark/main.cpp
+
+\brief It measures the neighborhood counters over a synthetic plane, for each instruction set supported by the processor.
+
+With --check, it compares instead the parallel and streamed algorithms with the serial ones they replace, over small synthetic rasters: the serial
+labeling with a flood fill, the tiled and the streamed labelers with the serial labeling, the dilation with the neighborhood counts, and the resampler
+and the aligned copy of normalizeRaster with the original per pixel normalization.
+
+Usage: urbanAnalysisBenchmark [numRows numColumns radiusInPixels repetitions]
+       urbanAnalysisBenchmark --check
+*/
+
+// UrbanAnalysis
+#include "../terralib_mod_growth/ConnectedComponents.h"
+#include "../terralib_mod_growth/Dilation.h"
+#include "../terralib_mod_growth/Neighborhood.h"
+#include "../terralib_mod_growth/PixelPlane.h"
+#include "../terralib_mod_growth/Resampler.h"
+#include "../terralib_mod_growth/SpanKernels.h"
+#include "../terralib_mod_growth/Utils.h"
+
+// TerraLib
+#include <terralib/datatype/Enums.h>
+#include <terralib/geometry/Coord2D.h>
+#include <terralib/geometry/Envelope.h>
+#include <terralib/raster/BandProperty.h>
+#include <terralib/raster/Grid.h>
+#include <terralib/raster/Raster.h>
+#include <terralib/raster/RasterFactory.h>
+#include <terralib/raster/Utils.h>
+
+// Boost
+#include <boost/lexical_cast.hpp>
+
+// STL
+#include <algorithm>
+#include <cstdlib>
+#include <iomanip>
+#include <iostream>
+#include <map>
+#include <memory>
+#include <string>
+#include <utility>
+#include <vector>
+
+//!< The SRID of the synthetic rasters of the checks
+const int CHECK_SRID = 32723;
+
+//!< Fills the plane with clusters of urban pixels surrounded by other pixels, with some water and no data
+void createSyntheticPlane(std::size_t numRows, std::size_t numColumns, te::urban::NeighborhoodPlane& plane)
+{
+  plane.m_numRows = numRows;
+  plane.m_numColumns = numColumns;
+  plane.m_vecFlags.resize(numRows * numColumns);
+
+  srand(1);
+
+  for (std::size_t row = 0; row < numRows; ++row)
+  {
+    for (std::size_t column = 0; column < numColumns; ++column)
+    {
+      unsigned char flags = te::urban::NEIGHBORHOOD_VALID | te::urban::NEIGHBORHOOD_OTHER;
+
+      int random = rand() % 100;
+      if (((row / 40) + (column / 60)) % 3 == 0 && random < 80)
+      {
+        flags = te::urban::NEIGHBORHOOD_VALID | te::urban::NEIGHBORHOOD_URBAN;
+      }
+      else if (random < 5)
+      {
+        flags = te::urban::NEIGHBORHOOD_VALID | te::urban::NEIGHBORHOOD_WATER;
+      }
+      else if (random < 8)
+      {
+        flags = 0;
+      }
+
+      plane.m_vecFlags[row * numColumns + column] = flags;
+    }
+  }
+}
+
+//!< Counts all the rows of the plane and returns the number of counted pixels per second. The sum of all the counts is returned in checksum
+double runCounter(te::urban::NeighborhoodCounter& counter, std::size_t repetitions, unsigned long long& checksum)
+{
+  const te::urban::NeighborhoodPlane& plane = counter.getPlane();
+
+  std::vector<unsigned int> vecUrbanCount;
+  std::vector<unsigned int> vecValidCount;
+
+  checksum = 0;
+
+  te::urban::Timer timer;
+
+  for (std::size_t r = 0; r < repetitions; ++r)
+  {
+    for (std::size_t row = 0; row < plane.m_numRows; ++row)
+    {
+      counter.countRow(row, vecUrbanCount, vecValidCount);
+
+      for (std::size_t column = 0; column < plane.m_numColumns; ++column)
+      {
+        checksum += vecUrbanCount[column] + vecValidCount[column];
+      }
+    }
+  }
+
+  return timer.getPixelsPerSecond(repetitions * plane.m_numRows * plane.m_numColumns);
+}
+
+//!< Creates an in-memory raster of bytes, whose no data value is 0, with the given upper left corner and resolution
+std::auto_ptr<te::rst::Raster> createByteRaster(std::size_t numRows, std::size_t numColumns, double upperLeftX, double upperLeftY, double resolution)
+{
+  std::vector<te::rst::BandProperty*> bprops;
+  te::rst::BandProperty* bp = new te::rst::BandProperty(0, te::dt::UCHAR_TYPE);
+  bp->m_noDataValue = 0.;
+  bprops.push_back(bp);
+
+  te::gm::Envelope* extent = new te::gm::Envelope(upperLeftX, upperLeftY - numRows * resolution, upperLeftX + numColumns * resolution, upperLeftY);
+  te::rst::Grid* grid = new te::rst::Grid((unsigned int)numColumns, (unsigned int)numRows, extent, CHECK_SRID);
+
+  std::map<std::string, std::string> rasterInfo;
+
+  return std::auto_ptr<te::rst::Raster>(te::rst::RasterFactory::make("MEM", grid, bprops, rasterInfo, 0, 0));
+}
+
+//!< Returns the number of pixels of the first bands of the rasters that differ. Rasters of different sizes differ in all their pixels
+std::size_t countDifferences(te::rst::Raster* raster1, te::rst::Raster* raster2)
+{
+  te::urban::PixelPlane<double> plane1;
+  te::urban::PixelPlane<double> plane2;
+  plane1.read(raster1);
+  plane2.read(raster2);
+
+  if (plane1.getNumberOfRows() != plane2.getNumberOfRows() || plane1.getNumberOfColumns() != plane2.getNumberOfColumns())
+  {
+    return std::max(plane1.getNumberOfRows() * plane1.getNumberOfColumns(), plane2.getNumberOfRows() * plane2.getNumberOfColumns());
+  }
+
+  std::size_t numDifferences = 0;
+  for (std::size_t row = 0; row < plane1.getNumberOfRows(); ++row)
+  {
+    for (std::size_t column = 0; column < plane1.getNumberOfColumns(); ++column)
+    {
+      numDifferences += (plane1(row, column) != plane2(row, column)) ? 1 : 0;
+    }
+  }
+
+  return numDifferences;
+}
+
+//!< Prints the result of a check and returns 1 if it failed
+int reportCheck(const std::string& name, std::size_t numDifferences)
+{
+  std::cout << std::setw(48) << std::left << name << std::right << (numDifferences == 0 ? "ok" : "MISMATCH") << std::endl;
+
+  return (numDifferences == 0) ? 0 : 1;
+}
+
+//!< The reference labeling, which floods each component over the 8 neighbors of its pixels, from its first pixel in a row by row scan. Returns the number of components
+std::size_t labelByFloodFill(const te::urban::PixelPlane<unsigned char>& plane, te::urban::PixelPlane<unsigned int>& labels)
+{
+  std::size_t numRows = plane.getNumberOfRows();
+  std::size_t numColumns = plane.getNumberOfColumns();
+
+  labels = te::urban::PixelPlane<unsigned int>(numRows, numColumns, 0);
+
+  unsigned int numComponents = 0;
+  std::vector<std::pair<std::size_t, std::size_t> > vecStack;
+
+  for (std::size_t row = 0; row < numRows; ++row)
+  {
+    for (std::size_t column = 0; column < numColumns; ++column)
+    {
+      if (plane(row, column) == 0 || labels(row, column) != 0)
+      {
+        continue;
+      }
+
+      ++numComponents;
+      labels(row, column) = numComponents;
+      vecStack.push_back(std::make_pair(row, column));
+
+      while (vecStack.empty() == false)
+      {
+        std::size_t pixelRow = vecStack.back().first;
+        std::size_t pixelColumn = vecStack.back().second;
+        vecStack.pop_back();
+
+        for (std::size_t neighborRow = (pixelRow > 0 ? pixelRow - 1 : 0); neighborRow <= std::min(pixelRow + 1, numRows - 1); ++neighborRow)
+        {
+          for (std::size_t neighborColumn = (pixelColumn > 0 ? pixelColumn - 1 : 0); neighborColumn <= std::min(pixelColumn + 1, numColumns - 1); ++neighborColumn)
+          {
+            if (plane(neighborRow, neighborColumn) != 0 && labels(neighborRow, neighborColumn) == 0)
+            {
+              labels(neighborRow, neighborColumn) = numComponents;
+              vecStack.push_back(std::make_pair(neighborRow, neighborColumn));
+            }
+          }
+        }
+      }
+    }
+  }
+
+  return numComponents;
+}
+
+//!< Compares the serial labeling with the flood fill, and the tiled and the streamed labelers with the serial labeling, with diagonal components whose pixels only touch across the corners of the tiles
+int checkConnectedComponents()
+{
+  std::size_t numRows = 157;
+  std::size_t numColumns = 203;
+
+  te::urban::PixelPlane<unsigned char> plane(numRows, numColumns, 0);
+
+  srand(2);
+
+  for (std::size_t row = 0; row < numRows; ++row)
+  {
+    for (std::size_t column = 0; column < numColumns; ++column)
+    {
+      if (((row / 9) + (column / 13)) % 4 == 0 && rand() % 4 != 0)
+      {
+        plane(row, column) = (unsigned char)(1 + rand() % 3);
+      }
+    }
+  }
+
+  for (std::size_t i = 0; i < std::min(numRows, numColumns); ++i)
+  {
+    plane(i, i) = 1;
+    plane(i, numColumns - 1 - i) = 2;
+  }
+
+  std::auto_ptr<te::rst::Raster> inputRaster = createByteRaster(numRows, numColumns, 1000., 5000., 30.);
+  plane.write(inputRaster.get());
+
+  std::size_t numSerialComponents = 0;
+  std::auto_ptr<te::rst::Raster> serialRaster = te::urban::labelConnectedComponents(inputRaster.get(), numSerialComponents);
+
+  int numFailed = 0;
+
+  te::urban::PixelPlane<unsigned int> floodLabels;
+  std::size_t numFloodComponents = labelByFloodFill(plane, floodLabels);
+
+  te::urban::PixelPlane<unsigned int> serialLabels;
+  serialLabels.read(serialRaster.get());
+
+  std::size_t numSerialDifferences = (numSerialComponents != numFloodComponents) ? 1 : 0;
+  for (std::size_t row = 0; row < numRows; ++row)
+  {
+    for (std::size_t column = 0; column < numColumns; ++column)
+    {
+      numSerialDifferences += (serialLabels(row, column) != floodLabels(row, column)) ? 1 : 0;
+    }
+  }
+
+  numFailed += reportCheck("serial labels vs flood fill", numSerialDifferences);
+
+  std::size_t vecTileSizes[] = { 8, 16, 61 };
+  std::size_t vecThreads[] = { 1, 4 };
+  for (std::size_t t = 0; t < 3; ++t)
+  {
+    for (std::size_t h = 0; h < 2; ++h)
+    {
+      for (int streamTiles = 0; streamTiles < 2; ++streamTiles)
+      {
+        te::urban::ConnectedComponentsLabeler labeler(inputRaster.get(), vecThreads[h], vecTileSizes[t], streamTiles != 0);
+
+        std::size_t numComponents = 0;
+        std::auto_ptr<te::rst::Raster> labelRaster = labeler.label(numComponents);
+
+        std::size_t numDifferences = countDifferences(serialRaster.get(), labelRaster.get());
+        if (numComponents != numSerialComponents)
+        {
+          numDifferences += 1;
+        }
+
+        std::string name = std::string(streamTiles ? "streamed" : "tiled") + " labels, tiles of " + boost::lexical_cast<std::string>(vecTileSizes[t]) + ", " + boost::lexical_cast<std::string>(vecThreads[h]) + " threads";
+        numFailed += reportCheck(name, numDifferences);
+      }
+    }
+  }
+
+  return numFailed;
+}
+
+//!< Keeps, for each pixel, whether there is an urban pixel in its neighborhood
+class UrbanReachRowClassifier : public te::urban::NeighborhoodRowClassifier
+{
+  public:
+
+    UrbanReachRowClassifier(std::size_t numColumns, std::vector<unsigned char>& vecReached)
+      : m_numColumns(numColumns)
+      , m_vecReached(vecReached)
+    {}
+
+    virtual void classifyRow(std::size_t row, const unsigned char* /*flags*/, const std::vector<unsigned int>& vecUrbanCount, const std::vector<unsigned int>& /*vecValidCount*/)
+    {
+      for (std::size_t column = 0; column < m_numColumns; ++column)
+      {
+        m_vecReached[row * m_numColumns + column] = (vecUrbanCount[column] > 0) ? 1 : 0;
+      }
+    }
+
+  protected:
+
+    std::size_t m_numColumns;
+    std::vector<unsigned char>& m_vecReached;
+};
+
+//!< Compares the dilation of the urban pixels with the neighborhood counts of the prefix sums, for the masks that are distance thresholds
+int checkDilation(const te::urban::NeighborhoodPlane& plane)
+{
+  std::size_t numPixels = plane.m_numRows * plane.m_numColumns;
+
+  int numFailed = 0;
+
+  double vecRadius[] = { 1., 2.5, 7., 12.5, 20. };
+  for (std::size_t r = 0; r < 5; ++r)
+  {
+    boost::numeric::ublas::matrix<bool> mask = te::urban::createRadiusMask(1., vecRadius[r]);
+
+    unsigned int squaredRadius = 0;
+    if (te::urban::getMaskSquaredRadius(mask, squaredRadius) == false)
+    {
+      continue;
+    }
+
+    std::vector<unsigned char> vecDilated(numPixels);
+    std::vector<unsigned char> vecCounted(numPixels);
+
+    UrbanReachRowClassifier dilatedClassifier(plane.m_numColumns, vecDilated);
+    te::urban::classifyDilatedRows(plane, squaredRadius, 3, dilatedClassifier, "Dilation check");
+
+    UrbanReachRowClassifier countedClassifier(plane.m_numColumns, vecCounted);
+    te::urban::classifyNeighborhoodRows(plane, te::urban::createMaskSpans(mask), te::urban::KERNEL_PREFIX_SUM, 3, countedClassifier, "Counting check");
+
+    //the counts do not include the center pixel, so they only agree with the dilation in the pixels that are not urban, which are the only ones classified
+    std::size_t numDifferences = 0;
+    for (std::size_t i = 0; i < numPixels; ++i)
+    {
+      if ((plane.m_vecFlags[i] & te::urban::NEIGHBORHOOD_URBAN) == 0 && vecDilated[i] != vecCounted[i])
+      {
+        ++numDifferences;
+      }
+    }
+
+    numFailed += reportCheck("dilation vs counting, radius of " + boost::lexical_cast<std::string>(vecRadius[r]) + " pixels", numDifferences);
+  }
+
+  return numFailed;
+}
+
+//!< The original normalization, which transforms and reads each pixel of the reference grid. The grids must have the same SRID
+std::auto_ptr<te::rst::Raster> normalizeByPixel(te::rst::Raster* inputRaster, te::rst::Raster* referenceRaster)
+{
+  std::auto_ptr<te::rst::Raster> normalizedRaster = te::urban::cloneRasterIntoMem(referenceRaster, false);
+
+  double inputNoData = inputRaster->getBand(0)->getProperty()->m_noDataValue;
+
+  int inputNumRows = (int)inputRaster->getNumberOfRows();
+  int inputNumColumns = (int)inputRaster->getNumberOfColumns();
+
+  for (unsigned int row = 0; row < normalizedRaster->getNumberOfRows(); ++row)
+  {
+    for (unsigned int column = 0; column < normalizedRaster->getNumberOfColumns(); ++column)
+    {
+      te::gm::Coord2D coordGeo = normalizedRaster->getGrid()->gridToGeo((double)column, (double)row);
+      te::gm::Coord2D inputCoordGrid = inputRaster->getGrid()->geoToGrid(coordGeo.getX(), coordGeo.getY());
+
+      int inputColumn = te::rst::Round(inputCoordGrid.getX());
+      int inputRow = te::rst::Round(inputCoordGrid.getY());
+
+      double value = inputNoData;
+      if (inputColumn >= 0 && inputColumn < inputNumColumns && inputRow >= 0 && inputRow < inputNumRows)
+      {
+        inputRaster->getValue((unsigned int)inputColumn, (unsigned int)inputRow, value);
+      }
+
+      normalizedRaster->setValue(column, row, value);
+    }
+  }
+
+  return normalizedRaster;
+}
+
+//!< Compares normalizeRaster, which copies the aligned grids and resamples the others, and the resampler tiles with the original per pixel normalization
+int checkNormalization()
+{
+  std::size_t numRows = 300;
+  std::size_t numColumns = 400;
+
+  te::urban::PixelPlane<unsigned char> plane(numRows, numColumns, 0);
+
+  srand(3);
+
+  for (std::size_t row = 0; row < numRows; ++row)
+  {
+    for (std::size_t column = 0; column < numColumns; ++column)
+    {
+      plane(row, column) = (unsigned char)(rand() % 5);
+    }
+  }
+
+  std::auto_ptr<te::rst::Raster> inputRaster = createByteRaster(numRows, numColumns, 1000., 5000., 30.);
+  plane.write(inputRaster.get());
+
+  int numFailed = 0;
+
+  //a grid shifted by whole pixels, partially outside the input, is copied
+  std::auto_ptr<te::rst::Raster> alignedRaster = createByteRaster(260, 320, 1000. - 7. * 30., 5000. + 11. * 30., 30.);
+  std::auto_ptr<te::rst::Raster> expectedAligned = normalizeByPixel(inputRaster.get(), alignedRaster.get());
+  std::auto_ptr<te::rst::Raster> normalizedAligned = te::urban::normalizeRaster(inputRaster.get(), alignedRaster.get(), 0.);
+  numFailed += reportCheck("aligned copy vs per pixel normalization", countDifferences(expectedAligned.get(), normalizedAligned.get()));
+
+  //a grid of another resolution, not aligned with the input, is resampled
+  std::auto_ptr<te::rst::Raster> resampledRaster = createByteRaster(330, 250, 1011.7, 4987.1, 37.);
+  std::auto_ptr<te::rst::Raster> expectedResampled = normalizeByPixel(inputRaster.get(), resampledRaster.get());
+  std::auto_ptr<te::rst::Raster> normalizedResampled = te::urban::normalizeRaster(inputRaster.get(), resampledRaster.get(), 0.);
+  numFailed += reportCheck("resampler vs per pixel normalization", countDifferences(expectedResampled.get(), normalizedResampled.get()));
+
+  std::size_t vecTileSizes[] = { 7, 64 };
+  std::size_t vecThreads[] = { 1, 4 };
+  for (std::size_t t = 0; t < 2; ++t)
+  {
+    for (std::size_t h = 0; h < 2; ++h)
+    {
+      std::auto_ptr<te::rst::Raster> outputRaster = te::urban::cloneRasterIntoMem(resampledRaster.get(), false);
+
+      te::urban::NearestNeighborResampler resampler(inputRaster.get(), outputRaster.get(), 0., 0., vecThreads[h], vecTileSizes[t]);
+      resampler.resample();
+
+      std::string name = "resampler, tiles of " + boost::lexical_cast<std::string>(vecTileSizes[t]) + ", " + boost::lexical_cast<std::string>(vecThreads[h]) + " threads";
+      numFailed += reportCheck(name, countDifferences(expectedResampled.get(), outputRaster.get()));
+    }
+  }
+
+  return numFailed;
+}
+
+//!< Runs all the checks and returns the exit code of the program
+int runChecks()
+{
+  te::urban::init();
+
+  int numFailed = 0;
+
+  numFailed += checkConnectedComponents();
+
+  te::urban::NeighborhoodPlane plane;
+  createSyntheticPlane(300, 280, plane);
+  numFailed += checkDilation(plane);
+
+  numFailed += checkNormalization();
+
+  te::urban::finalize();
+
+  std::cout << numFailed << " checks failed" << std::endl;
+
+  return (numFailed == 0) ? EXIT_SUCCESS : EXIT_FAILURE;
+}
+
+int main(int argc, char** argv)
+{
+  if (argc == 2 && std::string(argv[1]) == "--check")
+  {
+    return runChecks();
+  }
+
+  std::size_t numRows = 2000;
+  std::size_t numColumns = 2000;
+  double radiusInPixels = 33.;
+  std::size_t repetitions = 3;
+
+  if (argc == 5)
+  {
+    numRows = (std::size_t)atoi(argv[1]);
+    numColumns = (std::size_t)atoi(argv[2]);
+    radiusInPixels = atof(argv[3]);
+    repetitions = (std::size_t)atoi(argv[4]);
+  }
+  else if (argc != 1)
+  {
+    std::cout << "Usage: " << argv[0] << " [numRows numColumns radiusInPixels repetitions]" << std::endl;
+    std::cout << "       " << argv[0] << " --check" << std::endl;
+    return EXIT_FAILURE;
+  }
+
+  te::urban::NeighborhoodPlane plane;
+  createSyntheticPlane(numRows, numColumns, plane);
+
+  std::vector<te::urban::MaskSpan> vecSpans = te::urban::createMaskSpans(te::urban::createRadiusMask(1., radiusInPixels));
+
+  te::urban::SpanInstructionSet supportedInstructionSet = te::urban::getSupportedSpanInstructionSet();
+
+  std::cout << numRows << " x " << numColumns << " pixels, radius of " << radiusInPixels << " pixels, " << repetitions << " repetitions" << std::endl;
+  std::cout << "Supported instruction set: " << te::urban::getSpanInstructionSetName(supportedInstructionSet) << std::endl;
+
+  //the popcount counter reads the bit planes
+  te::urban::packNeighborhoodPlane(plane);
+
+  //the scalar version of each counter is the reference of its speedup. The scalar prefix sum is the reference of the checksum of all the counters
+  te::urban::NeighborhoodKernel vecKernels[] = { te::urban::KERNEL_PREFIX_SUM, te::urban::KERNEL_SLIDING_WINDOW, te::urban::KERNEL_POPCOUNT, te::urban::KERNEL_FFT };
+  const char* vecKernelNames[] = { "prefix sum", "sliding window", "popcount", "fft" };
+
+  unsigned long long referenceChecksum = 0;
+
+  for (int k = 0; k < 4; ++k)
+  {
+    te::urban::NeighborhoodKernel kernel = vecKernels[k];
+
+    double scalarPixelsPerSecond = 0.;
+
+    //the FFT does not use the span kernels
+    int lastInstructionSet = (kernel == te::urban::KERNEL_FFT) ? te::urban::SPAN_SCALAR : supportedInstructionSet;
+
+    for (int i = te::urban::SPAN_SCALAR; i <= lastInstructionSet; ++i)
+    {
+      te::urban::SpanInstructionSet instructionSet = (te::urban::SpanInstructionSet)i;
+
+      std::auto_ptr<te::urban::NeighborhoodCounter> counter;
+      if (kernel == te::urban::KERNEL_PREFIX_SUM)
+      {
+        counter.reset(new te::urban::PrefixSumNeighborhoodCounter(plane, vecSpans, instructionSet));
+      }
+      else if (kernel == te::urban::KERNEL_SLIDING_WINDOW)
+      {
+        counter.reset(new te::urban::SlidingWindowNeighborhoodCounter(plane, vecSpans, instructionSet));
+      }
+      else if (kernel == te::urban::KERNEL_POPCOUNT)
+      {
+        counter.reset(new te::urban::PopcountNeighborhoodCounter(plane, vecSpans, instructionSet));
+      }
+      else
+      {
+        counter.reset(new te::urban::FFTNeighborhoodCounter(plane, vecSpans, instructionSet));
+      }
+
+      unsigned long long checksum = 0;
+      double pixelsPerSecond = runCounter(*counter, repetitions, checksum);
+
+      if (instructionSet == te::urban::SPAN_SCALAR)
+      {
+        scalarPixelsPerSecond = pixelsPerSecond;
+        if (k == 0)
+        {
+          referenceChecksum = checksum;
+        }
+      }
+
+      double speedup = (scalarPixelsPerSecond > 0.) ? pixelsPerSecond / scalarPixelsPerSecond : 0.;
+
+      std::cout << std::setw(16) << vecKernelNames[k] << std::setw(8) << te::urban::getSpanInstructionSetName(instructionSet)
+                << std::setw(16) << (std::size_t)pixelsPerSecond << " pixels/second"
+                << std::setw(8) << std::fixed << std::setprecision(2) << speedup << "x"
+                << (checksum == referenceChecksum ? "" : "  CHECKSUM MISMATCH") << std::endl;
+
+      if (checksum != referenceChecksum)
+      {
+        return EXIT_FAILURE;
+      }
+    }
+  }
+
+  return EXIT_SUCCESS;
+}